@@ -10,6 +10,7 @@
 #include "renderer/renderer.h"
 #include "renderer/renderer_helper.h"
 #include "engine_helper.h"
+#include "asset_loader.h"
 #include "application.h"
 
 namespace er = engine::renderer;
@@ -20,6 +21,50 @@ constexpr int kWindowSizeX = 1920;
 constexpr int kWindowSizeY = 1080;
 static int s_update_frame_count = -1;
 static bool s_render_prt_test = true;
+// rgba16f conemap storing cone tangents, rgba8 otherwise.
+static bool s_use_high_precision_conemap = false;
+// print conemap average steps per pixel every kConemapStepStatsInterval frames.
+static bool s_report_conemap_step_stats = false;
+constexpr int kConemapStepStatsInterval = 300;
+// reuse last frame's cone stepping hit depth as ray start point.
+static bool s_use_temporal_conemap = false;
+// cone stepping resolution divider, 1 full, 2 half, 4 quarter.
+static uint32_t s_conemap_parallax_downscale = 1;
+// cycle through all parallax resolutions every kConemapStepStatsInterval frames and print frame time.
+static bool s_benchmark_conemap_parallax = false;
+// deferred conemap shading through a visibility buffer, forward otherwise.
+static bool s_use_conemap_visibility_buffer = false;
+// conservative parallax depth prepass before forward conemap shading.
+static bool s_use_conemap_depth_prepass = false;
+// prt bake skips empty space along horizon rays with conemap and minmax depth.
+static bool s_use_conemap_prt_bake = true;
+// bake one prt block with every bake mode after the bake, print time and max sh coefficient
+// difference against the brute force bake.
+static bool s_compare_prt_bake_modes = false;
+// prt coefficient packing, kPrtPackGlobalUniform bakes with the old global range packing.
+static uint32_t s_prt_pack_mode = kPrtPackBlockBanded;
+// print prt packing error and throughput after the bake, next to the global range packing's.
+static bool s_report_prt_pack_error = false;
+// max sh coefficient change per azimuth refinement of the prt bake, 0 bakes all the azimuths
+// through the fused shadow ray tangent cache. the bake mode compare runs the adaptive one too.
+static float s_prt_adaptive_tolerance = 0.0f;
+// prt bake resolution divider, 1, 2 or 4, upsampled back guided by height and normal.
+static uint32_t s_prt_bake_downscale = 1;
+// bake conemap and prt of a tileable source, rays wrap through its border for this many pixels.
+static bool s_bake_tileable = false;
+static uint32_t s_tile_wrap_radius = 1024;
+// prt self shadowing of the conemap test lights and ibl once the prt bake finished, unshadowed otherwise.
+static bool s_use_prt_lighting = true;
+// record the whole conemap generation once more without submitting it, print recorded commands per second.
+static bool s_benchmark_command_recording = false;
+// print job system throughput, parallel for scaling and latency at startup.
+static bool s_benchmark_job_system = false;
+// print decode and upload time of every texture loaded at startup.
+static bool s_report_asset_load_times = false;
+// conemap planes drawn per frame, laid out on a grid next to the original one. a cpu stress
+// scene for the hdr pass recording, the only pass split across jobs. the ibl, camera and
+// blit passes are a handful of commands each and stay on the main command buffer.
+static uint32_t s_conemap_stress_draw_count = 1;
 
 // global pbr texture descriptor set layout.
 std::shared_ptr<er::DescriptorSetLayout> createPbrLightingDescriptorSetLayout(
@@ -346,43 +391,58 @@ void RealWorldApplication::initVulkan() {
     assert(command_pool_);
     er::Helper::init(device_);
 
-    eh::loadMtx2Texture(
-        device_,
-        cubemap_render_pass_,
+    job_system_ = std::make_shared<engine::job_system::JobSystem>();
+    if (s_benchmark_job_system) {
+        job_system_->runBenchmark();
+    }
+
+    // files get decoded on the workers while the rest of the setup below runs, each texture
+    // is only waited for right before its first user.
+    eh::AssetLoader asset_loader(device_, job_system_);
+    asset_loader.loadMtx2Texture(
         "assets/environments/doge2/lambertian/diffuse.ktx2",
         ibl_diffuse_tex_);
-    eh::loadMtx2Texture(
-        device_,
-        cubemap_render_pass_,
+    asset_loader.loadMtx2Texture(
         "assets/environments/doge2/ggx/specular.ktx2",
         ibl_specular_tex_);
-    eh::loadMtx2Texture(
-        device_,
-        cubemap_render_pass_,
+    asset_loader.loadMtx2Texture(
         "assets/environments/doge2/charlie/sheen.ktx2",
         ibl_sheen_tex_);
-    recreateRenderBuffer(swap_chain_info_.extent);
     auto format = er::Format::R8G8B8A8_UNORM;
-    eh::createTextureImage(device_, "assets/statue.jpg", format, sample_tex_);
-    eh::createTextureImage(device_, "assets/brdfLUT.png", format, brdf_lut_tex_);
-    eh::createTextureImage(device_, "assets/lut_ggx.png", format, ggx_lut_tex_);
-    eh::createTextureImage(device_, "assets/lut_charlie.png", format, charlie_lut_tex_);
-    eh::createTextureImage(device_, "assets/lut_thin_film.png", format, thin_film_lut_tex_);
-    eh::createTextureImage(device_, "assets/map_mask.png", format, map_mask_tex_);
-    eh::createTextureImage(device_, "assets/map.png", er::Format::R16_UNORM, heightmap_tex_);
-//    eh::createTextureImage(device_, "assets/tile1.jpg", format, prt_base_tex_);
-//    eh::createTextureImage(device_, "assets/tile1.tga", format, prt_bump_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat4Mural_C.PNG", format, prt_base_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat4Mural_H.PNG", format, prt_height_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat4Mural_N.PNG", format, prt_normal_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat4Mural_TRA.PNG", format, prt_orh_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat1Ground_C.jpg", format, prt_base_tex_);
-//    eh::createTextureImage(device_, "assets/T_Mat1Ground_ORH.jpg", format, prt_bump_tex_);
-    eh::createTextureImage(device_, "assets/T_Mat2Mountains_C.jpg", format, prt_base_tex_);
-    eh::createTextureImage(device_, "assets/T_Mat2Mountains_N.jpg", format, prt_normal_tex_);
-    eh::createTextureImage(device_, "assets/T_Mat2Mountains_ORH.jpg", format, prt_orh_tex_);
+    asset_loader.loadTexture("assets/statue.jpg", format, sample_tex_);
+    asset_loader.loadTexture("assets/brdfLUT.png", format, brdf_lut_tex_);
+    asset_loader.loadTexture("assets/lut_ggx.png", format, ggx_lut_tex_);
+    asset_loader.loadTexture("assets/lut_charlie.png", format, charlie_lut_tex_);
+    asset_loader.loadTexture("assets/lut_thin_film.png", format, thin_film_lut_tex_);
+    asset_loader.loadTexture("assets/map_mask.png", format, map_mask_tex_);
+    asset_loader.loadTexture("assets/map.png", er::Format::R16_UNORM, heightmap_tex_);
+//    asset_loader.loadTexture("assets/tile1.jpg", format, prt_base_tex_);
+//    asset_loader.loadTexture("assets/tile1.tga", format, prt_bump_tex_);
+//    asset_loader.loadTexture("assets/T_Mat4Mural_C.PNG", format, prt_base_tex_);
+//    asset_loader.loadTexture("assets/T_Mat4Mural_H.PNG", format, prt_height_tex_);
+//    asset_loader.loadTexture("assets/T_Mat4Mural_N.PNG", format, prt_normal_tex_);
+//    asset_loader.loadTexture("assets/T_Mat4Mural_TRA.PNG", format, prt_orh_tex_);
+//    asset_loader.loadTexture("assets/T_Mat1Ground_C.jpg", format, prt_base_tex_);
+//    asset_loader.loadTexture("assets/T_Mat1Ground_ORH.jpg", format, prt_bump_tex_);
+    auto prt_base_asset =
+        asset_loader.loadTexture("assets/T_Mat2Mountains_C.jpg", format, prt_base_tex_);
+    auto prt_normal_asset =
+        asset_loader.loadTexture("assets/T_Mat2Mountains_N.jpg", format, prt_normal_tex_);
+    auto prt_orh_asset =
+        asset_loader.loadTexture("assets/T_Mat2Mountains_ORH.jpg", format, prt_orh_tex_);
+
+    recreateRenderBuffer(swap_chain_info_.extent);
     createTextureSampler();
     descriptor_pool_ = device_->createDescriptorPool();
+    frame_uniform_ring_ = std::make_shared<er::UniformBufferRing>();
+    frame_uniform_ring_->create(device_, kFrameUniformRingSize, kMaxFramesInFlight);
+    parallel_recorder_.create(
+        device_,
+        job_system_,
+        queue_list_.getGraphicAndPresentFamilyIndex()[0],
+        kMaxFramesInFlight);
+    bindless_table_ = std::make_shared<er::BindlessTextureTable>();
+    bindless_table_->create(device_, kBindlessMaxTextures, kBindlessMaxStorageImages);
     createCommandBuffers();
     createSyncObjects();
 
@@ -395,11 +455,21 @@ void RealWorldApplication::initVulkan() {
             device_,
             descriptor_pool_,
             texture_sampler_);
-
+    prt_shadow_gen_->setConemapHorizonSearch(s_use_conemap_prt_bake);
+    prt_shadow_gen_->setPackMode(s_prt_pack_mode);
+    prt_shadow_gen_->setCollectPackError(s_report_prt_pack_error);
+    prt_shadow_gen_->setAdaptiveSampling(s_prt_adaptive_tolerance);
+    prt_shadow_gen_->setCollectAdaptiveStats(s_prt_adaptive_tolerance > 0.0f);
+    prt_shadow_gen_->setBakeDownscale(s_prt_bake_downscale);
+
+    asset_loader.wait(prt_base_asset);
+    asset_loader.wait(prt_normal_asset);
+    asset_loader.wait(prt_orh_asset);
     conemap_obj_ =
         std::make_shared<ego::ConemapObj>(
             device_,
             descriptor_pool_,
+            bindless_table_,
             texture_sampler_,
             prt_orh_tex_,//prt_height_tex_,
             prt_shadow_gen_,
@@ -407,17 +477,24 @@ void RealWorldApplication::initVulkan() {
             true,
             0.05f,
             0.1f,
-            8.0f / 256.0f);
+            8.0f / 256.0f,
+            s_use_high_precision_conemap);
+    conemap_obj_->setTileable(s_bake_tileable, s_tile_wrap_radius);
 
     unit_plane_ =
         std::make_shared<ego::Plane>(device_);
 
+    // conemap test binds camera buffer for its parallax compute pass.
+    ego::GameCamera::initGameCameraBuffer(device_);
+
     conemap_test_ =
         std::make_shared<ego::ConemapTest>(
             device_,
             descriptor_pool_,
+            frame_uniform_ring_,
             hdr_render_pass_,
             graphic_pipeline_info_,
+            graphic_fs_pipeline_info_,
             desc_set_layouts,
             texture_sampler_,
             prt_base_tex_,
@@ -426,6 +503,12 @@ void RealWorldApplication::initVulkan() {
             conemap_obj_,
             swap_chain_info_.extent,
             unit_plane_);
+    conemap_test_->setCollectStepStats(s_report_conemap_step_stats);
+    conemap_test_->setTemporalReprojection(s_use_temporal_conemap);
+    conemap_test_->setParallaxDownscale(s_conemap_parallax_downscale);
+    conemap_test_->setVisibilityBuffer(s_use_conemap_visibility_buffer);
+    conemap_test_->setDepthPrepass(s_use_conemap_depth_prepass);
+    conemap_test_->loadEnvironmentLighting(es::IblCreator::getPanoramaFileName());
 
     clear_values_.resize(2);
     clear_values_[0].color = { 50.0f / 255.0f, 50.0f / 255.0f, 50.0f / 255.0f, 1.0f };
@@ -456,13 +539,16 @@ void RealWorldApplication::initVulkan() {
             er::ImageLayout::PRESENT_SRC_KHR);
     }
 
-    ego::GameCamera::initGameCameraBuffer(device_);
-
     ego::GameCamera::initStaticMembers(
         device_,
         descriptor_pool_,
         desc_set_layouts);
 
+    asset_loader.waitAll();
+    if (s_report_asset_load_times) {
+        asset_loader.printStats();
+    }
+
     createDescriptorSets();
 }
 
@@ -474,8 +560,8 @@ void RealWorldApplication::recreateSwapChain() {
         glfwWaitEvents();
     }
 
-    device_->waitIdle();
-
+    // no device wait here, everything the frames in flight still use only gets retired and
+    // the old swapchain hands its images over to the new one.
     cleanupSwapChain();
 
     er::Helper::createSwapChain(
@@ -505,6 +591,9 @@ void RealWorldApplication::recreateSwapChain() {
 
     createDescriptorSets();
 
+    // new swapchain images aren't used by any frame yet.
+    images_in_flight_.assign(swap_chain_info_.images.size(), nullptr);
+
     for (auto& image : swap_chain_info_.images) {
         er::Helper::transitionImageLayout(
             device_,
@@ -667,6 +756,7 @@ void RealWorldApplication::createTextureSampler() {
 void RealWorldApplication::mainLoop() {
     while (!glfwWindowShouldClose(window_) && !s_exit_game) {
         glfwPollEvents();
+        job_system_->pumpMainThread();
         drawFrame();
     }
 
@@ -715,6 +805,11 @@ void RealWorldApplication::drawScene(
  
     er::DescriptorSetList desc_sets{ pbr_lighting_desc_set_, view_desc_set };
 
+    // keep last frame's camera for hit depth reprojection before camera gets updated.
+    if (s_render_prt_test) {
+        conemap_test_->updateTemporalHistory(cmd_buf);
+    }
+
     // this has to be happened after tile update, or you wont get the right height info.
     {
         static std::chrono::time_point s_last_time = std::chrono::steady_clock::now();
@@ -765,21 +860,67 @@ void RealWorldApplication::drawScene(
         }
     }
 
+    conemap_test_->updateParallax(cmd_buf, conemap_obj_);
+
+    conemap_test_->drawVisibility(
+        cmd_buf,
+        desc_sets,
+        unit_plane_,
+        conemap_obj_);
+
     {
+        conemap_test_->prepareDraw(device_, conemap_obj_);
+
         cmd_buf->beginRenderPass(
             hdr_render_pass_,
             hdr_frame_buffer_,
             screen_size,
-            clear_values_);
-
-        conemap_test_->draw(
-            device_,
-            cmd_buf,
-            desc_sets,
-            unit_plane_,
-            conemap_obj_);
-
+            clear_values_,
+            er::SubpassContents::SECONDARY_COMMAND_BUFFERS);
+
+        // visibility buffer resolve is one full screen triangle, nothing to split. at least one
+        // job, executeCommands can't take an empty list.
+        uint32_t num_draws =
+            s_use_conemap_visibility_buffer ? 1 : std::max(s_conemap_stress_draw_count, 1u);
+        uint32_t num_jobs = std::min(num_draws, job_system_->getNumWorkers());
+
+        auto record_start_point = std::chrono::high_resolution_clock::now();
+        er::CommandBufferInheritanceInfo inheritance;
+        inheritance.render_pass = hdr_render_pass_;
+        inheritance.frame_buffer = hdr_frame_buffer_;
+        auto secondary_cmd_bufs =
+            parallel_recorder_.recordSecondary(
+                device_,
+                inheritance,
+                num_jobs,
+                [&](uint32_t job_idx, const std::shared_ptr<er::CommandBuffer>& job_cmd_buf) {
+                    auto first_draw = num_draws * job_idx / num_jobs;
+                    conemap_test_->recordDraw(
+                        job_cmd_buf,
+                        desc_sets,
+                        unit_plane_,
+                        first_draw,
+                        num_draws * (job_idx + 1) / num_jobs - first_draw);
+                });
+        auto record_end_point = std::chrono::high_resolution_clock::now();
+
+        cmd_buf->executeCommands(secondary_cmd_bufs);
         cmd_buf->endRenderPass();
+
+        if (s_benchmark_command_recording) {
+            static double s_record_time = 0.0;
+            s_record_time +=
+                std::chrono::duration<double, std::milli>(
+                    record_end_point - record_start_point).count();
+            if (s_update_frame_count > 0 &&
+                s_update_frame_count % kConemapStepStatsInterval == 0) {
+                std::cout << "hdr pass recording: " <<
+                    num_draws << " draws on " <<
+                    num_jobs << " threads, " <<
+                    s_record_time / kConemapStepStatsInterval << "ms per frame" << std::endl;
+                s_record_time = 0.0;
+            }
+        }
     }
 
     er::ImageResourceInfo src_info = {
@@ -862,25 +1003,84 @@ void RealWorldApplication::initDrawFrame() {
             std::chrono::duration<float, std::chrono::seconds::period>(
                 conemap_end_point_ - conemap_start_point_).count();
         std::cout << "conemap generation time: " << delta_t_ << "s" << std::endl;
+
+        if (s_benchmark_command_recording) {
+            const auto& cmd_buf =
+                device_->setupTransientCommandBuffer();
+            auto record_start_point =
+                std::chrono::high_resolution_clock::now();
+            conemap_gen_->update(
+                cmd_buf,
+                conemap_obj_,
+                0,
+                num_passes);
+            auto record_end_point =
+                std::chrono::high_resolution_clock::now();
+            auto num_commands = cmd_buf->getNumRecordedCommands();
+            cmd_buf->endCommandBuffer();
+            cmd_buf->reset(0);
+
+            double record_time =
+                std::chrono::duration<double, std::chrono::seconds::period>(
+                    record_end_point - record_start_point).count();
+            std::cout << "conemap generation recording: " <<
+                num_commands << " commands in " <<
+                record_time * 1000.0 << "ms, " <<
+                num_commands / std::max(record_time, 1e-9) << " commands per second" << std::endl;
+        }
     }
 
     // prt shadow generation.
-    if (0)
     {
         auto prt_start_point_ =
             std::chrono::high_resolution_clock::now();
-        const auto& prt_gen_cmd_buf =
-            device_->setupTransientCommandBuffer();
-        prt_shadow_gen_->update(
-            prt_gen_cmd_buf,
-            conemap_obj_);
-        device_->submitAndWaitTransientCommandBuffer();
+        // every submission only records a few blocks, so neither the command buffer
+        // nor a single queue submit grows with the source size.
+        auto num_passes = prt_shadow_gen_->getNumPasses(conemap_obj_);
+        const uint32_t pass_step = 16;
+        for (uint32_t i_pass = 0; i_pass < num_passes; i_pass += pass_step) {
+            auto pass_end = std::min(i_pass + pass_step, num_passes);
+            auto pass_start_point = std::chrono::high_resolution_clock::now();
+            const auto& prt_gen_cmd_buf =
+                device_->setupTransientCommandBuffer();
+            prt_shadow_gen_->update(
+                prt_gen_cmd_buf,
+                conemap_obj_,
+                i_pass,
+                pass_end);
+            device_->submitAndWaitTransientCommandBuffer();
+            // each submission stays bounded by pass_step blocks whatever the source size.
+            std::cout <<
+                "prt generation pass: " <<
+                i_pass <<
+                ", " <<
+                pass_end <<
+                " of " <<
+                num_passes <<
+                ", " <<
+                std::chrono::duration<double, std::milli>(
+                    std::chrono::high_resolution_clock::now() - pass_start_point).count() <<
+                "ms" <<
+                std::endl;
+        }
         auto prt_end_point_ =
             std::chrono::high_resolution_clock::now();
         delta_t_ =
             std::chrono::duration<float, std::chrono::seconds::period>(
                 prt_end_point_ - prt_start_point_).count();
         std::cout << "prt generation time: " << delta_t_ << "s" << std::endl;
+        if (s_report_prt_pack_error) {
+            prt_shadow_gen_->reportPackError(device_, conemap_obj_);
+        }
+        if (s_prt_adaptive_tolerance > 0.0f) {
+            prt_shadow_gen_->reportAdaptiveSampling(device_);
+        }
+        if (s_compare_prt_bake_modes) {
+            prt_shadow_gen_->compareBakeModes(device_, conemap_obj_);
+        }
+
+        // the pack textures hold the baked coefficients from here on.
+        conemap_test_->setPrtLighting(s_use_prt_lighting);
     }
 
     prt_shadow_gen_->destroy(device_);
@@ -890,6 +1090,38 @@ void RealWorldApplication::drawFrame() {
     device_->waitForFences({ in_flight_fences_[current_frame_] });
     device_->resetFences({ in_flight_fences_[current_frame_] });
 
+    // the fence of this slot covers the frame kMaxFramesInFlight back and everything
+    // before it, so objects retired up to there aren't used by the gpu any more.
+    if (frame_index_ >= kMaxFramesInFlight) {
+        device_->releaseRetiredObjects(frame_index_ - kMaxFramesInFlight);
+    }
+    device_->beginFrame(frame_index_);
+    frame_uniform_ring_->beginFrame(frame_index_);
+    parallel_recorder_.beginFrame(device_, frame_index_);
+
+    if ((s_report_conemap_step_stats || s_benchmark_conemap_parallax) &&
+        s_update_frame_count > 0 &&
+        s_update_frame_count % kConemapStepStatsInterval == 0) {
+        // make sure no frame in flight is still accumulating.
+        device_->waitIdle();
+        if (s_report_conemap_step_stats) {
+            conemap_test_->reportStepStats(device_);
+        }
+
+        if (s_benchmark_conemap_parallax) {
+            static std::chrono::steady_clock::time_point s_benchmark_start;
+            auto cur_time = std::chrono::steady_clock::now();
+            auto downscale = conemap_test_->getParallaxDownscale();
+            if (s_benchmark_start.time_since_epoch().count() != 0) {
+                std::chrono::duration<double, std::milli> elapsed = cur_time - s_benchmark_start;
+                std::cout << "conemap parallax 1/" << downscale << " res: " <<
+                    elapsed.count() / kConemapStepStatsInterval << "ms per frame" << std::endl;
+            }
+            conemap_test_->setParallaxDownscale(downscale >= kConemapParallaxMaxDownscale ? 1 : downscale * 2);
+            s_benchmark_start = cur_time;
+        }
+    }
+
     uint32_t image_index = 0;
     bool need_recreate_swap_chain = er::Helper::acquireNextImage(
         device_,
@@ -968,6 +1200,7 @@ void RealWorldApplication::drawFrame() {
     }
 
     current_frame_ = (current_frame_ + 1) % kMaxFramesInFlight;
+    frame_index_++;
     if (s_update_frame_count < 0) {
         s_update_frame_count = 0;
     }
@@ -1004,6 +1237,9 @@ void RealWorldApplication::cleanup() {
     cleanupSwapChain();
 
     device_->destroyRenderPass(cubemap_render_pass_);
+    frame_uniform_ring_->destroy(device_);
+    parallel_recorder_.destroy(device_);
+    job_system_.reset();
 
     assert(device_);
     device_->destroySampler(texture_sampler_);
@@ -1034,6 +1270,7 @@ void RealWorldApplication::cleanup() {
     ibl_creator_->destroy(device_);
     unit_plane_->destroy(device_);
     conemap_obj_->destroy(device_);
+    bindless_table_->destroy(device_);
     conemap_gen_->destroy(device_);
     conemap_test_->destroy(device_);
 
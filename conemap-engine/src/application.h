@@ -8,6 +8,7 @@
 #include "scene_rendering/conemap.h"
 #include "scene_rendering/prt_shadow.h"
 #include "engine_helper.h"
+#include "job_system/job_system.h"
 
 namespace er = engine::renderer;
 namespace ego = engine::game_object;
@@ -19,6 +20,8 @@ namespace work {
 namespace app {
 
 const int kMaxFramesInFlight = 2;
+// uniform ring space of one frame in flight.
+const uint64_t kFrameUniformRingSize = 64 * 1024;
 const int kCubemapSize = 512;
 const int kDifuseCubemapSize = 256;
 
@@ -79,6 +82,14 @@ private:
     std::shared_ptr<er::Surface> surface_;
     er::SwapChainInfo swap_chain_info_;
     std::shared_ptr<er::DescriptorPool> descriptor_pool_;
+    // per frame constants, sub-allocated and bound with dynamic offsets.
+    std::shared_ptr<er::UniformBufferRing> frame_uniform_ring_;
+    // work stealing workers, one per hardware thread.
+    std::shared_ptr<engine::job_system::JobSystem> job_system_;
+    // thread local command pools for the passes recorded in parallel.
+    er::ParallelCommandRecorder parallel_recorder_;
+    // sampled and storage images addressed by index from the shaders.
+    std::shared_ptr<er::BindlessTextureTable> bindless_table_;
     std::shared_ptr<er::DescriptorSet> view_desc_set_;
     std::shared_ptr<er::DescriptorSetLayout> view_desc_set_layout_;
     std::shared_ptr<er::DescriptorSetLayout> pbr_lighting_desc_set_layout_;
@@ -149,6 +160,8 @@ private:
     bool dump_volume_noise_ = false;
 
     uint64_t current_frame_ = 0;
+    // counts every frame, device objects get retired under it.
+    uint64_t frame_index_ = 0;
     bool framebuffer_resized_ = false;
 };
 
@@ -0,0 +1,163 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "asset_loader.h"
+
+namespace engine {
+namespace helper {
+
+namespace {
+typedef std::chrono::high_resolution_clock Clock;
+
+double getElapsedMs(const Clock::time_point& start_point) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start_point).count();
+}
+} // namespace
+
+AssetLoader::AssetLoader(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::shared_ptr<job_system::JobSystem>& job_system) :
+    device_(device),
+    job_system_(job_system) {
+}
+
+AssetLoader::~AssetLoader() {
+    for (auto& asset : assets_) {
+        job_system_->wait(&asset->decoded);
+    }
+}
+
+AssetLoader::AssetHandle AssetLoader::addAsset(
+    const std::string& file_name,
+    renderer::Format format,
+    bool is_cubemap,
+    renderer::TextureInfo& texture) {
+    auto asset = std::make_unique<Asset>();
+    asset->file_name = file_name;
+    asset->format = format;
+    asset->is_cubemap = is_cubemap;
+    asset->texture = &texture;
+
+    auto asset_ptr = asset.get();
+    job_system_->run([asset_ptr]() {
+        auto start_point = Clock::now();
+        try {
+            if (asset_ptr->is_cubemap) {
+                readMtx2Texture(asset_ptr->file_name, asset_ptr->mtx2_texture);
+            }
+            else {
+                asset_ptr->image = decodeImageFile(asset_ptr->file_name, asset_ptr->format);
+            }
+        }
+        catch (const std::exception& e) {
+            asset_ptr->error = e.what();
+        }
+        asset_ptr->decode_ms = getElapsedMs(start_point);
+    }, &asset->decoded);
+
+    assets_.push_back(std::move(asset));
+    return static_cast<AssetHandle>(assets_.size() - 1);
+}
+
+AssetLoader::AssetHandle AssetLoader::loadTexture(
+    const std::string& file_name,
+    renderer::Format format,
+    renderer::TextureInfo& texture) {
+    return addAsset(file_name, format, false, texture);
+}
+
+AssetLoader::AssetHandle AssetLoader::loadMtx2Texture(
+    const std::string& file_name,
+    renderer::TextureInfo& texture) {
+    return addAsset(file_name, renderer::Format::R16G16B16A16_SFLOAT, true, texture);
+}
+
+bool AssetLoader::isReady(AssetHandle handle) const {
+    return assets_[handle]->is_uploaded;
+}
+
+void AssetLoader::uploadDecoded() {
+    std::vector<Asset*> decoded_assets;
+    for (auto& asset : assets_) {
+        if (!asset->is_uploaded && asset->decoded.isDone()) {
+            if (!asset->error.empty()) {
+                throw std::runtime_error(asset->error + " : " + asset->file_name);
+            }
+            decoded_assets.push_back(asset.get());
+        }
+    }
+
+    if (decoded_assets.empty()) {
+        return;
+    }
+
+    renderer::TextureUploadBatch upload_batch;
+    upload_batch.begin(device_);
+    for (auto asset : decoded_assets) {
+        auto start_point = Clock::now();
+        if (asset->is_cubemap) {
+            const auto& mtx2_texture = asset->mtx2_texture;
+            upload_batch.addCubemapTexture(
+                device_,
+                mtx2_texture.size,
+                mtx2_texture.mip_count,
+                mtx2_texture.format,
+                mtx2_texture.copy_regions,
+                mtx2_texture.level_data_size,
+                mtx2_texture.getLevelData(),
+                *asset->texture);
+        }
+        else {
+            upload_batch.add2DTexture(
+                device_,
+                asset->format,
+                asset->image.size,
+                asset->image.pixels.get(),
+                *asset->texture);
+        }
+        asset->upload_ms = getElapsedMs(start_point);
+    }
+
+    auto submit_point = Clock::now();
+    upload_batch.submit(device_);
+    upload_wait_ms_ += getElapsedMs(submit_point);
+    num_upload_batches_++;
+
+    // pixels live in the staging buffers until the submit, not needed after it.
+    for (auto asset : decoded_assets) {
+        asset->image = DecodedImage();
+        asset->mtx2_texture = Mtx2Texture();
+        asset->is_uploaded = true;
+    }
+}
+
+void AssetLoader::wait(AssetHandle handle) {
+    auto& asset = assets_[handle];
+    if (asset->is_uploaded) {
+        return;
+    }
+
+    job_system_->wait(&asset->decoded);
+    uploadDecoded();
+}
+
+void AssetLoader::waitAll() {
+    for (auto& asset : assets_) {
+        job_system_->wait(&asset->decoded);
+    }
+    uploadDecoded();
+}
+
+void AssetLoader::printStats() const {
+    for (const auto& asset : assets_) {
+        std::cout << "asset " << asset->file_name << ": " <<
+            asset->decode_ms << "ms decode, " <<
+            asset->upload_ms << "ms upload" <<
+            (asset->is_uploaded ? "" : ", not uploaded yet") << std::endl;
+    }
+    std::cout << "assets uploaded in " << num_upload_batches_ << " batches, " <<
+        upload_wait_ms_ << "ms waiting on the queue" << std::endl;
+}
+
+} // namespace helper
+} // namespace engine
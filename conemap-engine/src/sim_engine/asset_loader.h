@@ -0,0 +1,74 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "engine_helper.h"
+#include "job_system/job_system.h"
+
+namespace engine {
+namespace helper {
+
+// startup texture loading off the critical path. files get read and decoded on the job
+// system while the caller carries on with its own device setup, everything that touches
+// the device stays on the calling thread and only happens once somebody waits for an
+// asset. each wait uploads all the textures decoded by then in one batch.
+class AssetLoader {
+public:
+    typedef uint32_t AssetHandle;
+
+private:
+    struct Asset {
+        std::string file_name;
+        renderer::Format format = renderer::Format::R8G8B8A8_UNORM;
+        bool is_cubemap = false;
+        renderer::TextureInfo* texture = nullptr;
+        job_system::JobCounter decoded;
+        DecodedImage image;
+        Mtx2Texture mtx2_texture;
+        // exceptions can't leave a job, they get rethrown on the waiting thread.
+        std::string error;
+        bool is_uploaded = false;
+        double decode_ms = 0.0;
+        double upload_ms = 0.0;
+    };
+
+    std::shared_ptr<renderer::Device> device_;
+    std::shared_ptr<job_system::JobSystem> job_system_;
+    std::vector<std::unique_ptr<Asset>> assets_;
+    uint32_t num_upload_batches_ = 0;
+    double upload_wait_ms_ = 0.0;
+
+    AssetHandle addAsset(
+        const std::string& file_name,
+        renderer::Format format,
+        bool is_cubemap,
+        renderer::TextureInfo& texture);
+    void uploadDecoded();
+
+public:
+    AssetLoader(
+        const std::shared_ptr<renderer::Device>& device,
+        const std::shared_ptr<job_system::JobSystem>& job_system);
+    // waits for decodes still in flight, those write into the assets.
+    ~AssetLoader();
+
+    // texture has to stay where it is until the asset got waited for.
+    AssetHandle loadTexture(
+        const std::string& file_name,
+        renderer::Format format,
+        renderer::TextureInfo& texture);
+    AssetHandle loadMtx2Texture(
+        const std::string& file_name,
+        renderer::TextureInfo& texture);
+
+    bool isReady(AssetHandle handle) const;
+    // texture is usable once this returned.
+    void wait(AssetHandle handle);
+    void waitAll();
+
+    // per asset decode and upload times, plus how long the uploads kept the queue busy.
+    void printStats() const;
+};
+
+} // namespace helper
+} // namespace engine
@@ -60,11 +60,9 @@ void writeImageFile(
     file.close();
 }
 
-void createTextureImage(
-    const std::shared_ptr<renderer::Device>& device,
+DecodedImage decodeImageFile(
     const std::string& file_name,
-    renderer::Format format,
-    renderer::TextureInfo& texture) {
+    renderer::Format format) {
     int tex_width, tex_height, tex_channels;
     void* void_pixels = nullptr;
     if (format == engine::renderer::Format::R16_UNORM) {
@@ -91,19 +89,31 @@ void createTextureImage(
     if (!void_pixels) {
         throw std::runtime_error("failed to load texture image!");
     }
+
+    DecodedImage image;
+    image.format = format;
+    image.size = glm::uvec2(tex_width, tex_height);
+    image.pixels = std::shared_ptr<void>(void_pixels, stbi_image_free);
+    return image;
+}
+
+void createTextureImage(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::string& file_name,
+    renderer::Format format,
+    renderer::TextureInfo& texture) {
+    auto image = decodeImageFile(file_name, format);
     renderer::Helper::create2DTextureImage(
         device,
         format,
-        tex_width,
-        tex_height,
-        tex_channels,
-        void_pixels,
+        image.size.x,
+        image.size.y,
+        format == engine::renderer::Format::R16_UNORM ? 1 : 4,
+        image.pixels.get(),
         texture.image,
         texture.memory);
 
-    texture.size = { tex_width, tex_height, 1.0f };
-
-    stbi_image_free(void_pixels);
+    texture.size = glm::uvec3(image.size, 1);
 
     texture.view = device->createImageView(
         texture.image,
@@ -112,6 +122,29 @@ void createTextureImage(
         SET_FLAG_BIT(ImageAspect, COLOR_BIT));
 }
 
+std::vector<uint8_t> loadImageFile(
+    const std::string& file_name,
+    glm::uvec2& size) {
+    int tex_width, tex_height, tex_channels;
+    stbi_uc* pixels =
+        stbi_load(
+            file_name.c_str(),
+            &tex_width,
+            &tex_height,
+            &tex_channels,
+            STBI_rgb_alpha);
+
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image!");
+    }
+
+    size = glm::uvec2(tex_width, tex_height);
+    std::vector<uint8_t> image_data(pixels, pixels + size_t(tex_width) * tex_height * 4);
+    stbi_image_free(pixels);
+
+    return image_data;
+}
+
 std::shared_ptr<renderer::BufferInfo> createUnifiedMeshBuffer(
     const std::shared_ptr<renderer::Device>& device,
     const renderer::BufferUsageFlags& usage,
@@ -131,32 +164,38 @@ std::shared_ptr<renderer::BufferInfo> createUnifiedMeshBuffer(
     return v_buffer;
 }
 
-void loadMtx2Texture(
-    const std::shared_ptr<renderer::Device>& device,
-    const std::shared_ptr<renderer::RenderPass>& cubemap_render_pass,
+void readMtx2Texture(
     const std::string& input_filename,
-    renderer::TextureInfo& texture) {
-    uint64_t buffer_size;
-    auto mtx2_data = engine::helper::readFile(input_filename, buffer_size);
-    auto src_data = (char*)mtx2_data.data();
+    Mtx2Texture& mtx2_texture) {
+    mtx2_texture.file = std::make_unique<MappedFile>(input_filename);
+    auto mtx2_data = reinterpret_cast<const char*>(mtx2_texture.file->data());
+    auto src_data = mtx2_data;
 
     // header block
-    Mtx2HeaderBlock* header_block = reinterpret_cast<Mtx2HeaderBlock*>(src_data);
+    const Mtx2HeaderBlock* header_block = reinterpret_cast<const Mtx2HeaderBlock*>(src_data);
     src_data += sizeof(Mtx2HeaderBlock);
 
     assert(header_block->format == renderer::Format::R16G16B16A16_SFLOAT);
 
     // index block
-    Mtx2IndexBlock* index_block = reinterpret_cast<Mtx2IndexBlock*>(src_data);
+    const Mtx2IndexBlock* index_block = reinterpret_cast<const Mtx2IndexBlock*>(src_data);
     src_data += sizeof(Mtx2IndexBlock);
 
     uint32_t width = header_block->pixel_width;
     uint32_t height = header_block->pixel_height;
     // level index block.
     uint32_t num_level_blocks = std::max(1u, header_block->level_count);
-    std::vector<renderer::BufferImageCopyInfo> copy_regions(num_level_blocks);
+    auto& copy_regions = mtx2_texture.copy_regions;
+    copy_regions.resize(num_level_blocks);
+    // levels are stored smallest first, all of them back to back behind the headers.
+    uint64_t level_data_begin = mtx2_texture.file->size();
+    uint64_t level_data_end = 0;
     for (uint32_t i_level = 0; i_level < num_level_blocks; i_level++) {
-        Mtx2LevelIndexBlock* level_block = reinterpret_cast<Mtx2LevelIndexBlock*>(src_data);
+        const Mtx2LevelIndexBlock* level_block =
+            reinterpret_cast<const Mtx2LevelIndexBlock*>(src_data);
+        level_data_begin = std::min(level_data_begin, level_block->byte_offset);
+        level_data_end =
+            std::max(level_data_end, level_block->byte_offset + level_block->byte_length);
 
         auto& region = copy_regions[i_level];
         region.buffer_offset = level_block->byte_offset;
@@ -176,34 +215,56 @@ void loadMtx2Texture(
         src_data += sizeof(Mtx2LevelIndexBlock);
     }
 
-    char* dfd_data_start = (char*)mtx2_data.data() + index_block->dfd_byte_offset;
-    uint32_t dfd_total_size = *reinterpret_cast<uint32_t*>(dfd_data_start);
+    const char* dfd_data_start = mtx2_data + index_block->dfd_byte_offset;
+    uint32_t dfd_total_size = *reinterpret_cast<const uint32_t*>(dfd_data_start);
     src_data += sizeof(uint32_t);
 
-    char* kvd_data_start = (char*)mtx2_data.data() + index_block->kvd_byte_offset;
-    uint32_t key_value_byte_length = *reinterpret_cast<uint32_t*>(kvd_data_start);
-    uint8_t* key_value = reinterpret_cast<uint8_t*>(kvd_data_start + 4);
+    const char* kvd_data_start = mtx2_data + index_block->kvd_byte_offset;
+    uint32_t key_value_byte_length = *reinterpret_cast<const uint32_t*>(kvd_data_start);
+    const uint8_t* key_value = reinterpret_cast<const uint8_t*>(kvd_data_start + 4);
     for (uint32_t i = 0; i < key_value_byte_length; i++) {
         auto result = key_value[i];
         int hit = 1;
     }
 
-    char* sgd_data_start = nullptr;
+    const char* sgd_data_start = nullptr;
     if (index_block->sgd_byte_length > 0) {
-        sgd_data_start = (char*)mtx2_data.data() + index_block->sgd_byte_offset;
+        sgd_data_start = mtx2_data + index_block->sgd_byte_offset;
     }
 
+    // regions relative to the first level, the headers never reach the staging buffer.
+    for (auto& region : copy_regions) {
+        region.buffer_offset -= level_data_begin;
+    }
+    mtx2_texture.level_data_offset = level_data_begin;
+    mtx2_texture.level_data_size = level_data_end - level_data_begin;
+    // the upload copies straight out of the mapping, start pulling the pixels in now.
+    mtx2_texture.file->prefetch(level_data_begin, mtx2_texture.level_data_size);
+
+    mtx2_texture.size = glm::uvec2(header_block->pixel_width, header_block->pixel_height);
+    mtx2_texture.mip_count = num_level_blocks;
+    mtx2_texture.format = header_block->format;
+}
+
+void loadMtx2Texture(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::shared_ptr<renderer::RenderPass>& cubemap_render_pass,
+    const std::string& input_filename,
+    renderer::TextureInfo& texture) {
+    Mtx2Texture mtx2_texture;
+    readMtx2Texture(input_filename, mtx2_texture);
+
     renderer::Helper::createCubemapTexture(
         device,
         cubemap_render_pass,
-        header_block->pixel_width,
-        header_block->pixel_height,
-        num_level_blocks,
-        header_block->format,
-        copy_regions,
+        mtx2_texture.size.x,
+        mtx2_texture.size.y,
+        mtx2_texture.mip_count,
+        mtx2_texture.format,
+        mtx2_texture.copy_regions,
         texture,
-        buffer_size,
-        mtx2_data.data());
+        mtx2_texture.level_data_size,
+        mtx2_texture.getLevelData());
 }
 
 void saveDdsTexture(
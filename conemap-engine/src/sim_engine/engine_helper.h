@@ -2,6 +2,7 @@
 #define __STDC_LIB_EXT1__
 #include <vector>
 #include "renderer/renderer.h"
+#include "mapped_file.h"
 
 namespace engine {
 namespace helper {
@@ -17,18 +18,55 @@ void writeImageFile(
     const uint32_t& image_size,
     const void* image_data);
 
+// pixels of an image file, decoded on any thread and uploaded later by the device thread.
+struct DecodedImage {
+    renderer::Format format = renderer::Format::R8G8B8A8_UNORM;
+    glm::uvec2 size = glm::uvec2(0);
+    std::shared_ptr<void> pixels;
+};
+
+// R16_UNORM decodes to 16 bit grey, anything else to rgba8.
+DecodedImage decodeImageFile(
+    const std::string& file_name,
+    renderer::Format format);
+
 void createTextureImage(
     const std::shared_ptr<renderer::Device>& device,
     const std::string& file_name,
     renderer::Format format,
     renderer::TextureInfo& texture);
 
+// rgba8 pixels on cpu, same data createTextureImage uploads for rgba8 formats.
+std::vector<uint8_t> loadImageFile(
+    const std::string& file_name,
+    glm::uvec2& size);
+
 std::shared_ptr<renderer::BufferInfo> createUnifiedMeshBuffer(
     const std::shared_ptr<renderer::Device>& device,
     const renderer::BufferUsageFlags& usage,
     const uint64_t& size,
     const void* data);
 
+// ktx2 cube map parsed in place out of its mapped file on any thread. only the level data
+// gets uploaded, the copy regions are relative to getLevelData().
+struct Mtx2Texture {
+    std::unique_ptr<MappedFile> file;
+    uint64_t level_data_offset = 0;
+    uint64_t level_data_size = 0;
+    glm::uvec2 size = glm::uvec2(0);
+    uint32_t mip_count = 1;
+    renderer::Format format = renderer::Format::R16G16B16A16_SFLOAT;
+    std::vector<renderer::BufferImageCopyInfo> copy_regions;
+
+    const void* getLevelData() const {
+        return file->data() + level_data_offset;
+    }
+};
+
+void readMtx2Texture(
+    const std::string& input_filename,
+    Mtx2Texture& mtx2_texture);
+
 void loadMtx2Texture(
     const std::shared_ptr<renderer::Device>& device,
     const std::shared_ptr<renderer::RenderPass>& cubemap_render_pass,
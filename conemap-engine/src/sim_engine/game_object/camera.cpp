@@ -93,7 +93,8 @@ void GameCamera::initGameCameraBuffer(
         game_camera_buffer_ = std::make_shared<renderer::BufferInfo>();
         device->createBuffer(
             sizeof(glsl::GameCameraInfo),
-            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, TRANSFER_SRC_BIT),
             SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
             SET_FLAG_BIT(MemoryProperty, HOST_CACHED_BIT),
             0,
@@ -10,14 +10,17 @@ namespace scene_rendering {
 namespace game_object {
 
 class ConemapObj {
-    std::shared_ptr<renderer::DescriptorSetLayout> gen_minmax_depth_desc_set_layout_;
-    std::shared_ptr<renderer::DescriptorSet> gen_minmax_depth_tex_desc_set_;
+    std::shared_ptr<renderer::BindlessTextureTable> bindless_table_;
+    uint32_t minmax_src_tex_slot_ = 0;
+    uint32_t minmax_dst_tex_slot_ = 0;
     std::shared_ptr<renderer::PipelineLayout> gen_minmax_depth_pipeline_layout_;
     std::shared_ptr<renderer::Pipeline> gen_minmax_depth_pipeline_;
 
     std::shared_ptr<renderer::DescriptorSet> prt_shadow_cache_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> prt_shadow_cache_update_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> prt_shadow_gen_tex_desc_set_;
+    std::shared_ptr<renderer::DescriptorSet> prt_shadow_gen_low_res_tex_desc_set_;
+    std::shared_ptr<renderer::DescriptorSet> prt_upsample_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> gen_prt_pack_info_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> pack_prt_tex_desc_set_;
     std::shared_ptr<renderer::TextureInfo> conemap_tex_;
@@ -27,6 +30,9 @@ class ConemapObj {
 
     uint32_t depth_channel_ = 0;
     bool is_height_map_ = false;
+    bool is_high_precision_conemap_ = false;
+    bool is_tileable_ = false;
+    uint32_t tile_wrap_radius_ = 0;
     float depth_scale_ = 0.0f;
     float shadow_intensity_ = 0.0f;
     float shadow_noise_thread_ = 0.0f;
@@ -35,6 +41,7 @@ public:
     ConemapObj(
         const std::shared_ptr<renderer::Device>& device,
         const std::shared_ptr<renderer::DescriptorPool>& descriptor_pool,
+        const std::shared_ptr<renderer::BindlessTextureTable>& bindless_table,
         const std::shared_ptr<renderer::Sampler>& texture_sampler,
         const renderer::TextureInfo& prt_bump_tex,
         const std::shared_ptr<scene_rendering::PrtShadow>& prt_shadow_gen,
@@ -42,7 +49,8 @@ public:
         bool is_height_depth,
         float depth_scale,
         float shadow_intensity,
-        float shadow_noise_thread);
+        float shadow_noise_thread,
+        bool is_high_precision_conemap = false);
 
     void update(
         const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
@@ -59,6 +67,26 @@ public:
         return is_height_map_;
     }
 
+    // rgba16f conemap with cone tangent stored directly, rgba8 with atan(tangent) / (pi / 2) otherwise.
+    inline bool isHighPrecisionConemap() {
+        return is_high_precision_conemap_;
+    }
+
+    // source repeats past its border, conemap and prt rays run on through the neighbour
+    // tiles for up to wrap_radius pixels, so the baked maps tile without seams.
+    inline void setTileable(bool is_tileable, uint32_t wrap_radius) {
+        is_tileable_ = is_tileable;
+        tile_wrap_radius_ = is_tileable ? wrap_radius : 0;
+    }
+
+    inline bool isTileable() {
+        return is_tileable_;
+    }
+
+    inline uint32_t getTileWrapRadius() {
+        return tile_wrap_radius_;
+    }
+
     inline float getShadowNoiseThread() {
         return shadow_noise_thread_;
     }
@@ -75,6 +103,14 @@ public:
         return prt_shadow_gen_tex_desc_set_;
     }
 
+    inline const std::shared_ptr<renderer::DescriptorSet>& getPrtShadowGenLowResTexDescSet() {
+        return prt_shadow_gen_low_res_tex_desc_set_;
+    }
+
+    inline const std::shared_ptr<renderer::DescriptorSet>& getPrtUpsampleTexDescSet() {
+        return prt_upsample_tex_desc_set_;
+    }
+
     inline const std::shared_ptr<renderer::DescriptorSet>& getPrtShadowCacheTexDescSet() {
         return prt_shadow_cache_tex_desc_set_;
     }
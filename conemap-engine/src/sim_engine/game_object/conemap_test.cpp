@@ -1,4 +1,6 @@
+#include <iostream>
 #include "conemap_test.h"
+#include "camera.h"
 #include "engine_helper.h"
 #include "renderer/renderer.h"
 #include "renderer/renderer_helper.h"
@@ -7,137 +9,6 @@
 namespace engine {
 namespace {
 
-static float getKValueFast(int l, int m)
-{
-    const float s_factorial_serials[9] =
-    { 1.0f, 1.0f, 2.0f, 6.0f, 24.0f, 120.0f, 720.0f, 5040.0f, 40320.0f };
-    float factor = sqrt((2 * l + 1) / (4.0f * glm::pi<float>()));
-    return sqrt(factor * s_factorial_serials[l - abs(m)] / s_factorial_serials[l + abs(m)]);
-}
-
-static void fillPVauleTablle(float p_value[15], float x) {
-    float x2 = x * x;
-    float x2_s7 = 7.0f * x2;
-    float x2_1 = 1.0f - x2;
-    float x2_1sqrt = sqrt(x2_1);
-    float x2_1_2_3rd = x2_1sqrt * x2_1;
-    float inv_x2_1_2_3rd = 1.0f / x2_1_2_3rd;
-    float x2_1sqr = x2_1 * x2_1;
-
-    // l = 0, m = 0
-    p_value[0] = 1.0f;
-    // l = 1, m = 0
-    p_value[1] = x;
-    // l = 1, m = 1
-    p_value[2] = -x2_1sqrt;
-    float a00 = x * x2_1sqrt;
-    // l = 2, m = 0
-    p_value[3] = 0.5f * (3.0f * x2 - 1.0f);
-    // l = 2, m = 1
-    p_value[4] = -3.0f * a00;
-    // l = 2, m = 2
-    p_value[5] = 3.0f * x2_1;
-    float a01 = (-5.0f * x2 + 1.0f) * x2_1sqrt;
-    // l = 3, m = 0
-    p_value[6] = 0.5f * x * (5.0f * x2 - 3.0f);
-    // l = 3, m = 1
-    p_value[7] = 1.5f * a01;
-    // l = 3, m = 2
-    p_value[8] = 15.0f * x * x2_1;
-    // l = 3, m = 3
-    p_value[9] = -15.0f * x2_1_2_3rd;
-    float a02 = (-x2_s7 + 3.0f) * a00;
-    // l = 4, m = 0
-    p_value[10] = 0.125f * ((35.0f * x2 - 30.0f) * x2 + 3.0f);
-    // l = 4, m = 1
-    p_value[11] = 2.5f * a02;
-    // l = 4, m = 2
-    p_value[12] = 7.5f * (x2_s7 - 1.0f) * x2_1;
-    // l = 4, m = 3
-    p_value[13] = -105.0f * x * x2_1_2_3rd;
-    // l = 4, m = 4
-    p_value[14] = 105.0f * x2_1sqr;
-}
-
-static void fillYVauleTablle(float y_value[25], float theta, float phi) {
-    const float sqrt2 = sqrt(2.0f);
-
-    float cos_theta = cos(theta);
-    float sin_phi = sin(phi);
-    float cos_phi = cos(phi);
-    float sin_2phi = sin(2.0f * phi);
-    float cos_2phi = cos(2.0f * phi);
-    float sin_3phi = sin(3.0f * phi);
-    float cos_3phi = cos(3.0f * phi);
-    float sin_4phi = sin(4.0f * phi);
-    float cos_4phi = cos(4.0f * phi);
-
-    float p_value[15];
-    fillPVauleTablle(p_value, cos_theta);
-
-    float a11 = sqrt2 * getKValueFast(1, 1) * p_value[2];
-    float a22 = sqrt2 * getKValueFast(2, 2) * p_value[5];
-    float a21 = sqrt2 * getKValueFast(2, 1) * p_value[4];
-    float a33 = sqrt2 * getKValueFast(3, 3) * p_value[9];
-    float a32 = sqrt2 * getKValueFast(3, 2) * p_value[8];
-    float a31 = sqrt2 * getKValueFast(3, 1) * p_value[7];
-    float a44 = sqrt2 * getKValueFast(4, 4) * p_value[14];
-    float a43 = sqrt2 * getKValueFast(4, 3) * p_value[13];
-    float a42 = sqrt2 * getKValueFast(4, 2) * p_value[12];
-    float a41 = sqrt2 * getKValueFast(4, 1) * p_value[11];
-
-    // l = 0, m = 0
-    y_value[0] = getKValueFast(0, 0) * p_value[0];
-    // l = 1, m = -1
-    y_value[1] = sin_phi * a11;
-    // l = 1, m = 0
-    y_value[2] = getKValueFast(1, 0) * p_value[1];
-    // l = 1, m = 1
-    y_value[3] = cos_phi * a11;
-    // l = 2, m = -2
-    y_value[4] = sin_2phi * a22;
-    // l = 2, m = -1
-    y_value[5] = sin_phi * a21;
-    // l = 2, m = 0
-    y_value[6] = getKValueFast(2, 0) * p_value[3];
-    // l = 2, m = 1
-    y_value[7] = cos_phi * a21;
-    // l = 2, m = 2
-    y_value[8] = cos_2phi * a22;
-    // l = 3, m = -3
-    y_value[9] = sin_3phi * a33;
-    // l = 3, m = -2
-    y_value[10] = sin_2phi * a32;
-    // l = 3, m = -1
-    y_value[11] = sin_phi * a31;
-    // l = 3, m = 0
-    y_value[12] = getKValueFast(3, 0) * p_value[6];
-    // l = 3, m = 1
-    y_value[13] = cos_phi * a31;
-    // l = 3, m = 2
-    y_value[14] = cos_2phi * a32;
-    // l = 3, m = 3
-    y_value[15] = cos_3phi * a33;
-    // l = 4, m = -4
-    y_value[16] = sin_4phi * a44;
-    // l = 4, m = -3
-    y_value[17] = sin_3phi * a43;
-    // l = 4, m = -2
-    y_value[18] = sin_2phi * a42;
-    // l = 4, m = -1
-    y_value[19] = sin_phi * a41;
-    // l = 4, m = 0
-    y_value[20] = getKValueFast(4, 0) * p_value[10];
-    // l = 4, m = 1
-    y_value[21] = cos_phi * a41;
-    // l = 4, m = 2
-    y_value[22] = cos_2phi * a42;
-    // l = 4, m = 3
-    y_value[23] = cos_3phi * a43;
-    // l = 4, m = 4
-    y_value[24] = cos_4phi * a44;
-}
-
 static std::shared_ptr<renderer::DescriptorSetLayout> createPrtDescriptorSetLayout(
     const std::shared_ptr<renderer::Device>& device) {
     std::vector<renderer::DescriptorSetLayoutBinding> bindings;
@@ -166,11 +37,61 @@ static std::shared_ptr<renderer::DescriptorSetLayout> createPrtDescriptorSetLayo
     renderer::DescriptorSetLayoutBinding ubo_pbr_layout_binding{};
     ubo_pbr_layout_binding.binding = PBR_CONSTANT_INDEX;
     ubo_pbr_layout_binding.descriptor_count = 1;
-    ubo_pbr_layout_binding.descriptor_type = renderer::DescriptorType::UNIFORM_BUFFER;
+    ubo_pbr_layout_binding.descriptor_type = renderer::DescriptorType::UNIFORM_BUFFER_DYNAMIC;
     ubo_pbr_layout_binding.stage_flags = SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT);
     ubo_pbr_layout_binding.immutable_samplers = nullptr; // Optional
     bindings.push_back(ubo_pbr_layout_binding);
 
+    renderer::DescriptorSetLayoutBinding step_stats_layout_binding{};
+    step_stats_layout_binding.binding = CONEMAP_STEP_STATS_INDEX;
+    step_stats_layout_binding.descriptor_count = 1;
+    step_stats_layout_binding.descriptor_type = renderer::DescriptorType::STORAGE_BUFFER;
+    step_stats_layout_binding.stage_flags = SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT);
+    step_stats_layout_binding.immutable_samplers = nullptr; // Optional
+    bindings.push_back(step_stats_layout_binding);
+
+    renderer::DescriptorSetLayoutBinding prev_camera_layout_binding{};
+    prev_camera_layout_binding.binding = CONEMAP_PREV_CAMERA_INDEX;
+    prev_camera_layout_binding.descriptor_count = 1;
+    prev_camera_layout_binding.descriptor_type = renderer::DescriptorType::STORAGE_BUFFER;
+    prev_camera_layout_binding.stage_flags = SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT);
+    prev_camera_layout_binding.immutable_samplers = nullptr; // Optional
+    bindings.push_back(prev_camera_layout_binding);
+
+    bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            CONEMAP_HISTORY_TEX_INDEX_0,
+            SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+            renderer::DescriptorType::STORAGE_IMAGE));
+    bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            CONEMAP_HISTORY_TEX_INDEX_1,
+            SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+            renderer::DescriptorType::STORAGE_IMAGE));
+    bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            CONEMAP_PARALLAX_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+            renderer::DescriptorType::STORAGE_IMAGE));
+    bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            VISIBILITY_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+            renderer::DescriptorType::STORAGE_IMAGE));
+    for (uint32_t binding = VISIBILITY_POSITION_BUFFER_INDEX;
+         binding <= VISIBILITY_INDEX_BUFFER_INDEX; binding++) {
+        bindings.push_back(
+            renderer::helper::getBufferDescriptionSetLayoutBinding(
+                binding,
+                SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+                renderer::DescriptorType::STORAGE_BUFFER));
+    }
+    bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_LIGHT_COEFFS_INDEX,
+            SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+            renderer::DescriptorType::STORAGE_BUFFER_DYNAMIC));
+
     return device->createDescriptorSetLayout(bindings);
 }
 
@@ -183,10 +104,12 @@ static renderer::WriteDescriptorList addPrtTestTextures(
     const std::shared_ptr<renderer::TextureInfo>& conemap_tex,
     const std::shared_ptr<renderer::TextureInfo>& prt_pack_texture,
     const std::shared_ptr<renderer::TextureInfo>& prt_pack_info_texture,
-    const std::shared_ptr<renderer::BufferInfo>& uniform_buffer) {
+    const std::shared_ptr<renderer::UniformBufferRing>& uniform_ring,
+    const std::shared_ptr<renderer::BufferInfo>& step_stats_buffer,
+    const std::shared_ptr<renderer::TextureInfo>& parallax_texture) {
 
     renderer::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(10);
+    descriptor_writes.reserve(13);
 
     // diffuse.
     renderer::Helper::addOneTexture(
@@ -285,13 +208,192 @@ static renderer::WriteDescriptorList addPrtTestTextures(
         prt_pack_info_texture->view,
         renderer::ImageLayout::GENERAL);
 
+    // material block moves through the ring every frame, bound with a dynamic offset.
     renderer::Helper::addOneBuffer(
         descriptor_writes,
         desc_set,
-        renderer::DescriptorType::UNIFORM_BUFFER,
+        renderer::DescriptorType::UNIFORM_BUFFER_DYNAMIC,
         PBR_CONSTANT_INDEX,
-        uniform_buffer->buffer,
-        uniform_buffer->buffer->getSize());
+        uniform_ring->buffer,
+        sizeof(glsl::PbrMaterialParams));
+
+    renderer::Helper::addOneBuffer(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_BUFFER,
+        CONEMAP_STEP_STATS_INDEX,
+        step_stats_buffer->buffer,
+        step_stats_buffer->buffer->getSize());
+
+    renderer::Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_IMAGE,
+        CONEMAP_PARALLAX_TEX_INDEX,
+        nullptr,
+        parallax_texture->view,
+        renderer::ImageLayout::GENERAL);
+
+    // light sh coefficients get rewritten every frame too, same ring, own dynamic offset.
+    renderer::Helper::addOneBuffer(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_BUFFER_DYNAMIC,
+        PRT_LIGHT_COEFFS_INDEX,
+        uniform_ring->buffer,
+        sizeof(glsl::PrtLightCoeffs));
+
+    return descriptor_writes;
+}
+
+static renderer::WriteDescriptorList addVisibilityBuffers(
+    const std::shared_ptr<renderer::DescriptorSet>& desc_set,
+    const std::shared_ptr<renderer::TextureInfo>& visibility_texture,
+    const std::shared_ptr<game_object::Plane>& unit_plane) {
+
+    renderer::WriteDescriptorList descriptor_writes;
+    descriptor_writes.reserve(6);
+
+    renderer::Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_IMAGE,
+        VISIBILITY_TEX_INDEX,
+        nullptr,
+        visibility_texture->view,
+        renderer::ImageLayout::GENERAL);
+
+    const std::pair<uint32_t, std::shared_ptr<renderer::BufferInfo>> mesh_buffers[] = {
+        { VISIBILITY_POSITION_BUFFER_INDEX, unit_plane->getPositionBuffer() },
+        { VISIBILITY_NORMAL_BUFFER_INDEX, unit_plane->getNormalBuffer() },
+        { VISIBILITY_TANGENT_BUFFER_INDEX, unit_plane->getTangentBuffer() },
+        { VISIBILITY_UV_BUFFER_INDEX, unit_plane->getUvBuffer() },
+        { VISIBILITY_INDEX_BUFFER_INDEX, unit_plane->getIndexBuffer() } };
+
+    for (const auto& mesh_buffer : mesh_buffers) {
+        renderer::Helper::addOneBuffer(
+            descriptor_writes,
+            desc_set,
+            renderer::DescriptorType::STORAGE_BUFFER,
+            mesh_buffer.first,
+            mesh_buffer.second->buffer,
+            mesh_buffer.second->buffer->getSize());
+    }
+
+    return descriptor_writes;
+}
+
+static std::shared_ptr<renderer::DescriptorSetLayout> createParallaxDescriptorSetLayout(
+    const std::shared_ptr<renderer::Device>& device) {
+    return device->createDescriptorSetLayout(
+        { renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            renderer::DescriptorType::COMBINED_IMAGE_SAMPLER),
+          renderer::helper::getBufferDescriptionSetLayoutBinding(
+            CAMERA_OBJECT_BUFFER_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            renderer::DescriptorType::STORAGE_BUFFER),
+          renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            renderer::DescriptorType::STORAGE_IMAGE) });
+}
+
+static renderer::WriteDescriptorList addParallaxTextures(
+    const std::shared_ptr<renderer::DescriptorSet>& desc_set,
+    const std::shared_ptr<renderer::Sampler>& texture_sampler,
+    const std::shared_ptr<renderer::TextureInfo>& conemap_tex,
+    const std::shared_ptr<renderer::BufferInfo>& camera_buffer,
+    const std::shared_ptr<renderer::TextureInfo>& parallax_texture) {
+
+    renderer::WriteDescriptorList descriptor_writes;
+    descriptor_writes.reserve(3);
+
+    renderer::Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::COMBINED_IMAGE_SAMPLER,
+        SRC_TEX_INDEX,
+        texture_sampler,
+        conemap_tex->view,
+        renderer::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
+
+    renderer::Helper::addOneBuffer(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_BUFFER,
+        CAMERA_OBJECT_BUFFER_INDEX,
+        camera_buffer->buffer,
+        camera_buffer->buffer->getSize());
+
+    renderer::Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_IMAGE,
+        DST_TEX_INDEX,
+        nullptr,
+        parallax_texture->view,
+        renderer::ImageLayout::GENERAL);
+
+    return descriptor_writes;
+}
+
+// unit plane stretched to the aspect ratio of the conemap.
+static glm::mat4 getUnitPlaneModelMatrix(const glm::uvec2& buffer_size) {
+    return glm::mat4(
+        glm::vec4(float(buffer_size.x) / float(buffer_size.y) * 1.0f, 0, 0, 0),
+        glm::vec4(0, 1, 0, 0),
+        glm::vec4(0, 0, 1, 0),
+        glm::vec4(0, 0, 0, 1));
+}
+
+// extra instances of the stress scene get laid out next to the original plane, row by row,
+// so each one is its own object with its own transform instead of overdraw at one depth.
+static glm::mat4 getStressInstanceModelMatrix(
+    const glm::mat4& model_mat,
+    uint32_t instance_idx) {
+    const uint32_t grid_width = 16;
+    const float gap = 0.1f;
+    auto column = instance_idx % grid_width;
+    auto row = instance_idx / grid_width;
+
+    auto result = model_mat;
+    result[3] +=
+        glm::vec4(
+            float(column) * (2.0f * model_mat[0][0] + gap),
+            0.0f,
+            float(row) * (2.0f * model_mat[2][2] + gap),
+            0.0f);
+    return result;
+}
+
+static renderer::WriteDescriptorList addTemporalHistoryBuffers(
+    const std::shared_ptr<renderer::DescriptorSet>& desc_set,
+    const std::shared_ptr<renderer::BufferInfo>& prev_camera_buffer,
+    const std::shared_ptr<renderer::TextureInfo> hit_history_texes[2]) {
+
+    renderer::WriteDescriptorList descriptor_writes;
+    descriptor_writes.reserve(3);
+
+    renderer::Helper::addOneBuffer(
+        descriptor_writes,
+        desc_set,
+        renderer::DescriptorType::STORAGE_BUFFER,
+        CONEMAP_PREV_CAMERA_INDEX,
+        prev_camera_buffer->buffer,
+        prev_camera_buffer->buffer->getSize());
+
+    for (int i = 0; i < 2; i++) {
+        renderer::Helper::addOneTexture(
+            descriptor_writes,
+            desc_set,
+            renderer::DescriptorType::STORAGE_IMAGE,
+            CONEMAP_HISTORY_TEX_INDEX_0 + i,
+            nullptr,
+            hit_history_texes[i]->view,
+            renderer::ImageLayout::GENERAL);
+    }
 
     return descriptor_writes;
 }
@@ -314,6 +416,46 @@ static std::shared_ptr<renderer::PipelineLayout> createPipelineLayout(
     return device->createPipelineLayout(desc_set_layouts, { push_const_range });
 }
 
+static std::shared_ptr<renderer::PipelineLayout> createVisibilityPipelineLayout(
+    const std::shared_ptr<renderer::Device>& device,
+    const renderer::DescriptorSetLayoutList& global_desc_set_layouts) {
+
+    renderer::PushConstantRange push_const_range{};
+    push_const_range.stage_flags =
+        SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
+        SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT);
+    push_const_range.offset = 0;
+    push_const_range.size = sizeof(glsl::ConemapVisibilityParams);
+
+    return device->createPipelineLayout(global_desc_set_layouts, { push_const_range });
+}
+
+// depth only, color attachment stays untouched.
+static renderer::GraphicPipelineInfo getDepthPrepassPipelineInfo(
+    const renderer::GraphicPipelineInfo& graphic_pipeline_info) {
+    static std::vector<renderer::PipelineColorBlendAttachmentState> s_no_color_write_attachments(
+        1, renderer::helper::fillPipelineColorBlendAttachmentState(0));
+
+    auto pipeline_info = graphic_pipeline_info;
+    pipeline_info.blend_state_info =
+        std::make_shared<renderer::PipelineColorBlendStateCreateInfo>(
+            renderer::helper::fillPipelineColorBlendStateCreateInfo(s_no_color_write_attachments));
+    return pipeline_info;
+}
+
+// rasterized plane depth is always in front of the prepass depth of the same surface.
+static renderer::GraphicPipelineInfo getEarlyDepthTestPipelineInfo(
+    const renderer::GraphicPipelineInfo& graphic_pipeline_info) {
+    auto pipeline_info = graphic_pipeline_info;
+    pipeline_info.depth_stencil_info =
+        std::make_shared<renderer::PipelineDepthStencilStateCreateInfo>(
+            renderer::helper::fillPipelineDepthStencilStateCreateInfo(
+                true,
+                false,
+                renderer::CompareOp::LESS_OR_EQUAL));
+    return pipeline_info;
+}
+
 } // namespace
 
 namespace game_object {
@@ -321,8 +463,10 @@ namespace game_object {
 ConemapTest::ConemapTest(
     const std::shared_ptr<renderer::Device>& device,
     const std::shared_ptr<renderer::DescriptorPool>& descriptor_pool,
+    const std::shared_ptr<renderer::UniformBufferRing>& uniform_ring,
     const std::shared_ptr<renderer::RenderPass>& render_pass,
     const renderer::GraphicPipelineInfo& graphic_pipeline_info,
+    const renderer::GraphicPipelineInfo& graphic_fs_pipeline_info,
     const renderer::DescriptorSetLayoutList& global_desc_set_layouts,
     const std::shared_ptr<renderer::Sampler>& texture_sampler,
     const renderer::TextureInfo& prt_base_tex,
@@ -341,16 +485,53 @@ ConemapTest::ConemapTest(
     prt_desc_set_ = device->createDescriptorSets(
         descriptor_pool, prt_desc_set_layout_, 1)[0];
 
-    uniform_buffer_ = std::make_shared<renderer::BufferInfo>();
+    uniform_ring_ = uniform_ring;
+
+    is_high_precision_conemap_ = conemap_obj->isHighPrecisionConemap();
+    step_stats_buffer_ = std::make_shared<renderer::BufferInfo>();
     device->createBuffer(
-        sizeof(glsl::PbrMaterialParams),
-        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT) |
-        SET_FLAG_BIT(BufferUsage, UNIFORM_BUFFER_BIT),
+        sizeof(glsl::ConemapStepStats),
+        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
         SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
-        SET_FLAG_BIT(MemoryProperty, HOST_CACHED_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
         0,
-        uniform_buffer_->buffer,
-        uniform_buffer_->memory);
+        step_stats_buffer_->buffer,
+        step_stats_buffer_->memory);
+
+    glsl::ConemapStepStats step_stats{};
+    device->updateBufferMemory(
+        step_stats_buffer_->memory,
+        sizeof(step_stats),
+        &step_stats);
+
+    // allocated for the smallest downscale, quarter resolution only uses the top left part.
+    display_size_ = display_size;
+    parallax_tex_ = std::make_shared<renderer::TextureInfo>();
+    renderer::Helper::create2DTextureImage(
+        device,
+        renderer::Format::R32G32B32A32_SFLOAT,
+        (display_size + glm::uvec2(1)) / glm::uvec2(2),
+        *parallax_tex_,
+        SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
+        renderer::ImageLayout::GENERAL);
+
+    visibility_tex_ = std::make_shared<renderer::TextureInfo>();
+    renderer::Helper::create2DTextureImage(
+        device,
+        renderer::Format::R32_UINT,
+        display_size,
+        *visibility_tex_,
+        SET_FLAG_BIT(ImageUsage, COLOR_ATTACHMENT_BIT) |
+        SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
+        renderer::ImageLayout::GENERAL);
+
+    auto depth_format = renderer::Helper::findDepthFormat(device);
+    visibility_depth_tex_ = std::make_shared<renderer::TextureInfo>();
+    renderer::Helper::createDepthResources(
+        device,
+        depth_format,
+        display_size,
+        *visibility_depth_tex_);
 
     // create a global ibl texture descriptor set.
     auto prt_test_material_descs =
@@ -363,10 +544,78 @@ ConemapTest::ConemapTest(
             conemap_obj->getConemapTexture(),
             conemap_obj->getPackTexture(),
             conemap_obj->getPackInfoTexture(),
-            uniform_buffer_);
+            uniform_ring_,
+            step_stats_buffer_,
+            parallax_tex_);
+
+    auto visibility_descs =
+        addVisibilityBuffers(
+            prt_desc_set_,
+            visibility_tex_,
+            unit_plane);
+
+    device->updateDescriptorSets(visibility_descs);
 
     device->updateDescriptorSets(prt_test_material_descs);
 
+    prev_camera_buffer_ = std::make_shared<renderer::BufferInfo>();
+    device->createBuffer(
+        sizeof(glsl::GameCameraInfo),
+        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT) |
+        SET_FLAG_BIT(BufferUsage, TRANSFER_DST_BIT),
+        SET_FLAG_BIT(MemoryProperty, DEVICE_LOCAL_BIT),
+        0,
+        prev_camera_buffer_->buffer,
+        prev_camera_buffer_->memory);
+
+    for (auto& tex : hit_history_texes_) {
+        tex = std::make_shared<renderer::TextureInfo>();
+        renderer::Helper::create2DTextureImage(
+            device,
+            renderer::Format::R32G32B32A32_SFLOAT,
+            display_size,
+            *tex,
+            SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
+            renderer::ImageLayout::GENERAL);
+    }
+
+    auto temporal_history_descs =
+        addTemporalHistoryBuffers(
+            prt_desc_set_,
+            prev_camera_buffer_,
+            hit_history_texes_);
+
+    device->updateDescriptorSets(temporal_history_descs);
+
+    parallax_desc_set_layout_ = createParallaxDescriptorSetLayout(device);
+
+    parallax_desc_set_ = device->createDescriptorSets(
+        descriptor_pool, parallax_desc_set_layout_, 1)[0];
+
+    auto parallax_descs =
+        addParallaxTextures(
+            parallax_desc_set_,
+            texture_sampler,
+            conemap_obj->getConemapTexture(),
+            GameCamera::getGameCameraBuffer(),
+            parallax_tex_);
+
+    device->updateDescriptorSets(parallax_descs);
+
+    parallax_pipeline_layout_ =
+        renderer::helper::createComputePipelineLayout(
+            device,
+            { parallax_desc_set_layout_ },
+            sizeof(glsl::ConemapParallaxParams));
+
+    parallax_pipeline_ =
+        renderer::helper::createComputePipeline(
+            device,
+            parallax_pipeline_layout_,
+            is_high_precision_conemap_ ?
+                "conemap_parallax_hp_comp.spv" :
+                "conemap_parallax_comp.spv");
+
     prt_pipeline_layout_ = createPipelineLayout(
         device,
         global_desc_set_layouts,
@@ -385,7 +634,9 @@ ConemapTest::ConemapTest(
     shader_modules[1] =
         renderer::helper::loadShaderModule(
             device,
-            "conemap_test_frag.spv",
+            is_high_precision_conemap_ ?
+                "conemap_test_hp_frag.spv" :
+                "conemap_test_frag.spv",
             renderer::ShaderStageFlagBits::FRAGMENT_BIT);
 
     prt_pipeline_ = device->createPipeline(
@@ -397,67 +648,339 @@ ConemapTest::ConemapTest(
         graphic_pipeline_info,
         shader_modules,
         display_size);
+
+    renderer::ShaderModuleList depth_prepass_shader_modules(2);
+    depth_prepass_shader_modules[0] = shader_modules[0];
+    depth_prepass_shader_modules[1] =
+        renderer::helper::loadShaderModule(
+            device,
+            is_high_precision_conemap_ ?
+                "conemap_depth_prepass_hp_frag.spv" :
+                "conemap_depth_prepass_frag.spv",
+            renderer::ShaderStageFlagBits::FRAGMENT_BIT);
+
+    depth_prepass_pipeline_ = device->createPipeline(
+        render_pass,
+        prt_pipeline_layout_,
+        unit_plane->getBindingDescs(),
+        unit_plane->getAttribDescs(),
+        input_assembly,
+        getDepthPrepassPipelineInfo(graphic_pipeline_info),
+        depth_prepass_shader_modules,
+        display_size);
+
+    renderer::ShaderModuleList early_z_shader_modules(2);
+    early_z_shader_modules[0] = shader_modules[0];
+    early_z_shader_modules[1] =
+        renderer::helper::loadShaderModule(
+            device,
+            is_high_precision_conemap_ ?
+                "conemap_test_early_z_hp_frag.spv" :
+                "conemap_test_early_z_frag.spv",
+            renderer::ShaderStageFlagBits::FRAGMENT_BIT);
+
+    prt_early_z_pipeline_ = device->createPipeline(
+        render_pass,
+        prt_pipeline_layout_,
+        unit_plane->getBindingDescs(),
+        unit_plane->getAttribDescs(),
+        input_assembly,
+        getEarlyDepthTestPipelineInfo(graphic_pipeline_info),
+        early_z_shader_modules,
+        display_size);
+
+    // visibility pass keeps its final layout general so the resolve pass can load it.
+    visibility_render_pass_ =
+        renderer::helper::createRenderPass(
+            device,
+            renderer::Format::R32_UINT,
+            depth_format,
+            true,
+            renderer::SampleCountFlagBits::SC_1_BIT,
+            renderer::ImageLayout::GENERAL);
+
+    visibility_frame_buffer_ =
+        device->createFrameBuffer(
+            visibility_render_pass_,
+            { visibility_tex_->view, visibility_depth_tex_->view },
+            display_size);
+
+    visibility_pipeline_layout_ =
+        createVisibilityPipelineLayout(
+            device,
+            global_desc_set_layouts);
+
+    renderer::ShaderModuleList visibility_shader_modules(2);
+    visibility_shader_modules[0] =
+        renderer::helper::loadShaderModule(
+            device,
+            "conemap_visibility_vert.spv",
+            renderer::ShaderStageFlagBits::VERTEX_BIT);
+    visibility_shader_modules[1] =
+        renderer::helper::loadShaderModule(
+            device,
+            "conemap_visibility_frag.spv",
+            renderer::ShaderStageFlagBits::FRAGMENT_BIT);
+
+    visibility_pipeline_ = device->createPipeline(
+        visibility_render_pass_,
+        visibility_pipeline_layout_,
+        unit_plane->getBindingDescs(),
+        unit_plane->getAttribDescs(),
+        input_assembly,
+        graphic_pipeline_info,
+        visibility_shader_modules,
+        display_size);
+
+    renderer::ShaderModuleList resolve_shader_modules(2);
+    resolve_shader_modules[0] =
+        renderer::helper::loadShaderModule(
+            device,
+            "full_screen_vert.spv",
+            renderer::ShaderStageFlagBits::VERTEX_BIT);
+    resolve_shader_modules[1] =
+        renderer::helper::loadShaderModule(
+            device,
+            is_high_precision_conemap_ ?
+                "conemap_test_vis_hp_frag.spv" :
+                "conemap_test_vis_frag.spv",
+            renderer::ShaderStageFlagBits::FRAGMENT_BIT);
+
+    visibility_resolve_pipeline_ = device->createPipeline(
+        render_pass,
+        prt_pipeline_layout_,
+        {},
+        {},
+        input_assembly,
+        graphic_fs_pipeline_info,
+        resolve_shader_modules,
+        display_size);
 }
 
-void ConemapTest::draw(
-    const std::shared_ptr<renderer::Device>& device,
+void ConemapTest::updateTemporalHistory(
+    std::shared_ptr<renderer::CommandBuffer> cmd_buf) {
+    if (!use_temporal_reprojection_) {
+        return;
+    }
+
+    const auto& camera_buffer =
+        GameCamera::getGameCameraBuffer()->buffer;
+
+    cmd_buf->addBufferBarrier(
+        camera_buffer,
+        { SET_FLAG_BIT(Access, SHADER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT) },
+        { SET_FLAG_BIT(Access, TRANSFER_READ_BIT), SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) },
+        camera_buffer->getSize());
+
+    cmd_buf->addBufferBarrier(
+        prev_camera_buffer_->buffer,
+        { SET_FLAG_BIT(Access, SHADER_READ_BIT), SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT) },
+        { SET_FLAG_BIT(Access, TRANSFER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) },
+        prev_camera_buffer_->buffer->getSize());
+
+    renderer::BufferCopyInfo copy_region{};
+    copy_region.size = prev_camera_buffer_->buffer->getSize();
+    cmd_buf->copyBuffer(camera_buffer, prev_camera_buffer_->buffer, { &copy_region, 1 });
+
+    // camera update compute shader writes after this copy.
+    cmd_buf->addBufferBarrier(
+        camera_buffer,
+        { SET_FLAG_BIT(Access, TRANSFER_READ_BIT), SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) },
+        { SET_FLAG_BIT(Access, SHADER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT) },
+        camera_buffer->getSize());
+
+    cmd_buf->addBufferBarrier(
+        prev_camera_buffer_->buffer,
+        { SET_FLAG_BIT(Access, TRANSFER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) },
+        { SET_FLAG_BIT(Access, SHADER_READ_BIT), SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT) },
+        prev_camera_buffer_->buffer->getSize());
+
+    // last frame's history writes have to be visible before reading them.
+    renderer::BarrierList barrier_list;
+    renderer::helper::addTexturesToBarrierList(
+        barrier_list,
+        { hit_history_texes_[0]->image,
+          hit_history_texes_[1]->image },
+        renderer::ImageLayout::GENERAL,
+        SET_FLAG_BIT(Access, SHADER_READ_BIT) |
+        SET_FLAG_BIT(Access, SHADER_WRITE_BIT),
+        SET_FLAG_BIT(Access, SHADER_READ_BIT) |
+        SET_FLAG_BIT(Access, SHADER_WRITE_BIT));
+
+    cmd_buf->addBarriers(
+        barrier_list,
+        SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT),
+        SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT));
+}
+
+void ConemapTest::updateParallax(
     std::shared_ptr<renderer::CommandBuffer> cmd_buf,
-    const renderer::DescriptorSetList& desc_set_list,
-    std::shared_ptr<Plane> unit_plane,
     const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    if (parallax_downscale_ <= 1) {
+        return;
+    }
 
     const auto buffer_size =
         glm::uvec2(conemap_obj->getPackTexture()->size);
+    const auto parallax_size =
+        (display_size_ + glm::uvec2(parallax_downscale_ - 1)) / parallax_downscale_;
 
-    cmd_buf->bindPipeline(renderer::PipelineBindPoint::GRAPHICS, prt_pipeline_);
+    const auto& camera_buffer =
+        GameCamera::getGameCameraBuffer()->buffer;
 
-    renderer::DescriptorSetList desc_sets = desc_set_list;
-    desc_sets.push_back(prt_desc_set_);
+    // camera update pass only guarantees write to write ordering.
+    cmd_buf->addBufferBarrier(
+        camera_buffer,
+        { SET_FLAG_BIT(Access, SHADER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT) },
+        { SET_FLAG_BIT(Access, SHADER_READ_BIT), SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT) },
+        camera_buffer->getSize());
+
+    renderer::BarrierList barrier_list;
+    renderer::helper::addTexturesToBarrierList(
+        barrier_list,
+        { parallax_tex_->image },
+        renderer::ImageLayout::GENERAL,
+        SET_FLAG_BIT(Access, SHADER_READ_BIT),
+        SET_FLAG_BIT(Access, SHADER_WRITE_BIT));
+
+    cmd_buf->addBarriers(
+        barrier_list,
+        SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT),
+        SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT));
+
+    cmd_buf->bindPipeline(
+        renderer::PipelineBindPoint::COMPUTE,
+        parallax_pipeline_);
+
+    cmd_buf->bindDescriptorSets(
+        renderer::PipelineBindPoint::COMPUTE,
+        parallax_pipeline_layout_,
+        { parallax_desc_set_ });
+
+    glsl::ConemapParallaxParams params{};
+    params.model_mat = getUnitPlaneModelMatrix(buffer_size);
+    params.size = parallax_size;
+    params.inv_size = glm::vec2(1.0f / parallax_size.x, 1.0f / parallax_size.y);
+    params.height_scale = conemap_obj->getDepthScale() * (conemap_obj->isHeightMap() ? -1.0f : 1.0f);
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+        parallax_pipeline_layout_,
+        &params,
+        sizeof(params));
+
+    cmd_buf->dispatch(
+        (parallax_size.x + kConemapParallaxDispatchX - 1) / kConemapParallaxDispatchX,
+        (parallax_size.y + kConemapParallaxDispatchY - 1) / kConemapParallaxDispatchY,
+        1);
+
+    renderer::BarrierList read_barrier_list;
+    renderer::helper::addTexturesToBarrierList(
+        read_barrier_list,
+        { parallax_tex_->image },
+        renderer::ImageLayout::GENERAL,
+        SET_FLAG_BIT(Access, SHADER_WRITE_BIT),
+        SET_FLAG_BIT(Access, SHADER_READ_BIT));
+
+    cmd_buf->addBarriers(
+        read_barrier_list,
+        SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT),
+        SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT));
+}
+
+void ConemapTest::drawVisibility(
+    std::shared_ptr<renderer::CommandBuffer> cmd_buf,
+    const renderer::DescriptorSetList& desc_set_list,
+    std::shared_ptr<Plane> unit_plane,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    if (!use_visibility_buffer_ || !unit_plane) {
+        return;
+    }
+
+    std::vector<renderer::ClearValue> clear_values(2);
+    clear_values[0].color = { 0.0f, 0.0f, 0.0f, 0.0f };
+    clear_values[1].depth_stencil = { 1.0f, 0 };
+
+    cmd_buf->beginRenderPass(
+        visibility_render_pass_,
+        visibility_frame_buffer_,
+        display_size_,
+        clear_values);
+
+    cmd_buf->bindPipeline(renderer::PipelineBindPoint::GRAPHICS, visibility_pipeline_);
 
     cmd_buf->bindDescriptorSets(
         renderer::PipelineBindPoint::GRAPHICS,
-        prt_pipeline_layout_,
-        desc_sets);
+        visibility_pipeline_layout_,
+        desc_set_list);
 
-    glsl::PrtLightParams params{};
+    glsl::ConemapVisibilityParams params{};
     params.model_mat =
-        glm::mat4(
-            glm::vec4(float(buffer_size.x) / float(buffer_size.y) * 1.0f, 0, 0, 0),
-            glm::vec4(0, 1, 0, 0),
-            glm::vec4(0, 0, 1, 0),
-            glm::vec4(0, 0, 0, 1));
+        getUnitPlaneModelMatrix(
+            glm::uvec2(conemap_obj->getPackTexture()->size));
+    params.object_id = 0;
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
+        SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+        visibility_pipeline_layout_,
+        &params,
+        sizeof(params));
+
+    unit_plane->draw(cmd_buf);
+
+    cmd_buf->endRenderPass();
+
+    renderer::BarrierList barrier_list;
+    renderer::helper::addTexturesToBarrierList(
+        barrier_list,
+        { visibility_tex_->image },
+        renderer::ImageLayout::GENERAL,
+        SET_FLAG_BIT(Access, COLOR_ATTACHMENT_WRITE_BIT),
+        SET_FLAG_BIT(Access, SHADER_READ_BIT));
+
+    cmd_buf->addBarriers(
+        barrier_list,
+        SET_FLAG_BIT(PipelineStage, COLOR_ATTACHMENT_OUTPUT_BIT),
+        SET_FLAG_BIT(PipelineStage, FRAGMENT_SHADER_BIT));
+}
+
+void ConemapTest::prepareDraw(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+
+    const auto buffer_size =
+        glm::uvec2(conemap_obj->getPackTexture()->size);
+
+    auto& params = draw_params_;
+    params = {};
+    params.model_mat = getUnitPlaneModelMatrix(buffer_size);
 
-    float y_value[25];
     static float s_theta = glm::pi<float>() / 3.0f;
     static float s_phi = glm::pi<float>() / 4.0f;
-    glm::vec2 ray_2d = glm::normalize(glm::vec2(std::sinf(s_theta), std::cos(s_theta) / conemap_obj->getDepthScale()));
-    
-    fillYVauleTablle(y_value, std::acosf(ray_2d.y), s_phi);
 
+    // points from the surface to the light.
     glm::vec3 light_ray =
         glm::vec3(std::sin(s_theta) * std::cos(s_phi),
             std::cos(s_theta),
             std::sin(s_theta) * std::sin(s_phi));
 
-#if 0
-    for (int i = 0; i < 25; i++) {
-        params.coeffs[i] = y_value[i];
-    }
-#endif
-
     //s_theta += 0.001f;
     s_phi += 0.003f;
 
     params.height_scale = conemap_obj->getDepthScale() * (conemap_obj->isHeightMap() ? -1.0f : 1.0f);
+    params.use_prt_lighting = use_prt_lighting_ ? 1 : 0;
     params.buffer_size = glm::vec2(buffer_size);
     params.test_color = light_ray * 0.5f + 0.5f;
-
-    cmd_buf->pushConstants(
-        SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
-        SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
-        prt_pipeline_layout_,
-        &params,
-        sizeof(params));
+    params.collect_step_stats = collect_step_stats_ ? 1 : 0;
+    params.temporal_mode =
+        !use_temporal_reprojection_ ? kConemapTemporalOff :
+        history_valid_ ? kConemapTemporalReadWrite : kConemapTemporalWriteOnly;
+    params.history_read_index = history_read_index_;
+    params.history_guard_band = 0.02f;
+    params.parallax_downscale = parallax_downscale_;
+    params.parallax_size =
+        (display_size_ + glm::uvec2(parallax_downscale_ - 1)) / parallax_downscale_;
 
     {
         glsl::PbrMaterialParams ubo{};
@@ -483,21 +1006,144 @@ void ConemapTest::draw(
         for (int l = 0; l < LIGHT_COUNT; l++) {
             ubo.lights[l].type = glsl::LightType_Directional;
             ubo.lights[l].color = glm::vec3(1, 0, 0);
-            ubo.lights[l].direction = light_ray;
+            ubo.lights[l].direction = -light_ray;
             ubo.lights[l].intensity = 100.0f;
             ubo.lights[l].position = glm::vec3(0, 0, 0);
         }
 
-        device->updateBufferMemory(
-            uniform_buffer_->memory,
-            sizeof(ubo),
-            &ubo);
+        // previous frame's block is left alone, the gpu may still be reading it.
+        ubo_offset_ = uniform_ring_->allocate(&ubo, sizeof(ubo));
+
+        // lights move every frame, so project them again into the tangent frame.
+        if (use_prt_lighting_) {
+            glsl::PrtLightCoeffs light_coeffs{};
+            sh_lighting_.setTangentFrame(params.model_mat, params.height_scale);
+            for (int l = 0; l < LIGHT_COUNT; l++) {
+                sh_lighting_.projectDirectionalLight(
+                    &light_coeffs.light_coeffs[l * kPrtShCoeffCount],
+                    -ubo.lights[l].direction,
+                    light_angular_radius_);
+            }
+            sh_lighting_.projectEnvironment(light_coeffs.env_coeffs);
+
+            prt_light_offset_ = uniform_ring_->allocate(&light_coeffs, sizeof(light_coeffs));
+        }
+    }
+
+    if (use_temporal_reprojection_) {
+        history_read_index_ = 1 - history_read_index_;
+        history_valid_ = true;
+    }
+}
+
+void ConemapTest::recordDraw(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const renderer::DescriptorSetList& desc_set_list,
+    const std::shared_ptr<Plane>& unit_plane,
+    uint32_t first_instance,
+    uint32_t num_instances) const {
+
+    cmd_buf->bindPipeline(
+        renderer::PipelineBindPoint::GRAPHICS,
+        use_visibility_buffer_ ? visibility_resolve_pipeline_ : prt_pipeline_);
+
+    renderer::DescriptorSetList desc_sets = desc_set_list;
+    desc_sets.push_back(prt_desc_set_);
+
+    const uint32_t dynamic_offsets[] = { ubo_offset_, prt_light_offset_ };
+    cmd_buf->bindDescriptorSets(
+        renderer::PipelineBindPoint::GRAPHICS,
+        prt_pipeline_layout_,
+        desc_sets,
+        0,
+        dynamic_offsets);
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
+        SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+        prt_pipeline_layout_,
+        &draw_params_,
+        sizeof(draw_params_));
+
+    if (use_visibility_buffer_) {
+        // full screen triangle, every covered pixel shades exactly once.
+        cmd_buf->draw(3);
     }
+    else if (unit_plane) {
+        // instance 0 is the plane itself, everything past it only exists in the stress scene.
+        auto draw_instances = [&]() {
+            for (uint32_t i = first_instance; i < first_instance + num_instances; i++) {
+                if (i > 0) {
+                    auto instance_params = draw_params_;
+                    instance_params.model_mat =
+                        getStressInstanceModelMatrix(draw_params_.model_mat, i);
+                    cmd_buf->pushConstants(
+                        SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
+                        SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+                        prt_pipeline_layout_,
+                        &instance_params,
+                        sizeof(instance_params));
+                }
+                unit_plane->draw(cmd_buf);
+            }
+        };
+
+        if (use_depth_prepass_) {
+            // same layout, only the pipelines get switched.
+            cmd_buf->bindPipeline(renderer::PipelineBindPoint::GRAPHICS, depth_prepass_pipeline_);
+            draw_instances();
+            cmd_buf->bindPipeline(renderer::PipelineBindPoint::GRAPHICS, prt_early_z_pipeline_);
+            // the prepass left the last instance's transform behind.
+            if (first_instance == 0 && num_instances > 1) {
+                cmd_buf->pushConstants(
+                    SET_FLAG_BIT(ShaderStage, VERTEX_BIT) |
+                    SET_FLAG_BIT(ShaderStage, FRAGMENT_BIT),
+                    prt_pipeline_layout_,
+                    &draw_params_,
+                    sizeof(draw_params_));
+            }
+        }
+        draw_instances();
+    }
+}
+
+void ConemapTest::draw(
+    const std::shared_ptr<renderer::Device>& device,
+    std::shared_ptr<renderer::CommandBuffer> cmd_buf,
+    const renderer::DescriptorSetList& desc_set_list,
+    std::shared_ptr<Plane> unit_plane,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    prepareDraw(device, conemap_obj);
+    recordDraw(cmd_buf, desc_set_list, unit_plane);
+}
 
+void ConemapTest::reportStepStats(
+    const std::shared_ptr<renderer::Device>& device) {
+    glsl::ConemapStepStats step_stats{};
+    device->dumpBufferMemory(
+        step_stats_buffer_->memory,
+        sizeof(step_stats),
+        &step_stats);
 
-    if (unit_plane) {
-        unit_plane->draw(cmd_buf);
+    if (step_stats.num_pixels > 0) {
+        float inv_num_pixels = 1.0f / float(step_stats.num_pixels);
+        std::cout <<
+            "conemap steps per pixel (" <<
+            (is_high_precision_conemap_ ? "rgba16f" : "rgba8") <<
+            "): cone " <<
+            float(step_stats.cone_steps) * inv_num_pixels <<
+            ", binary " <<
+            float(step_stats.binary_steps) * inv_num_pixels <<
+            ", pixels " <<
+            step_stats.num_pixels <<
+            std::endl;
     }
+
+    step_stats = {};
+    device->updateBufferMemory(
+        step_stats_buffer_->memory,
+        sizeof(step_stats),
+        &step_stats);
 }
 
 void ConemapTest::destroy(
@@ -505,7 +1151,24 @@ void ConemapTest::destroy(
     device->destroyDescriptorSetLayout(prt_desc_set_layout_);
     device->destroyPipelineLayout(prt_pipeline_layout_);
     device->destroyPipeline(prt_pipeline_);
-    uniform_buffer_->destroy(device);
+    step_stats_buffer_->destroy(device);
+    prev_camera_buffer_->destroy(device);
+    for (auto& tex : hit_history_texes_) {
+        tex->destroy(device);
+    }
+    device->destroyDescriptorSetLayout(parallax_desc_set_layout_);
+    device->destroyPipelineLayout(parallax_pipeline_layout_);
+    device->destroyPipeline(parallax_pipeline_);
+    parallax_tex_->destroy(device);
+    device->destroyFramebuffer(visibility_frame_buffer_);
+    device->destroyRenderPass(visibility_render_pass_);
+    device->destroyPipelineLayout(visibility_pipeline_layout_);
+    device->destroyPipeline(visibility_pipeline_);
+    device->destroyPipeline(visibility_resolve_pipeline_);
+    device->destroyPipeline(depth_prepass_pipeline_);
+    device->destroyPipeline(prt_early_z_pipeline_);
+    visibility_tex_->destroy(device);
+    visibility_depth_tex_->destroy(device);
 }
 
 } // game_object
@@ -2,6 +2,7 @@
 #include "renderer/renderer.h"
 #include "plane.h"
 #include "conemap_obj.h"
+#include "scene_rendering/sh_lighting.h"
 
 namespace engine {
 namespace game_object {
@@ -11,14 +12,63 @@ class ConemapTest {
     std::shared_ptr<renderer::DescriptorSetLayout> prt_desc_set_layout_;
     std::shared_ptr<renderer::PipelineLayout> prt_pipeline_layout_;
     std::shared_ptr<renderer::Pipeline> prt_pipeline_;
-    std::shared_ptr<renderer::BufferInfo> uniform_buffer_;
+    std::shared_ptr<renderer::UniformBufferRing> uniform_ring_;
+    // filled by prepareDraw, only read while recording.
+    glsl::PrtLightParams draw_params_{};
+    // dynamic offsets, in binding order: pbr material block, prt light coefficients. the
+    // light block keeps its last offset while prt lighting is off, the shader skips it then.
+    uint32_t ubo_offset_ = 0;
+    uint32_t prt_light_offset_ = 0;
+    std::shared_ptr<renderer::BufferInfo> step_stats_buffer_;
+    bool collect_step_stats_ = false;
+    bool is_high_precision_conemap_ = false;
+
+    // hit depth history for temporal reprojection, ping-ponged every frame.
+    std::shared_ptr<renderer::TextureInfo> hit_history_texes_[2];
+    std::shared_ptr<renderer::BufferInfo> prev_camera_buffer_;
+    bool use_temporal_reprojection_ = false;
+    bool history_valid_ = false;
+    uint32_t history_read_index_ = 0;
+
+    // reduced resolution cone stepping, hit uv and depth get upsampled in the pbr pass.
+    std::shared_ptr<renderer::DescriptorSet> parallax_desc_set_;
+    std::shared_ptr<renderer::DescriptorSetLayout> parallax_desc_set_layout_;
+    std::shared_ptr<renderer::PipelineLayout> parallax_pipeline_layout_;
+    std::shared_ptr<renderer::Pipeline> parallax_pipeline_;
+    std::shared_ptr<renderer::TextureInfo> parallax_tex_;
+    glm::uvec2 display_size_;
+    uint32_t parallax_downscale_ = 1;
+
+    // deferred path, a thin pass writes primitive ids and the pbr shading runs once per pixel.
+    std::shared_ptr<renderer::RenderPass> visibility_render_pass_;
+    std::shared_ptr<renderer::Framebuffer> visibility_frame_buffer_;
+    std::shared_ptr<renderer::PipelineLayout> visibility_pipeline_layout_;
+    std::shared_ptr<renderer::Pipeline> visibility_pipeline_;
+    std::shared_ptr<renderer::Pipeline> visibility_resolve_pipeline_;
+    std::shared_ptr<renderer::TextureInfo> visibility_tex_;
+    std::shared_ptr<renderer::TextureInfo> visibility_depth_tex_;
+    bool use_visibility_buffer_ = false;
+
+    // cheap cone march writing conservative depth, main pass then only shades the front surface.
+    std::shared_ptr<renderer::Pipeline> depth_prepass_pipeline_;
+    std::shared_ptr<renderer::Pipeline> prt_early_z_pipeline_;
+    bool use_depth_prepass_ = false;
+
+    // light and ibl sh in the prt bake's tangent frame, reprojected every frame.
+    scene_rendering::ShLighting sh_lighting_;
+    // off until a prt bake filled the pack textures, unbaked they decode to garbage visibility.
+    bool use_prt_lighting_ = false;
+    // directional lights are treated as discs of this half angle, gives soft shadow edges.
+    float light_angular_radius_ = 0.05f;
 
 public:
     ConemapTest(
         const std::shared_ptr<renderer::Device>& device,
         const std::shared_ptr<renderer::DescriptorPool>& descriptor_pool,
+        const std::shared_ptr<renderer::UniformBufferRing>& uniform_ring,
         const std::shared_ptr<renderer::RenderPass>& render_pass,
         const renderer::GraphicPipelineInfo& graphic_pipeline_info,
+        const renderer::GraphicPipelineInfo& graphic_fs_pipeline_info,
         const renderer::DescriptorSetLayoutList& global_desc_set_layouts,
         const std::shared_ptr<renderer::Sampler>& texture_sampler,
         const renderer::TextureInfo& prt_base_tex,
@@ -28,6 +78,38 @@ public:
         const glm::uvec2& display_size,
         std::shared_ptr<Plane> unit_plane);
 
+    // save last frame's camera before it gets updated, has to be called outside render pass.
+    void updateTemporalHistory(
+        std::shared_ptr<renderer::CommandBuffer> cmd_buf);
+
+    // cone stepping at 1/parallax_downscale_ resolution, has to be called outside render pass.
+    void updateParallax(
+        std::shared_ptr<renderer::CommandBuffer> cmd_buf,
+        const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+
+    // fill visibility buffer when deferred path is on, has to be called outside render pass.
+    void drawVisibility(
+        std::shared_ptr<renderer::CommandBuffer> cmd_buf,
+        const renderer::DescriptorSetList& desc_set_list,
+        std::shared_ptr<Plane> unit_plane,
+        const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+
+    // per frame state, material block and light coefficients. single threaded, has to run
+    // before any recordDraw of the frame.
+    void prepareDraw(
+        const std::shared_ptr<renderer::Device>& device,
+        const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+
+    // only reads state, several threads can record into their own command buffers at once.
+    // instances past the first are copies of the plane at their own spot on a grid, used
+    // to stress command recording. jobs each record their own range of them.
+    void recordDraw(
+        const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+        const renderer::DescriptorSetList& desc_set_list,
+        const std::shared_ptr<Plane>& unit_plane,
+        uint32_t first_instance = 0,
+        uint32_t num_instances = 1) const;
+
     void draw(
         const std::shared_ptr<renderer::Device>& device,
         std::shared_ptr<renderer::CommandBuffer> cmd_buf,
@@ -35,6 +117,51 @@ public:
         std::shared_ptr<Plane> unit_plane,
         const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
 
+    // print average cone/binary steps per pixel since last report, then reset counters.
+    void reportStepStats(const std::shared_ptr<renderer::Device>& device);
+
+    inline void setCollectStepStats(bool collect) {
+        collect_step_stats_ = collect;
+    }
+
+    inline void setTemporalReprojection(bool enable) {
+        use_temporal_reprojection_ = enable;
+        history_valid_ = false;
+    }
+
+    // 1 for full resolution inline cone stepping, 2 for half, 4 for quarter.
+    inline void setParallaxDownscale(uint32_t downscale) {
+        parallax_downscale_ =
+            downscale >= kConemapParallaxMaxDownscale ? kConemapParallaxMaxDownscale :
+            downscale >= 2 ? 2 : 1;
+    }
+
+    inline uint32_t getParallaxDownscale() const {
+        return parallax_downscale_;
+    }
+
+    inline void setVisibilityBuffer(bool enable) {
+        use_visibility_buffer_ = enable;
+    }
+
+    // only used by the forward path, visibility buffer already shades once per pixel.
+    inline void setDepthPrepass(bool enable) {
+        use_depth_prepass_ = enable;
+    }
+
+    inline void setPrtLighting(bool enable) {
+        use_prt_lighting_ = enable;
+    }
+
+    inline void setLightAngularRadius(float angular_radius) {
+        light_angular_radius_ = angular_radius;
+    }
+
+    // cpu copy of the ibl panorama, environment shadowing falls back to a uniform sky without it.
+    inline void loadEnvironmentLighting(const std::string& panorama_file_name) {
+        sh_lighting_.loadEnvironment(panorama_file_name);
+    }
+
     void destroy(const std::shared_ptr<renderer::Device>& device);
 };
 
@@ -63,7 +63,8 @@ Plane::Plane(const std::shared_ptr<renderer::Device>& device)
     setPositionBuffer(
         helper::createUnifiedMeshBuffer(
             device,
-            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
             vertices.size() * sizeof(vertices[0]),
             vertices.data()));
     uint32_t binding_idx = 0;
@@ -82,7 +83,8 @@ Plane::Plane(const std::shared_ptr<renderer::Device>& device)
     setNormalBuffer(
         helper::createUnifiedMeshBuffer(
             device,
-            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
             normals.size() * sizeof(normals[0]),
             normals.data()));
     binding_desc.binding = binding_idx;
@@ -100,7 +102,8 @@ Plane::Plane(const std::shared_ptr<renderer::Device>& device)
     setTangentBuffer(
         helper::createUnifiedMeshBuffer(
             device,
-            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
             tangents.size() * sizeof(tangents[0]),
             tangents.data()));
     binding_desc.binding = binding_idx;
@@ -118,7 +121,8 @@ Plane::Plane(const std::shared_ptr<renderer::Device>& device)
     setUvBuffer(
         helper::createUnifiedMeshBuffer(
             device,
-            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, VERTEX_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
             uvs.size() * sizeof(uvs[0]),
             uvs.data()));
     binding_desc.binding = binding_idx;
@@ -139,7 +143,8 @@ Plane::Plane(const std::shared_ptr<renderer::Device>& device)
     setIndexBuffer(
         helper::createUnifiedMeshBuffer(
             device,
-            SET_FLAG_BIT(BufferUsage, INDEX_BUFFER_BIT),
+            SET_FLAG_BIT(BufferUsage, INDEX_BUFFER_BIT) |
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
             faces.size() * sizeof(faces[0]),
             faces.data()));
 }
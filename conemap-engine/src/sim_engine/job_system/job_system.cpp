@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "job_system.h"
+
+namespace {
+// per worker deque size, overflow goes to the shared queue.
+const uint32_t kWorkerDequeCapacity = 4096;
+
+thread_local int32_t t_worker_idx = -1;
+thread_local uint32_t t_random_seed = 0;
+
+uint32_t nextRandom() {
+    // xorshift, only picks steal victims.
+    if (t_random_seed == 0) {
+        t_random_seed =
+            static_cast<uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+    }
+    t_random_seed ^= t_random_seed << 13;
+    t_random_seed ^= t_random_seed >> 17;
+    t_random_seed ^= t_random_seed << 5;
+    return t_random_seed;
+}
+} // namespace
+
+namespace engine {
+namespace job_system {
+
+struct Job {
+    JobFunc func;
+    JobCounter* counter = nullptr;
+    bool main_thread = false;
+};
+
+JobSystem::JobSystem(uint32_t num_workers/* = 0*/) {
+    if (num_workers == 0) {
+        num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    workers_.resize(num_workers);
+    for (uint32_t i = 0; i < num_workers; i++) {
+        workers_[i] = std::make_unique<Worker>();
+        workers_[i]->deque = std::make_unique<WorkStealingDeque<Job*>>(kWorkerDequeCapacity);
+    }
+
+    t_worker_idx = 0;
+    for (uint32_t i = 1; i < num_workers; i++) {
+        workers_[i]->thread = std::thread(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        quit_.store(true);
+    }
+    wake_cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    // nothing waits on whatever is left any more.
+    Job* job;
+    while (findJob(0, job)) {
+        delete job;
+    }
+    for (auto job : main_thread_jobs_) {
+        delete job;
+    }
+    t_worker_idx = -1;
+}
+
+int32_t JobSystem::getCurrentWorkerIndex() {
+    return t_worker_idx;
+}
+
+void JobSystem::workerLoop(uint32_t worker_idx) {
+    t_worker_idx = static_cast<int32_t>(worker_idx);
+    while (!quit_.load(std::memory_order_relaxed)) {
+        Job* job;
+        if (findJob(worker_idx, job)) {
+            execute(job);
+            continue;
+        }
+
+        // schedule bumps the queued count before it checks for sleepers, and we register
+        // as sleeper before checking the count, so one of the two always sees the other.
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        num_sleeping_workers_.fetch_add(1);
+        wake_cv_.wait(lock, [this] {
+            return num_queued_jobs_.load() > 0 || quit_.load(); });
+        num_sleeping_workers_.fetch_sub(1);
+    }
+}
+
+void JobSystem::schedule(Job* job) {
+    if (job->main_thread) {
+        std::lock_guard<std::mutex> lock(main_thread_mutex_);
+        main_thread_jobs_.push_back(job);
+        return;
+    }
+
+    int32_t worker_idx = t_worker_idx;
+    if (worker_idx < 0 || !workers_[worker_idx]->deque->push(job)) {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        inject_jobs_.push_back(job);
+        num_inject_jobs_.fetch_add(1);
+    }
+
+    num_queued_jobs_.fetch_add(1);
+    if (num_sleeping_workers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        wake_cv_.notify_one();
+    }
+}
+
+void JobSystem::scheduleAfter(Job* job, JobCounter* depends_on) {
+    if (depends_on) {
+        std::lock_guard<std::mutex> lock(depends_on->waiters_mutex_);
+        if (!depends_on->isDone()) {
+            depends_on->waiters_.push_back(job);
+            return;
+        }
+    }
+    schedule(job);
+}
+
+bool JobSystem::findJob(int32_t worker_idx, Job*& job) {
+    if (worker_idx >= 0 && workers_[worker_idx]->deque->pop(job)) {
+        num_queued_jobs_.fetch_sub(1);
+        return true;
+    }
+
+    if (num_inject_jobs_.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        if (!inject_jobs_.empty()) {
+            job = inject_jobs_.front();
+            inject_jobs_.pop_front();
+            num_inject_jobs_.fetch_sub(1);
+            num_queued_jobs_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    // one round over all the other workers, starting at a random one.
+    auto num_workers = static_cast<uint32_t>(workers_.size());
+    uint32_t start = nextRandom() % num_workers;
+    for (uint32_t i = 0; i < num_workers; i++) {
+        uint32_t victim = (start + i) % num_workers;
+        if (int32_t(victim) != worker_idx && workers_[victim]->deque->steal(job)) {
+            num_queued_jobs_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void JobSystem::execute(Job* job) {
+    job->func();
+
+    auto counter = job->counter;
+    delete job;
+    if (!counter) {
+        return;
+    }
+
+    // waiters are taken under the lock the count drops in, so a wait that returned
+    // afterwards can't race us on the counter.
+    std::vector<Job*> released_jobs;
+    {
+        std::lock_guard<std::mutex> lock(counter->waiters_mutex_);
+        if (counter->count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            released_jobs.swap(counter->waiters_);
+        }
+    }
+    for (auto released_job : released_jobs) {
+        schedule(released_job);
+    }
+}
+
+void JobSystem::run(
+    JobFunc func,
+    JobCounter* counter/* = nullptr*/,
+    JobCounter* depends_on/* = nullptr*/) {
+    auto job = new Job;
+    job->func = std::move(func);
+    job->counter = counter;
+    if (counter) {
+        counter->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    scheduleAfter(job, depends_on);
+}
+
+void JobSystem::runOnMainThread(
+    JobFunc func,
+    JobCounter* depends_on/* = nullptr*/) {
+    auto job = new Job;
+    job->func = std::move(func);
+    job->main_thread = true;
+    scheduleAfter(job, depends_on);
+}
+
+void JobSystem::pumpMainThread() {
+    std::vector<Job*> jobs;
+    {
+        std::lock_guard<std::mutex> lock(main_thread_mutex_);
+        jobs.swap(main_thread_jobs_);
+    }
+    for (auto job : jobs) {
+        execute(job);
+    }
+}
+
+void JobSystem::wait(JobCounter* counter) {
+    int32_t worker_idx = t_worker_idx;
+    while (!counter->isDone()) {
+        Job* job;
+        if (findJob(worker_idx, job)) {
+            execute(job);
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+
+    // the job that dropped the count may still be inside the lock.
+    std::lock_guard<std::mutex> lock(counter->waiters_mutex_);
+}
+
+void JobSystem::parallelFor(
+    uint32_t begin,
+    uint32_t end,
+    uint32_t grain_size,
+    const RangeFunc& func) {
+    if (begin >= end) {
+        return;
+    }
+
+    grain_size = std::max(grain_size, 1u);
+    if (end - begin <= grain_size) {
+        func(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    for (uint32_t range_begin = begin; range_begin < end; range_begin += grain_size) {
+        uint32_t range_end = std::min(range_begin + grain_size, end);
+        run([&func, range_begin, range_end]() {
+            func(range_begin, range_end);
+        }, &counter);
+    }
+    wait(&counter);
+}
+
+void JobSystem::runBenchmark() {
+    typedef std::chrono::high_resolution_clock Clock;
+
+    // throughput of empty jobs, mostly queue and allocation overhead.
+    {
+        const uint32_t kNumJobs = 200000;
+        JobCounter counter;
+        auto start_point = Clock::now();
+        for (uint32_t i = 0; i < kNumJobs; i++) {
+            run([]() {}, &counter);
+        }
+        wait(&counter);
+        double seconds =
+            std::chrono::duration<double>(Clock::now() - start_point).count();
+        std::cout << "job system throughput: " <<
+            kNumJobs / std::max(seconds, 1e-9) << " empty jobs per second on " <<
+            getNumWorkers() << " workers" << std::endl;
+    }
+
+    // parallel for over a cpu bound loop, against the same ranges run one after another on
+    // this thread. both results get compared, so neither loop can be optimized away.
+    {
+        const uint32_t kNumItems = 1 << 22;
+        const uint32_t kGrainSize = 16384;
+        std::vector<float> serial_values(kNumItems);
+        std::vector<float> parallel_values(kNumItems);
+        auto work = [](float* dst, uint32_t range_begin, uint32_t range_end) {
+            for (uint32_t i = range_begin; i < range_end; i++) {
+                float x = float(i);
+                for (int k = 0; k < 16; k++) {
+                    x = x * 0.999f + 1.0f / (x + 1.0f);
+                }
+                dst[i] = x;
+            }
+        };
+
+        // both sides call through a RangeFunc, so they get the same code.
+        float* serial_dst = serial_values.data();
+        RangeFunc serial_func = [&work, serial_dst](uint32_t range_begin, uint32_t range_end) {
+            work(serial_dst, range_begin, range_end);
+        };
+        auto serial_start_point = Clock::now();
+        for (uint32_t range_begin = 0; range_begin < kNumItems; range_begin += kGrainSize) {
+            serial_func(range_begin, std::min(range_begin + kGrainSize, kNumItems));
+        }
+        double serial_seconds =
+            std::chrono::duration<double>(Clock::now() - serial_start_point).count();
+
+        float* dst = parallel_values.data();
+        auto parallel_start_point = Clock::now();
+        RangeFunc parallel_func = [&work, dst](uint32_t range_begin, uint32_t range_end) {
+            work(dst, range_begin, range_end);
+        };
+        parallelFor(0, kNumItems, kGrainSize, parallel_func);
+        double parallel_seconds =
+            std::chrono::duration<double>(Clock::now() - parallel_start_point).count();
+
+        bool is_matching = serial_values == parallel_values;
+        std::cout << "job system parallel for: " <<
+            serial_seconds * 1000.0 << "ms serial, " <<
+            parallel_seconds * 1000.0 << "ms parallel, " <<
+            serial_seconds / std::max(parallel_seconds, 1e-9) << "x" <<
+            (is_matching ? "" : ", results differ!") << std::endl;
+    }
+
+    // time from run until another worker picked the job up and started it. the calling
+    // thread doesn't help here, and pauses between samples so the workers fall asleep.
+    {
+        const uint32_t kNumSamples = 1000;
+        double sum_latency = 0.0;
+        double max_latency = 0.0;
+        for (uint32_t i = 0; i < kNumSamples; i++) {
+            JobCounter counter;
+            Clock::time_point start_point;
+            auto submit_point = Clock::now();
+            run([&start_point]() {
+                start_point = Clock::now();
+            }, &counter);
+            // without other workers the job only runs in the wait below.
+            while (getNumWorkers() > 1 && !counter.isDone()) {
+                std::this_thread::yield();
+            }
+            wait(&counter);
+            double latency =
+                std::chrono::duration<double, std::micro>(start_point - submit_point).count();
+            sum_latency += latency;
+            max_latency = std::max(max_latency, latency);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        std::cout << "job system latency: " <<
+            sum_latency / kNumSamples << "us average, " <<
+            max_latency << "us max" << std::endl;
+    }
+}
+
+} // namespace job_system
+} // namespace engine
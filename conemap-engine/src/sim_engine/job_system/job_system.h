@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "work_stealing_deque.h"
+
+namespace engine {
+namespace job_system {
+
+struct Job;
+typedef std::function<void()> JobFunc;
+typedef std::function<void(uint32_t begin, uint32_t end)> RangeFunc;
+
+// number of jobs still outstanding. jobs signal it when they finish, dependent jobs get
+// released and waits return once it's back at zero. only destroy it after a wait on it
+// returned, a finishing job may still hold its lock before that.
+class JobCounter {
+    friend class JobSystem;
+    std::atomic<int32_t> count_{ 0 };
+    std::mutex waiters_mutex_;
+    std::vector<Job*> waiters_;
+
+public:
+    bool isDone() const {
+        return count_.load(std::memory_order_acquire) == 0;
+    }
+};
+
+// one worker per hardware thread, the thread that creates the system is worker 0 and only
+// runs jobs while it waits. every worker owns a work stealing deque, idle workers steal
+// from the others and sleep once there's nothing queued anywhere.
+class JobSystem {
+    struct Worker {
+        std::unique_ptr<WorkStealingDeque<Job*>> deque;
+        std::thread thread;
+    };
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // jobs from threads outside the system, or from a worker whose deque is full.
+    std::mutex inject_mutex_;
+    std::deque<Job*> inject_jobs_;
+    std::atomic<int32_t> num_inject_jobs_{ 0 };
+
+    std::mutex main_thread_mutex_;
+    std::vector<Job*> main_thread_jobs_;
+
+    std::atomic<int64_t> num_queued_jobs_{ 0 };
+    std::atomic<int32_t> num_sleeping_workers_{ 0 };
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> quit_{ false };
+
+    void workerLoop(uint32_t worker_idx);
+    void schedule(Job* job);
+    void scheduleAfter(Job* job, JobCounter* depends_on);
+    bool findJob(int32_t worker_idx, Job*& job);
+    void execute(Job* job);
+
+public:
+    // num_workers counts the creating thread, 0 takes one per hardware thread.
+    explicit JobSystem(uint32_t num_workers = 0);
+    ~JobSystem();
+
+    uint32_t getNumWorkers() const {
+        return static_cast<uint32_t>(workers_.size());
+    }
+
+    // 0 on the creating thread, -1 on threads outside the system.
+    static int32_t getCurrentWorkerIndex();
+
+    // counter goes up by one right away and back down once func returned. with depends_on
+    // the job only gets queued once that counter reached zero.
+    void run(
+        JobFunc func,
+        JobCounter* counter = nullptr,
+        JobCounter* depends_on = nullptr);
+
+    // continuation for work that has to happen on the creating thread, like device calls.
+    // it runs from the next pumpMainThread after depends_on reached zero.
+    void runOnMainThread(
+        JobFunc func,
+        JobCounter* depends_on = nullptr);
+    void pumpMainThread();
+
+    // runs queued jobs on the calling thread until counter is back at zero.
+    void wait(JobCounter* counter);
+
+    // splits [begin, end) into ranges of at most grain_size items and returns once all of
+    // them ran. the calling thread works on the ranges too.
+    void parallelFor(
+        uint32_t begin,
+        uint32_t end,
+        uint32_t grain_size,
+        const RangeFunc& func);
+
+    // prints empty job throughput, parallel for scaling and submit to start latency.
+    void runBenchmark();
+};
+
+} // namespace job_system
+} // namespace engine
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace engine {
+namespace job_system {
+
+// bounded chase-lev deque. the owning worker pushes and pops at the bottom, any other
+// worker steals from the top, none of them takes a lock. memory orders follow le et al.,
+// "correct and efficient work-stealing for weak memory models".
+template<typename T>
+class WorkStealingDeque {
+    std::unique_ptr<std::atomic<T>[]> buffer_;
+    int64_t mask_ = 0;
+    // top and bottom on their own cache lines, thieves only hammer top.
+    alignas(64) std::atomic<int64_t> top_{ 0 };
+    alignas(64) std::atomic<int64_t> bottom_{ 0 };
+
+public:
+    // capacity has to be a power of two.
+    explicit WorkStealingDeque(uint32_t capacity) :
+        buffer_(new std::atomic<T>[capacity]),
+        mask_(int64_t(capacity) - 1) {}
+
+    // owner only. false when full, the caller runs the item itself then.
+    bool push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > mask_) {
+            return false;
+        }
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // owner only, newest item first.
+    bool pop(T& item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // last item, race the thieves for it.
+            bool won = top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // any thread, oldest item first.
+    bool steal(T& item) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+
+        item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        return top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+};
+
+} // namespace job_system
+} // namespace engine
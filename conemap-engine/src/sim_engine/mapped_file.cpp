@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <stdexcept>
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace engine {
+namespace helper {
+
+MappedFile::MappedFile(
+    const std::string& file_name,
+    bool sequential/* = true*/) {
+    std::string error_message = std::string("failed to open file! :") + file_name;
+#ifdef _WIN32
+    auto file_handle =
+        CreateFileA(
+            file_name.c_str(),
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL |
+            (sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS),
+            nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error(error_message);
+    }
+    file_handle_ = file_handle;
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        CloseHandle(file_handle);
+        throw std::runtime_error(error_message);
+    }
+    size_ = static_cast<uint64_t>(file_size.QuadPart);
+
+    // empty files can't be mapped, they just stay without data.
+    if (size_ > 0) {
+        auto mapping_handle =
+            CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        auto view = mapping_handle ?
+            MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            if (mapping_handle) {
+                CloseHandle(mapping_handle);
+            }
+            CloseHandle(file_handle);
+            throw std::runtime_error(error_message);
+        }
+        mapping_handle_ = mapping_handle;
+        data_ = static_cast<const uint8_t*>(view);
+    }
+#else
+    file_descriptor_ = open(file_name.c_str(), O_RDONLY);
+    if (file_descriptor_ < 0) {
+        throw std::runtime_error(error_message);
+    }
+
+    struct stat file_stat;
+    if (fstat(file_descriptor_, &file_stat) != 0) {
+        close(file_descriptor_);
+        throw std::runtime_error(error_message);
+    }
+    size_ = static_cast<uint64_t>(file_stat.st_size);
+
+    if (size_ > 0) {
+        auto view = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_descriptor_, 0);
+        if (view == MAP_FAILED) {
+            close(file_descriptor_);
+            throw std::runtime_error(error_message);
+        }
+        madvise(view, size_, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        data_ = static_cast<const uint8_t*>(view);
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+    if (data_) {
+        UnmapViewOfFile(data_);
+        CloseHandle(mapping_handle_);
+    }
+    CloseHandle(file_handle_);
+#else
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+    close(file_descriptor_);
+#endif
+}
+
+void MappedFile::prefetch(uint64_t offset, uint64_t size) const {
+    if (!data_ || offset >= size_) {
+        return;
+    }
+    size = std::min(size, size_ - offset);
+
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>(data_ + offset);
+    range.NumberOfBytes = static_cast<SIZE_T>(size);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page aligned start.
+    auto page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    auto aligned_offset = offset / page_size * page_size;
+    madvise(
+        const_cast<uint8_t*>(data_ + aligned_offset),
+        size + (offset - aligned_offset),
+        MADV_WILLNEED);
+#endif
+}
+
+} // namespace helper
+} // namespace engine
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace engine {
+namespace helper {
+
+// read only mapping of a whole file. loaders parse it in place and copy straight out of it,
+// pages come in from the os page cache on first touch instead of getting read into a heap
+// buffer up front.
+class MappedFile {
+    const uint8_t* data_ = nullptr;
+    uint64_t size_ = 0;
+#ifdef _WIN32
+    void* file_handle_ = nullptr;
+    void* mapping_handle_ = nullptr;
+#else
+    int file_descriptor_ = -1;
+#endif
+
+public:
+    // sequential tells the os to read ahead, the right hint for files that get consumed
+    // front to back once.
+    explicit MappedFile(
+        const std::string& file_name,
+        bool sequential = true);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const { return data_; }
+    uint64_t size() const { return size_; }
+
+    // starts reading [offset, offset + size) in the background, so a later copy out of it
+    // doesn't stall on the disk.
+    void prefetch(uint64_t offset, uint64_t size) const;
+};
+
+} // namespace helper
+} // namespace engine
@@ -1,60 +1,111 @@
 #pragma once
+#include <initializer_list>
+#include <span>
 #include "renderer_structs.h"
+#include "resource_handle.h"
 
 namespace engine {
 namespace renderer {
 
+// recording takes spans and references, so a command doesn't copy handles or build
+// containers on the heap. braced lists of descriptor sets go through the
+// initializer_list overload, which lives on the caller's stack. the hot binds also come
+// in a handle flavour, those resolve straight to the api object through the device pools.
 class CommandBuffer {
 public:
     virtual void beginCommandBuffer(CommandBufferUsageFlags flags) = 0;
+    // secondary command buffers that run inside a render pass continue its state.
+    virtual void beginCommandBuffer(
+        CommandBufferUsageFlags flags,
+        const CommandBufferInheritanceInfo& inheritance) = 0;
     virtual void endCommandBuffer() = 0;
     virtual void copyBuffer(
-        std::shared_ptr<Buffer> src_buf,
-        std::shared_ptr<Buffer> dst_buf,
-        std::vector<BufferCopyInfo> copy_regions) = 0;
+        const std::shared_ptr<Buffer>& src_buf,
+        const std::shared_ptr<Buffer>& dst_buf,
+        std::span<const BufferCopyInfo> copy_regions) = 0;
     virtual void copyImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageCopyInfo> copy_regions) = 0;
+        std::span<const ImageCopyInfo> copy_regions) = 0;
     virtual void blitImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageBlitInfo> copy_regions,
+        std::span<const ImageBlitInfo> copy_regions,
         const Filter& filter) = 0;
     virtual void resolveImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageResolveInfo> copy_regions) = 0;
+        std::span<const ImageResolveInfo> copy_regions) = 0;
     virtual void copyBufferToImage(
-        std::shared_ptr<Buffer> src_buf,
-        std::shared_ptr<Image> dst_image,
-        std::vector<BufferImageCopyInfo> copy_regions,
+        const std::shared_ptr<Buffer>& src_buf,
+        const std::shared_ptr<Image>& dst_image,
+        std::span<const BufferImageCopyInfo> copy_regions,
         ImageLayout layout) = 0;
     virtual void copyImageToBuffer(
-        std::shared_ptr<Image> src_image,
-        std::shared_ptr<Buffer> dst_buf,
-        std::vector<BufferImageCopyInfo> copy_regions,
+        const std::shared_ptr<Image>& src_image,
+        const std::shared_ptr<Buffer>& dst_buf,
+        std::span<const BufferImageCopyInfo> copy_regions,
         ImageLayout layout) = 0;
-    virtual void bindPipeline(PipelineBindPoint bind, std::shared_ptr<Pipeline> pipeline) = 0;
-    virtual void bindVertexBuffers(uint32_t first_bind, const std::vector<std::shared_ptr<renderer::Buffer>>& vertex_buffers, std::vector<uint64_t> offsets) = 0;
-    virtual void bindIndexBuffer(std::shared_ptr<Buffer> index_buffer, uint64_t offset, IndexType index_type) = 0;
+    virtual void bindPipeline(PipelineBindPoint bind, const std::shared_ptr<Pipeline>& pipeline) = 0;
+    virtual void bindPipeline(PipelineBindPoint bind, const PipelineHandle& pipeline) = 0;
+    virtual void bindVertexBuffers(uint32_t first_bind, std::span<const std::shared_ptr<renderer::Buffer>> vertex_buffers, std::span<const uint64_t> offsets) = 0;
+    virtual void bindIndexBuffer(const std::shared_ptr<Buffer>& index_buffer, uint64_t offset, IndexType index_type) = 0;
     virtual void bindDescriptorSets(
         PipelineBindPoint bind_point,
         const std::shared_ptr<PipelineLayout>& pipeline_layout,
-        const DescriptorSetList& desc_sets,
-        const uint32_t first_set_idx = 0) = 0;
+        std::span<const std::shared_ptr<DescriptorSet>> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::span<const uint32_t> dynamic_offsets = {}) = 0;
+    void bindDescriptorSets(
+        PipelineBindPoint bind_point,
+        const std::shared_ptr<PipelineLayout>& pipeline_layout,
+        std::initializer_list<std::shared_ptr<DescriptorSet>> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::initializer_list<uint32_t> dynamic_offsets = {}) {
+        bindDescriptorSets(
+            bind_point,
+            pipeline_layout,
+            std::span<const std::shared_ptr<DescriptorSet>>(desc_sets.begin(), desc_sets.size()),
+            first_set_idx,
+            std::span<const uint32_t>(dynamic_offsets.begin(), dynamic_offsets.size()));
+    }
+    virtual void bindDescriptorSets(
+        PipelineBindPoint bind_point,
+        const PipelineLayoutHandle& pipeline_layout,
+        std::span<const DescriptorSetHandle> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::span<const uint32_t> dynamic_offsets = {}) = 0;
+    void bindDescriptorSets(
+        PipelineBindPoint bind_point,
+        const PipelineLayoutHandle& pipeline_layout,
+        std::initializer_list<DescriptorSetHandle> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::initializer_list<uint32_t> dynamic_offsets = {}) {
+        bindDescriptorSets(
+            bind_point,
+            pipeline_layout,
+            std::span<const DescriptorSetHandle>(desc_sets.begin(), desc_sets.size()),
+            first_set_idx,
+            std::span<const uint32_t>(dynamic_offsets.begin(), dynamic_offsets.size()));
+    }
     virtual void pushConstants(
         ShaderStageFlags stages,
         const std::shared_ptr<PipelineLayout>& pipeline_layout,
         const void* data,
         uint32_t size,
         uint32_t offset = 0) = 0;
+    virtual void pushConstants(
+        ShaderStageFlags stages,
+        const PipelineLayoutHandle& pipeline_layout,
+        const void* data,
+        uint32_t size,
+        uint32_t offset = 0) = 0;
     virtual void draw(uint32_t vertex_count, 
         uint32_t instance_count = 1, 
         uint32_t first_vertex = 0, 
@@ -96,11 +147,15 @@ public:
         const StridedDeviceAddressRegion& callable_shader_entry,
         const glm::uvec3& size) = 0;
     virtual void beginRenderPass(
-        std::shared_ptr<RenderPass> render_pass,
-        std::shared_ptr<Framebuffer> frame_buffer,
+        const std::shared_ptr<RenderPass>& render_pass,
+        const std::shared_ptr<Framebuffer>& frame_buffer,
         const glm::uvec2& extent,
-        const std::vector<ClearValue>& clear_values) = 0;
+        std::span<const ClearValue> clear_values,
+        SubpassContents contents = SubpassContents::INLINE) = 0;
     virtual void endRenderPass() = 0;
+    // secondary command buffers run in the order given.
+    virtual void executeCommands(
+        std::span<const std::shared_ptr<CommandBuffer>> cmd_bufs) = 0;
     virtual void reset(uint32_t flags) = 0;
     virtual void addBarriers(
         const BarrierList& barrier_list,
@@ -124,6 +179,8 @@ public:
     virtual void buildAccelerationStructures(
         const std::vector<AccelerationStructureBuildGeometryInfo>& as_build_geo_list,
         const std::vector<AccelerationStructureBuildRangeInfo>& as_build_range_list) = 0;
+    // commands recorded since beginCommandBuffer.
+    virtual uint64_t getNumRecordedCommands() const = 0;
 };
 
 } // namespace renderer
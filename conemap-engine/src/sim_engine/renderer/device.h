@@ -1,12 +1,22 @@
 #pragma once
+#include <span>
 #include "renderer_structs.h"
+#include "resource_handle.h"
 
 namespace engine {
 namespace renderer {
 
 class Device {
 public:
-    virtual std::shared_ptr<DescriptorPool> createDescriptorPool() = 0;
+    // pools that can't free single sets are linear, they only get reset wholesale.
+    virtual std::shared_ptr<DescriptorPool> createDescriptorPool(bool free_descriptor_sets = true) = 0;
+    virtual void resetDescriptorPool(const std::shared_ptr<DescriptorPool>& descriptor_pool) = 0;
+    // bindings of a bindless layout are partially bound arrays, slots can be written while
+    // sets of it are bound. the pool is sized for exactly one such set.
+    virtual std::shared_ptr<DescriptorSetLayout> createBindlessDescriptorSetLayout(
+        const std::vector<DescriptorSetLayoutBinding>& bindings) = 0;
+    virtual std::shared_ptr<DescriptorPool> createBindlessDescriptorPool(
+        const std::vector<DescriptorSetLayoutBinding>& bindings) = 0;
     virtual std::shared_ptr<CommandBuffer> setupTransientCommandBuffer() = 0;
     virtual void submitAndWaitTransientCommandBuffer() = 0;
     virtual void createBuffer(
@@ -18,6 +28,15 @@ public:
         std::shared_ptr<DeviceMemory>& buffer_memory) = 0;
     virtual void updateDescriptorSets(
         const WriteDescriptorList& write_descriptors) = 0;
+    // template built from the same bindings the layout was declared with, a set of that
+    // layout then gets updated from one DescriptorInfo per descriptor in binding order.
+    virtual std::shared_ptr<DescriptorUpdateTemplate> createDescriptorUpdateTemplate(
+        const std::shared_ptr<DescriptorSetLayout>& descriptor_set_layout,
+        const std::vector<DescriptorSetLayoutBinding>& bindings) = 0;
+    virtual void updateDescriptorSet(
+        const std::shared_ptr<DescriptorSet>& desc_set,
+        const std::shared_ptr<DescriptorUpdateTemplate>& update_template,
+        std::span<const DescriptorInfo> descriptors) = 0;
     virtual DescriptorSetList createDescriptorSets(
         std::shared_ptr<DescriptorPool> descriptor_pool,
         std::shared_ptr<DescriptorSetLayout> descriptor_set_layout,
@@ -57,7 +76,8 @@ public:
         const SurfaceTransformFlagBits& transform,
         const PresentMode& present_mode,
         const ImageUsageFlags& usage,
-        const std::vector<uint32_t>& queue_index) = 0;
+        const std::vector<uint32_t>& queue_index,
+        const std::shared_ptr<Swapchain>& old_swapchain = nullptr) = 0;
     virtual void updateBufferMemory(
         const std::shared_ptr<DeviceMemory>& memory,
         uint64_t size,
@@ -94,7 +114,7 @@ public:
     virtual std::shared_ptr<ShaderModule>
         createShaderModule(
             uint64_t size,
-            void* data,
+            const void* data,
             ShaderStageFlagBits shader_stage) = 0;
     virtual std::shared_ptr<ImageView>
         createImageView(
@@ -119,7 +139,12 @@ public:
     virtual std::vector<std::shared_ptr<CommandBuffer>> allocateCommandBuffers(std::shared_ptr<CommandPool> cmd_pool, uint32_t num_buffers, bool is_primary = true) = 0;
     virtual void* mapMemory(std::shared_ptr<DeviceMemory> memory, uint64_t size, uint64_t offset = 0) = 0;
     virtual void unmapMemory(std::shared_ptr<DeviceMemory> memory) = 0;
+    // dynamic uniform and storage buffer offsets have to be multiples of these.
+    virtual uint64_t getMinUniformBufferOffsetAlignment() = 0;
+    virtual uint64_t getMinStorageBufferOffsetAlignment() = 0;
     virtual void destroyCommandPool(std::shared_ptr<CommandPool> cmd_pool) = 0;
+    // puts every command buffer of the pool back to the initial state.
+    virtual void resetCommandPool(std::shared_ptr<CommandPool> cmd_pool) = 0;
     virtual void destroySwapchain(std::shared_ptr<Swapchain> swapchain) = 0;
     virtual void destroyDescriptorPool(std::shared_ptr<DescriptorPool> descriptor_pool) = 0;
     virtual void destroyPipeline(std::shared_ptr<Pipeline> pipeline) = 0;
@@ -133,6 +158,7 @@ public:
     virtual void destroySemaphore(std::shared_ptr<Semaphore> semaphore) = 0;
     virtual void destroyFence(std::shared_ptr<Fence> fence) = 0;
     virtual void destroyDescriptorSetLayout(std::shared_ptr<DescriptorSetLayout> layout) = 0;
+    virtual void destroyDescriptorUpdateTemplate(std::shared_ptr<DescriptorUpdateTemplate> update_template) = 0;
     virtual void destroyShaderModule(std::shared_ptr<ShaderModule> layout) = 0;
     virtual void destroy() = 0;
     virtual void freeMemory(std::shared_ptr<DeviceMemory> memory) = 0;
@@ -141,6 +167,12 @@ public:
     virtual void waitForFences(const std::vector<std::shared_ptr<Fence>>& fences) = 0;
     virtual void waitForSemaphores(const std::vector<std::shared_ptr<Semaphore>>& semaphores, uint64_t value) = 0;
     virtual void waitIdle() = 0;
+    // destroy and free calls only retire objects under the current frame index, they're
+    // released once a later releaseRetiredObjects reports that frame done on the gpu.
+    // waitIdle and destroy release everything that's retired, so does a transient submit
+    // before the first beginFrame.
+    virtual void beginFrame(uint64_t frame_index) = 0;
+    virtual void releaseRetiredObjects(uint64_t completed_frame_index) = 0;
     virtual void getAccelerationStructureBuildSizes(
         AccelerationStructureBuildType         as_build_type,
         const AccelerationStructureBuildGeometryInfo& build_info,
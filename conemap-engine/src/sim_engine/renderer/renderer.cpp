@@ -4,6 +4,8 @@
 #include <array>
 
 #include "renderer.h"
+#include "shaders/global_definition.glsl.h"
+#include "job_system/job_system.h"
 #include "vulkan/vk_device.h"
 #include "vulkan/vk_command_buffer.h"
 #include "vulkan/vk_renderer_helper.h"
@@ -20,6 +22,166 @@ static void check_vk_result(VkResult err)
     if (err < 0)
         abort();
 }
+
+// creates a sampled 2d image and records its copy out of a new staging buffer. the staging
+// buffer has to stay alive until cmd_buf finished on the gpu.
+void recordStaged2DTextureUpload(
+    const std::shared_ptr<Device>& device,
+    const std::shared_ptr<CommandBuffer>& cmd_buf,
+    Format format,
+    const glm::uvec2& size,
+    const void* pixels,
+    std::shared_ptr<Image>& texture_image,
+    std::shared_ptr<DeviceMemory>& texture_image_memory,
+    BufferInfo& staging) {
+    VkDeviceSize image_size =
+        static_cast<VkDeviceSize>(size.x * size.y * (format == Format::R16_UNORM ? 2 : 4));
+
+    device->createBuffer(
+        image_size,
+        SET_FLAG_BIT(BufferUsage, TRANSFER_SRC_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        staging.buffer,
+        staging.memory);
+
+    device->updateBufferMemory(
+        staging.memory,
+        image_size,
+        pixels);
+
+    vk::helper::createTextureImage(
+        device,
+        glm::vec3(size, 1),
+        format,
+        ImageTiling::OPTIMAL,
+        SET_FLAG_BIT(ImageUsage, TRANSFER_DST_BIT) |
+        SET_FLAG_BIT(ImageUsage, SAMPLED_BIT),
+        SET_FLAG_BIT(MemoryProperty, DEVICE_LOCAL_BIT),
+        texture_image,
+        texture_image_memory);
+
+    vk::helper::transitionImageLayout(
+        cmd_buf,
+        texture_image,
+        format,
+        ImageLayout::UNDEFINED,
+        ImageLayout::TRANSFER_DST_OPTIMAL);
+    vk::helper::copyBufferToImage(
+        cmd_buf,
+        staging.buffer,
+        texture_image,
+        glm::uvec3(size, 1));
+    vk::helper::transitionImageLayout(
+        cmd_buf,
+        texture_image,
+        format,
+        ImageLayout::TRANSFER_DST_OPTIMAL,
+        ImageLayout::SHADER_READ_ONLY_OPTIMAL);
+}
+
+// cube image with all its mips and a cube view on them.
+void createCubemapImage(
+    const std::shared_ptr<Device>& device,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mip_count,
+    Format format,
+    bool use_as_framebuffer,
+    TextureInfo& texture) {
+    auto image_usage_flags =
+        SET_FLAG_BIT(ImageUsage, TRANSFER_DST_BIT) |
+        SET_FLAG_BIT(ImageUsage, SAMPLED_BIT) |
+        SET_FLAG_BIT(ImageUsage, STORAGE_BIT);
+
+    if (use_as_framebuffer) {
+        image_usage_flags |=
+            SET_FLAG_BIT(ImageUsage, COLOR_ATTACHMENT_BIT) |
+            SET_FLAG_BIT(ImageUsage, TRANSFER_SRC_BIT);
+    }
+
+    texture.image = device->createImage(
+        ImageType::TYPE_2D,
+        glm::uvec3(width, height, 1),
+        format,
+        image_usage_flags,
+        ImageTiling::OPTIMAL,
+        ImageLayout::UNDEFINED,
+        SET_FLAG_BIT(ImageCreate, CUBE_COMPATIBLE_BIT),
+        false,
+        1,
+        mip_count,
+        6u);
+
+    auto mem_requirements = device->getImageMemoryRequirements(texture.image);
+    texture.memory = device->allocateMemory(
+        mem_requirements.size,
+        mem_requirements.memory_type_bits,
+        vk::helper::toVkMemoryPropertyFlags(SET_FLAG_BIT(MemoryProperty, DEVICE_LOCAL_BIT)),
+        0);
+    device->bindImageMemory(texture.image, texture.memory);
+
+    texture.view = device->createImageView(
+        texture.image,
+        ImageViewType::VIEW_CUBE,
+        format,
+        SET_FLAG_BIT(ImageAspect, COLOR_BIT),
+        0,
+        mip_count,
+        0,
+        6);
+}
+
+// records the copy of all the cube faces and mips out of a new staging buffer, same
+// lifetime rule as the 2d version.
+void recordStagedCubemapUpload(
+    const std::shared_ptr<Device>& device,
+    const std::shared_ptr<CommandBuffer>& cmd_buf,
+    const std::shared_ptr<Image>& image,
+    Format format,
+    uint32_t mip_count,
+    const std::vector<BufferImageCopyInfo>& copy_regions,
+    uint64_t buffer_size,
+    const void* data,
+    BufferInfo& staging) {
+    device->createBuffer(
+        buffer_size,
+        SET_FLAG_BIT(BufferUsage, TRANSFER_SRC_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        staging.buffer,
+        staging.memory);
+
+    device->updateBufferMemory(staging.memory, buffer_size, data);
+
+    vk::helper::transitionImageLayout(
+        cmd_buf,
+        image,
+        format,
+        ImageLayout::UNDEFINED,
+        ImageLayout::TRANSFER_DST_OPTIMAL,
+        0,
+        mip_count,
+        0,
+        6);
+    vk::helper::copyBufferToImageWithMips(
+        cmd_buf,
+        staging.buffer,
+        image,
+        copy_regions);
+    vk::helper::transitionImageLayout(
+        cmd_buf,
+        image,
+        format,
+        ImageLayout::TRANSFER_DST_OPTIMAL,
+        ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+        0,
+        mip_count,
+        0,
+        6);
+}
 }
 
 namespace vk {
@@ -200,7 +362,8 @@ void Helper::createSwapChain(
         vk::helper::fromVkSurfaceTransformFlags(swap_chain_support.capabilities_.currentTransform),
         present_mode,
         usage,
-        queue_family_index);
+        queue_family_index,
+        swap_chain_info.swap_chain);
 
     swap_chain_info.images = device->getSwapchainImages(swap_chain_info.swap_chain);
 }
@@ -368,59 +531,19 @@ void Helper::create2DTextureImage(
     const void* pixels,
     std::shared_ptr<Image>& texture_image,
     std::shared_ptr<DeviceMemory>& texture_image_memory) {
-
-    VkDeviceSize image_size =
-        static_cast<VkDeviceSize>(tex_width * tex_height * (format == Format::R16_UNORM ? 2 : 4));
-
-    std::shared_ptr<Buffer> staging_buffer;
-    std::shared_ptr<DeviceMemory> staging_buffer_memory;
-    device->createBuffer(
-        image_size,
-        SET_FLAG_BIT(BufferUsage, TRANSFER_SRC_BIT),
-        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
-        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
-        0,
-        staging_buffer,
-        staging_buffer_memory);
-
-    device->updateBufferMemory(
-        staging_buffer_memory,
-        image_size,
-        pixels);
-
-    vk::helper::createTextureImage(
-        device,
-        glm::vec3(tex_width, tex_height, 1),
-        format,
-        ImageTiling::OPTIMAL,
-        SET_FLAG_BIT(ImageUsage, TRANSFER_DST_BIT) |
-        SET_FLAG_BIT(ImageUsage, SAMPLED_BIT),
-        SET_FLAG_BIT(MemoryProperty, DEVICE_LOCAL_BIT),
-        texture_image,
-        texture_image_memory);
-
+    BufferInfo staging;
     auto cmd_buf = device->setupTransientCommandBuffer();
-    vk::helper::transitionImageLayout(
+    recordStaged2DTextureUpload(
+        device,
         cmd_buf,
-        texture_image,
         format,
-        ImageLayout::UNDEFINED,
-        ImageLayout::TRANSFER_DST_OPTIMAL);
-    vk::helper::copyBufferToImage(
-        cmd_buf,
-        staging_buffer,
+        glm::uvec2(tex_width, tex_height),
+        pixels,
         texture_image,
-        glm::uvec3(tex_width, tex_height, 1));
-    vk::helper::transitionImageLayout(
-        cmd_buf,
-        texture_image,
-        format,
-        ImageLayout::TRANSFER_DST_OPTIMAL,
-        ImageLayout::SHADER_READ_ONLY_OPTIMAL);
+        texture_image_memory,
+        staging);
     device->submitAndWaitTransientCommandBuffer();
-
-    device->destroyBuffer(staging_buffer);
-    device->freeMemory(staging_buffer_memory);
+    staging.destroy(device);
 }
 
 void Helper::create2DTextureImage(
@@ -573,97 +696,27 @@ void Helper::createCubemapTexture(
     const std::vector<BufferImageCopyInfo>& copy_regions,
     TextureInfo& texture,
     uint64_t buffer_size /*= 0*/,
-    void* data /*= nullptr*/) {
+    const void* data /*= nullptr*/) {
     bool use_as_framebuffer = data == nullptr;
-    VkDeviceSize image_size = static_cast<VkDeviceSize>(buffer_size);
-
-    std::shared_ptr<Buffer> staging_buffer;
-    std::shared_ptr<DeviceMemory> staging_buffer_memory;
-    if (data) {
-        device->createBuffer(
-            image_size,
-            SET_FLAG_BIT(BufferUsage, TRANSFER_SRC_BIT),
-            SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
-            SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
-            0,
-            staging_buffer,
-            staging_buffer_memory);
-
-        device->updateBufferMemory(staging_buffer_memory, buffer_size, data);
-    }
-
-    auto image_usage_flags =
-        SET_FLAG_BIT(ImageUsage, TRANSFER_DST_BIT) |
-        SET_FLAG_BIT(ImageUsage, SAMPLED_BIT) |
-        SET_FLAG_BIT(ImageUsage, STORAGE_BIT);
-
-    if (use_as_framebuffer) {
-        image_usage_flags |=
-            SET_FLAG_BIT(ImageUsage, COLOR_ATTACHMENT_BIT) |
-            SET_FLAG_BIT(ImageUsage, TRANSFER_SRC_BIT);
-    }
-
-    texture.image = device->createImage(
-        ImageType::TYPE_2D,
-        glm::uvec3(width, height, 1),
-        format,
-        image_usage_flags,
-        ImageTiling::OPTIMAL,
-        ImageLayout::UNDEFINED,
-        SET_FLAG_BIT(ImageCreate, CUBE_COMPATIBLE_BIT),
-        false,
-        1,
-        mip_count,
-        6u);
-
-    auto mem_requirements = device->getImageMemoryRequirements(texture.image);
-    texture.memory = device->allocateMemory(
-        mem_requirements.size,
-        mem_requirements.memory_type_bits,
-        vk::helper::toVkMemoryPropertyFlags(SET_FLAG_BIT(MemoryProperty, DEVICE_LOCAL_BIT)),
-        0);
-    device->bindImageMemory(texture.image, texture.memory);
+    createCubemapImage(device, width, height, mip_count, format, use_as_framebuffer, texture);
 
     if (data) {
+        BufferInfo staging;
         auto cmd_buf = device->setupTransientCommandBuffer();
-        vk::helper::transitionImageLayout(
+        recordStagedCubemapUpload(
+            device,
             cmd_buf,
             texture.image,
             format,
-            ImageLayout::UNDEFINED,
-            ImageLayout::TRANSFER_DST_OPTIMAL,
-            0,
             mip_count,
-            0,
-            6);
-        vk::helper::copyBufferToImageWithMips(
-            cmd_buf,
-            staging_buffer,
-            texture.image,
-            copy_regions);
-        vk::helper::transitionImageLayout(
-            cmd_buf,
-            texture.image,
-            format,
-            ImageLayout::TRANSFER_DST_OPTIMAL,
-            ImageLayout::SHADER_READ_ONLY_OPTIMAL,
-            0,
-            mip_count,
-            0,
-            6);
+            copy_regions,
+            buffer_size,
+            data,
+            staging);
         device->submitAndWaitTransientCommandBuffer();
+        staging.destroy(device);
     }
 
-    texture.view = device->createImageView(
-        texture.image,
-        ImageViewType::VIEW_CUBE,
-        format,
-        SET_FLAG_BIT(ImageAspect, COLOR_BIT),
-        0,
-        mip_count,
-        0,
-        6);
-
     assert(render_pass);
 
     if (use_as_framebuffer) {
@@ -697,11 +750,6 @@ void Helper::createCubemapTexture(
     }
 
     texture.size = glm::uvec3(width, height, 1);
-
-    if (data) {
-        device->destroyBuffer(staging_buffer);
-        device->freeMemory(staging_buffer_memory);
-    }
 }
 
 void Helper::blitImage(
@@ -763,7 +811,7 @@ void Helper::blitImage(
         ImageLayout::TRANSFER_SRC_OPTIMAL,
         dst_image,
         ImageLayout::TRANSFER_DST_OPTIMAL,
-        { copy_region },
+        { &copy_region, 1 },
         Filter::NEAREST);
 
     barrier.image = src_image;
@@ -1057,5 +1105,295 @@ void BufferInfo::destroy(const std::shared_ptr<Device>& device) {
     device->freeMemory(memory);
 }
 
+void BindlessTextureTable::create(
+    const std::shared_ptr<Device>& device,
+    uint32_t max_textures,
+    uint32_t max_storage_images) {
+    std::vector<DescriptorSetLayoutBinding> bindings(2);
+    bindings[0].binding = BINDLESS_TEXTURE_INDEX;
+    bindings[0].descriptor_type = DescriptorType::COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptor_count = max_textures;
+    bindings[0].stage_flags =
+        SET_FLAG_BIT(ShaderStage, COMPUTE_BIT) |
+        SET_FLAG_BIT(ShaderStage, ALL_GRAPHICS);
+    bindings[1] = bindings[0];
+    bindings[1].binding = BINDLESS_STORAGE_IMAGE_INDEX;
+    bindings[1].descriptor_type = DescriptorType::STORAGE_IMAGE;
+    bindings[1].descriptor_count = max_storage_images;
+
+    desc_set_layout = device->createBindlessDescriptorSetLayout(bindings);
+    descriptor_pool = device->createBindlessDescriptorPool(bindings);
+    desc_set = device->createDescriptorSets(descriptor_pool, desc_set_layout, 1)[0];
+
+    // slots are handed out from the front.
+    free_texture_slots.resize(max_textures);
+    for (uint32_t i = 0; i < max_textures; i++) {
+        free_texture_slots[i] = max_textures - 1 - i;
+    }
+    free_storage_image_slots.resize(max_storage_images);
+    for (uint32_t i = 0; i < max_storage_images; i++) {
+        free_storage_image_slots[i] = max_storage_images - 1 - i;
+    }
+    num_texture_slots = max_textures;
+    num_storage_image_slots = max_storage_images;
+}
+
+uint32_t BindlessTextureTable::addTexture(
+    const std::shared_ptr<Device>& device,
+    const std::shared_ptr<Sampler>& sampler,
+    const std::shared_ptr<ImageView>& texture) {
+    if (free_texture_slots.empty()) {
+        throw std::runtime_error("bindless texture table is full!");
+    }
+    uint32_t slot = free_texture_slots.back();
+    free_texture_slots.pop_back();
+
+    WriteDescriptorList descriptor_writes;
+    Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        DescriptorType::COMBINED_IMAGE_SAMPLER,
+        BINDLESS_TEXTURE_INDEX,
+        sampler,
+        texture,
+        ImageLayout::SHADER_READ_ONLY_OPTIMAL);
+    descriptor_writes.back()->array_element = slot;
+    device->updateDescriptorSets(descriptor_writes);
+    return slot;
+}
+
+uint32_t BindlessTextureTable::addStorageImage(
+    const std::shared_ptr<Device>& device,
+    const std::shared_ptr<ImageView>& texture) {
+    if (free_storage_image_slots.empty()) {
+        throw std::runtime_error("bindless storage image table is full!");
+    }
+    uint32_t slot = free_storage_image_slots.back();
+    free_storage_image_slots.pop_back();
+
+    WriteDescriptorList descriptor_writes;
+    Helper::addOneTexture(
+        descriptor_writes,
+        desc_set,
+        DescriptorType::STORAGE_IMAGE,
+        BINDLESS_STORAGE_IMAGE_INDEX,
+        nullptr,
+        texture,
+        ImageLayout::GENERAL);
+    descriptor_writes.back()->array_element = slot;
+    device->updateDescriptorSets(descriptor_writes);
+    return slot;
+}
+
+void BindlessTextureTable::removeTexture(uint32_t slot) {
+    assert(slot < num_texture_slots);
+    free_texture_slots.push_back(slot);
+}
+
+void BindlessTextureTable::removeStorageImage(uint32_t slot) {
+    assert(slot < num_storage_image_slots);
+    free_storage_image_slots.push_back(slot);
+}
+
+void BindlessTextureTable::destroy(const std::shared_ptr<Device>& device) {
+    device->destroyDescriptorPool(descriptor_pool);
+    device->destroyDescriptorSetLayout(desc_set_layout);
+    free_texture_slots.clear();
+    free_storage_image_slots.clear();
+}
+
+void ParallelCommandRecorder::create(
+    const std::shared_ptr<Device>& device,
+    const std::shared_ptr<job_system::JobSystem>& jobs,
+    uint32_t queue_family_index,
+    uint32_t num_frames) {
+    job_system = jobs;
+    contexts.resize(num_frames);
+    for (auto& frame_contexts : contexts) {
+        frame_contexts.resize(job_system->getNumWorkers() + 1);
+        for (auto& context : frame_contexts) {
+            context.cmd_pool =
+                device->createCommandPool(
+                    queue_family_index,
+                    SET_FLAG_BIT(CommandPoolCreate, TRANSIENT_BIT));
+        }
+    }
+    cur_frame = 0;
+}
+
+void ParallelCommandRecorder::beginFrame(
+    const std::shared_ptr<Device>& device,
+    uint64_t frame_index) {
+    cur_frame = static_cast<uint32_t>(frame_index % contexts.size());
+    for (auto& context : contexts[cur_frame]) {
+        device->resetCommandPool(context.cmd_pool);
+        context.num_used_cmd_bufs = 0;
+    }
+}
+
+std::vector<std::shared_ptr<CommandBuffer>> ParallelCommandRecorder::recordSecondary(
+    const std::shared_ptr<Device>& device,
+    const CommandBufferInheritanceInfo& inheritance,
+    uint32_t num_jobs,
+    const RecordFunc& record_func) {
+    std::vector<std::shared_ptr<CommandBuffer>> result(num_jobs);
+    auto& frame_contexts = contexts[cur_frame];
+
+    auto usage_flags =
+        SET_FLAG_BIT(CommandBufferUsage, ONE_TIME_SUBMIT_BIT) |
+        (inheritance.render_pass ? SET_FLAG_BIT(CommandBufferUsage, RENDER_PASS_CONTINUE_BIT) : 0);
+
+    job_system->parallelFor(0, num_jobs, 1, [&](uint32_t job_begin, uint32_t job_end) {
+        // only this worker touches its pool, allocating from it needs no lock. parallelFor
+        // runs small ranges inline, so a caller outside the job system ends up here too.
+        auto worker_idx = job_system::JobSystem::getCurrentWorkerIndex();
+        std::unique_lock<std::mutex> outside_lock;
+        if (worker_idx < 0) {
+            worker_idx = static_cast<int32_t>(frame_contexts.size() - 1);
+            outside_lock = std::unique_lock<std::mutex>(outside_context_mutex);
+        }
+        auto& context = frame_contexts[worker_idx];
+        for (uint32_t i_job = job_begin; i_job < job_end; i_job++) {
+            if (context.num_used_cmd_bufs == context.cmd_bufs.size()) {
+                context.cmd_bufs.push_back(
+                    device->allocateCommandBuffers(context.cmd_pool, 1, false)[0]);
+            }
+            const auto& cmd_buf = context.cmd_bufs[context.num_used_cmd_bufs++];
+            cmd_buf->beginCommandBuffer(usage_flags, inheritance);
+            record_func(i_job, cmd_buf);
+            cmd_buf->endCommandBuffer();
+            result[i_job] = cmd_buf;
+        }
+    });
+
+    return result;
+}
+
+void ParallelCommandRecorder::destroy(const std::shared_ptr<Device>& device) {
+    // buffers go with their pools.
+    for (auto& frame_contexts : contexts) {
+        for (auto& context : frame_contexts) {
+            device->destroyCommandPool(context.cmd_pool);
+        }
+    }
+    contexts.clear();
+    job_system = nullptr;
+}
+
+void UniformBufferRing::create(
+    const std::shared_ptr<Device>& device,
+    uint64_t size,
+    uint32_t frames) {
+    // allocations may get bound as either kind of dynamic buffer.
+    alignment =
+        std::max(
+            device->getMinUniformBufferOffsetAlignment(),
+            device->getMinStorageBufferOffsetAlignment());
+    frame_size = (size + alignment - 1) / alignment * alignment;
+    num_frames = frames;
+    device->createBuffer(
+        frame_size * num_frames,
+        SET_FLAG_BIT(BufferUsage, UNIFORM_BUFFER_BIT) |
+        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        buffer,
+        memory);
+
+    // coherent memory stays mapped for the whole lifetime, writes need no flush.
+    mapped_data = static_cast<uint8_t*>(
+        device->mapMemory(memory, frame_size * num_frames));
+    frame_offset = 0;
+    cur_offset = 0;
+}
+
+void UniformBufferRing::beginFrame(uint64_t frame_index) {
+    frame_offset = (frame_index % num_frames) * frame_size;
+    cur_offset = 0;
+}
+
+uint32_t UniformBufferRing::allocate(const void* data, uint64_t size) {
+    if (cur_offset + size > frame_size) {
+        throw std::runtime_error("uniform buffer ring is out of space!");
+    }
+
+    uint64_t offset = frame_offset + cur_offset;
+    memcpy(mapped_data + offset, data, size);
+    cur_offset += (size + alignment - 1) / alignment * alignment;
+    return static_cast<uint32_t>(offset);
+}
+
+void UniformBufferRing::destroy(const std::shared_ptr<Device>& device) {
+    if (mapped_data) {
+        device->unmapMemory(memory);
+        mapped_data = nullptr;
+    }
+    device->destroyBuffer(buffer);
+    device->freeMemory(memory);
+}
+
+void TextureUploadBatch::begin(const std::shared_ptr<Device>& device) {
+    cmd_buf = device->setupTransientCommandBuffer();
+}
+
+void TextureUploadBatch::add2DTexture(
+    const std::shared_ptr<Device>& device,
+    Format format,
+    const glm::uvec2& size,
+    const void* pixels,
+    TextureInfo& texture) {
+    staging_buffers.emplace_back();
+    recordStaged2DTextureUpload(
+        device,
+        cmd_buf,
+        format,
+        size,
+        pixels,
+        texture.image,
+        texture.memory,
+        staging_buffers.back());
+
+    texture.view = device->createImageView(
+        texture.image,
+        ImageViewType::VIEW_2D,
+        format,
+        SET_FLAG_BIT(ImageAspect, COLOR_BIT));
+    texture.size = glm::uvec3(size, 1);
+}
+
+void TextureUploadBatch::addCubemapTexture(
+    const std::shared_ptr<Device>& device,
+    const glm::uvec2& size,
+    uint32_t mip_count,
+    Format format,
+    const std::vector<BufferImageCopyInfo>& copy_regions,
+    uint64_t buffer_size,
+    const void* data,
+    TextureInfo& texture) {
+    createCubemapImage(device, size.x, size.y, mip_count, format, false, texture);
+    staging_buffers.emplace_back();
+    recordStagedCubemapUpload(
+        device,
+        cmd_buf,
+        texture.image,
+        format,
+        mip_count,
+        copy_regions,
+        buffer_size,
+        data,
+        staging_buffers.back());
+    texture.size = glm::uvec3(size, 1);
+}
+
+void TextureUploadBatch::submit(const std::shared_ptr<Device>& device) {
+    device->submitAndWaitTransientCommandBuffer();
+    cmd_buf = nullptr;
+    for (auto& staging : staging_buffers) {
+        staging.destroy(device);
+    }
+    staging_buffers.clear();
+}
+
 } // namespace renderer
 } // namespace engine
\ No newline at end of file
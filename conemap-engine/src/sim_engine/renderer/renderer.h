@@ -47,40 +47,40 @@ class Swapchain {
 class DescriptorPool {
 };
 
-class Pipeline {
+class Pipeline : public HandleOwner<Pipeline> {
 };
 
-class PipelineLayout {
+class PipelineLayout : public HandleOwner<PipelineLayout> {
 };
 
-class RenderPass {
+class RenderPass : public HandleOwner<RenderPass> {
 };
 
-class Framebuffer {
+class Framebuffer : public HandleOwner<Framebuffer> {
 };
 
-class ImageView {
+class ImageView : public HandleOwner<ImageView> {
 };
 
-class Sampler {
+class Sampler : public HandleOwner<Sampler> {
 };
 
-class Image {
+class Image : public HandleOwner<Image> {
 public:
     virtual ImageLayout getImageLayout() = 0;
     virtual void setImageLayout(ImageLayout layout) = 0;
 };
 
-class Buffer {
+class Buffer : public HandleOwner<Buffer> {
 public:
     virtual uint32_t getSize() = 0;
     virtual uint64_t getDeviceAddress() = 0;
 };
 
-class Semaphore {
+class Semaphore : public HandleOwner<Semaphore> {
 };
 
-class Fence {
+class Fence : public HandleOwner<Fence> {
 };
 
 class DeviceMemory {
@@ -89,10 +89,13 @@ class DeviceMemory {
 class DescriptorSetLayout {
 };
 
-class DescriptorSet {
+class DescriptorSet : public HandleOwner<DescriptorSet> {
 };
 
-class ShaderModule {
+class DescriptorUpdateTemplate {
+};
+
+class ShaderModule : public HandleOwner<ShaderModule> {
 };
 
 namespace vk {
@@ -155,9 +158,12 @@ public:
 
 class VulkanDescriptorPool : public DescriptorPool {
     VkDescriptorPool    descriptor_pool_;
+    // handles of the sets allocated from this pool, they go stale on reset and destroy.
+    std::vector<DescriptorSetHandle> desc_set_handles_;
 public:
     VkDescriptorPool get() { return descriptor_pool_; }
     void set(const VkDescriptorPool& descriptor_pool) { descriptor_pool_ = descriptor_pool; }
+    std::vector<DescriptorSetHandle>& getDescSetHandles() { return desc_set_handles_; }
 };
 
 class VulkanPipeline : public Pipeline {
@@ -264,6 +270,26 @@ public:
     VkDescriptorSet get() { return desc_set_; }
     void set(const VkDescriptorSet desc_set) { desc_set_ = desc_set; }
 };
+
+// template data of one descriptor, every template entry strides over these.
+union VulkanDescriptorData {
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+};
+
+class VulkanDescriptorUpdateTemplate : public DescriptorUpdateTemplate {
+    VkDescriptorUpdateTemplate  update_template_;
+    // descriptor type of every template entry, one per descriptor in binding order.
+    std::vector<VkDescriptorType> descriptor_types_;
+public:
+    VulkanDescriptorUpdateTemplate(
+        const VkDescriptorUpdateTemplate& update_template,
+        std::vector<VkDescriptorType>&& descriptor_types) :
+        update_template_(update_template),
+        descriptor_types_(std::move(descriptor_types)) {}
+    VkDescriptorUpdateTemplate get() { return update_template_; }
+    const std::vector<VkDescriptorType>& getDescriptorTypes() const { return descriptor_types_; }
+};
     
 
 class VulkanShaderModule : public ShaderModule {
@@ -425,7 +451,7 @@ public:
         const std::vector<BufferImageCopyInfo>& copy_regions,
         TextureInfo& texture,
         uint64_t buffer_size = 0,
-        void* data = nullptr);
+        const void* data = nullptr);
 
     static void createBuffer(
         const std::shared_ptr<Device>& device,
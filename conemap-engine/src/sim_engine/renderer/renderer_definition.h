@@ -2,6 +2,8 @@
 #include <memory>
 
 #define RENDER_TYPE_CAST(class, name) std::reinterpret_pointer_cast<engine::renderer::vk::Vulkan##class>(name)
+// raw pointer flavour for command recording, no shared_ptr copy so no refcount traffic.
+#define RENDER_TYPE_PTR(class, name) static_cast<engine::renderer::vk::Vulkan##class*>((name).get())
 #define ADD_FLAG_BIT(type, type1, name) result |= (flags & static_cast<uint32_t>(engine::renderer::type##FlagBits::name)) ? VK_##type1##_##name : 0
 #define SELECT_FLAG(type, type1, name) if (flag == engine::renderer::type::name) return VK_##type1##_##name
 #define SELECT_FROM_FLAG(type, type1, name) if (flag == VK_##type1##_##name) return engine::renderer::type::name
@@ -1350,6 +1352,12 @@ enum class SurfaceTransformFlagBits {
 };
 typedef uint32_t SurfaceTransformFlags;
 
+enum class SubpassContents {
+    INLINE = 0,
+    SECONDARY_COMMAND_BUFFERS = 1,
+    MAX_ENUM = 0x7FFFFFFF
+};
+
 enum class IndexType {
     UINT16 = 0,
     UINT32 = 1,
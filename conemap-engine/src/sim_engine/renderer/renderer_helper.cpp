@@ -402,9 +402,9 @@ std::shared_ptr<ShaderModule> loadShaderModule(
     auto search_result = s_shader_module_list.find(path_file_name);
     std::shared_ptr<ShaderModule> result;
     if (search_result == s_shader_module_list.end()) {
-        uint64_t shader_code_size;
-        auto shader_code = engine::helper::readFile(path_file_name.c_str(), shader_code_size);
-        auto shader_module = device->createShaderModule(shader_code_size, shader_code.data(), shader_stage);
+        // spir-v goes to the driver straight out of the mapping, no heap copy in between.
+        engine::helper::MappedFile shader_code(path_file_name);
+        auto shader_module = device->createShaderModule(shader_code.size(), shader_code.data(), shader_stage);
         s_shader_module_list[path_file_name] = shader_module;
         result = shader_module;
     }
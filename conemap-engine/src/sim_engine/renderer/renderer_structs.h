@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <optional>
 #include <functional>
@@ -21,6 +22,9 @@ inline void hash_combine(std::size_t& seed, const T& v)
 }
 
 namespace engine {
+namespace job_system {
+class JobSystem;
+}
 namespace renderer {
 class Instance;
 class Device;
@@ -36,6 +40,7 @@ class Framebuffer;
 class PipelineLayout;
 class DescriptorSetLayout;
 class DescriptorPool;
+class DescriptorUpdateTemplate;
 class DeviceMemory;
 class PhysicalDevice;
 class ShaderModule;
@@ -275,6 +280,7 @@ struct PushConstantRange {
 
 struct WriteDescriptor {
     uint32_t binding = (uint32_t)-1;
+    uint32_t array_element = 0;
     DescriptorType desc_type = DescriptorType::MAX_ENUM;
     std::shared_ptr<DescriptorSet> desc_set = nullptr;
 };
@@ -295,6 +301,39 @@ struct AccelerationStructDescriptor : public WriteDescriptor {
     std::vector<AccelerationStructure> acc_structs;
 };
 
+// one descriptor fed to an update template, in the order of the layout bindings.
+// the objects aren't owned, they only have to stay alive during the update call.
+struct DescriptorInfo {
+    Sampler* sampler = nullptr;
+    ImageView* texture = nullptr;
+    ImageLayout image_layout = ImageLayout::SHADER_READ_ONLY_OPTIMAL;
+    Buffer* buffer = nullptr;
+    uint64_t offset = 0;
+    uint64_t range = 0;
+
+    static DescriptorInfo fromTexture(
+        const std::shared_ptr<ImageView>& texture,
+        ImageLayout image_layout,
+        const std::shared_ptr<Sampler>& sampler = nullptr) {
+        DescriptorInfo info;
+        info.sampler = sampler.get();
+        info.texture = texture.get();
+        info.image_layout = image_layout;
+        return info;
+    }
+
+    static DescriptorInfo fromBuffer(
+        const std::shared_ptr<Buffer>& buffer,
+        uint64_t range,
+        uint64_t offset = 0) {
+        DescriptorInfo info;
+        info.buffer = buffer.get();
+        info.offset = offset;
+        info.range = range;
+        return info;
+    }
+};
+
 struct QueueFamilyInfo {
     QueueFlags queue_flags_;
     uint32_t queue_count_;
@@ -377,6 +416,14 @@ struct TextureInfo {
     void destroy(const std::shared_ptr<Device>& device);
 };
 
+// render pass state a secondary command buffer continues, only needed by the ones that
+// get executed inside a render pass.
+struct CommandBufferInheritanceInfo {
+    std::shared_ptr<RenderPass>         render_pass;
+    uint32_t                            subpass = 0;
+    std::shared_ptr<Framebuffer>        frame_buffer;
+};
+
 struct BufferInfo {
     std::shared_ptr<Buffer>             buffer;
     std::shared_ptr<DeviceMemory>       memory;
@@ -384,6 +431,126 @@ struct BufferInfo {
     void destroy(const std::shared_ptr<Device>& device);
 };
 
+// linear allocator for per frame constants. one persistently mapped buffer holds a slice
+// per frame in flight, allocations bump a pointer inside the current slice and get bound
+// through a dynamic uniform or storage buffer offset, so the gpu never reads a block the
+// cpu writes.
+struct UniformBufferRing {
+    std::shared_ptr<Buffer>             buffer;
+    std::shared_ptr<DeviceMemory>       memory;
+    uint8_t*                            mapped_data = nullptr;
+    uint64_t                            frame_size = 0;
+    uint64_t                            alignment = 1;
+    uint32_t                            num_frames = 0;
+    uint64_t                            frame_offset = 0;
+    uint64_t                            cur_offset = 0;
+
+    void create(
+        const std::shared_ptr<Device>& device,
+        uint64_t frame_size,
+        uint32_t num_frames);
+    // only call after the frame that used this slice last is done on the gpu.
+    void beginFrame(uint64_t frame_index);
+    // copies size bytes into the current slice, returns the dynamic offset to bind them at.
+    uint32_t allocate(const void* data, uint64_t size);
+    void destroy(const std::shared_ptr<Device>& device);
+};
+
+// texture uploads recorded into one transient command buffer, the whole batch waits on the
+// queue once instead of once per texture. only for the thread that owns the device.
+struct TextureUploadBatch {
+    std::shared_ptr<CommandBuffer>      cmd_buf;
+    std::vector<BufferInfo>             staging_buffers;
+
+    void begin(const std::shared_ptr<Device>& device);
+    // sampled 2d texture, pixels tightly packed, 2 bytes each for R16_UNORM, 4 otherwise.
+    void add2DTexture(
+        const std::shared_ptr<Device>& device,
+        Format format,
+        const glm::uvec2& size,
+        const void* pixels,
+        TextureInfo& texture);
+    // sampled cube texture, copy_regions point into data for every mip.
+    void addCubemapTexture(
+        const std::shared_ptr<Device>& device,
+        const glm::uvec2& size,
+        uint32_t mip_count,
+        Format format,
+        const std::vector<BufferImageCopyInfo>& copy_regions,
+        uint64_t buffer_size,
+        const void* data,
+        TextureInfo& texture);
+    // waits for all the copies, then frees the staging buffers.
+    void submit(const std::shared_ptr<Device>& device);
+};
+
+// records independent parts of a frame on the job system workers into secondary command
+// buffers. every worker owns one command pool per frame in flight, a frame's pools get
+// reset wholesale once it comes round again, so the command buffers are recycled, not freed.
+struct ParallelCommandRecorder {
+    struct WorkerContext {
+        std::shared_ptr<CommandPool>                cmd_pool;
+        std::vector<std::shared_ptr<CommandBuffer>> cmd_bufs;
+        uint32_t                                    num_used_cmd_bufs = 0;
+    };
+    typedef std::function<void(
+        uint32_t job_idx,
+        const std::shared_ptr<CommandBuffer>& cmd_buf)> RecordFunc;
+
+    std::shared_ptr<job_system::JobSystem> job_system;
+    // indexed by frame, then by worker. one more context after the workers' for threads
+    // outside the job system, those can share it and take outside_context_mutex.
+    std::vector<std::vector<WorkerContext>> contexts;
+    std::mutex outside_context_mutex;
+    uint32_t cur_frame = 0;
+
+    void create(
+        const std::shared_ptr<Device>& device,
+        const std::shared_ptr<job_system::JobSystem>& job_system,
+        uint32_t queue_family_index,
+        uint32_t num_frames);
+    // only call after the frame that used these pools last is done on the gpu.
+    void beginFrame(const std::shared_ptr<Device>& device, uint64_t frame_index);
+    // one secondary command buffer per job, returned in job order. whichever worker picks
+    // a job up records it from its own pool, so record_func runs concurrently and must
+    // only read shared state.
+    std::vector<std::shared_ptr<CommandBuffer>> recordSecondary(
+        const std::shared_ptr<Device>& device,
+        const CommandBufferInheritanceInfo& inheritance,
+        uint32_t num_jobs,
+        const RecordFunc& record_func);
+    void destroy(const std::shared_ptr<Device>& device);
+};
+
+// global bindless table, shaders address textures by slot through push constants instead
+// of binding a descriptor set per material. sampled textures and storage images have
+// their own slot arrays, see BINDLESS_TEXTURE_INDEX and BINDLESS_STORAGE_IMAGE_INDEX.
+struct BindlessTextureTable {
+    std::shared_ptr<DescriptorSetLayout> desc_set_layout;
+    std::shared_ptr<DescriptorPool>      descriptor_pool;
+    std::shared_ptr<DescriptorSet>       desc_set;
+    uint32_t                             num_texture_slots = 0;
+    uint32_t                             num_storage_image_slots = 0;
+    std::vector<uint32_t>                free_texture_slots;
+    std::vector<uint32_t>                free_storage_image_slots;
+
+    void create(
+        const std::shared_ptr<Device>& device,
+        uint32_t max_textures,
+        uint32_t max_storage_images);
+    uint32_t addTexture(
+        const std::shared_ptr<Device>& device,
+        const std::shared_ptr<Sampler>& sampler,
+        const std::shared_ptr<ImageView>& texture);
+    uint32_t addStorageImage(
+        const std::shared_ptr<Device>& device,
+        const std::shared_ptr<ImageView>& texture);
+    // slots get reused by the next add, only remove once no pending frame reads them.
+    void removeTexture(uint32_t slot);
+    void removeStorageImage(uint32_t slot);
+    void destroy(const std::shared_ptr<Device>& device);
+};
+
 struct MemoryBarrier {
     AccessFlags             src_access_mask;
     AccessFlags             dst_access_mask;
@@ -0,0 +1,151 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace engine {
+namespace renderer {
+
+// 32 bit generational handle. the low bits index a slot of the per type pool, the high
+// bits hold the slot's generation, so a handle to a destroyed object never resolves to
+// whatever reused its slot. 0 is never handed out.
+template<typename T>
+struct Handle {
+    static const uint32_t kIndexBits = 20;
+    static const uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static const uint32_t kGenerationMask = (1u << (32 - kIndexBits)) - 1;
+
+    uint32_t value = 0;
+
+    Handle() = default;
+    Handle(uint32_t index, uint32_t generation) :
+        value(((generation & kGenerationMask) << kIndexBits) | (index & kIndexMask)) {}
+
+    uint32_t getIndex() const { return value & kIndexMask; }
+    uint32_t getGeneration() const { return value >> kIndexBits; }
+    bool isValid() const { return value != 0; }
+    bool operator==(const Handle& other) const { return value == other.value; }
+    bool operator!=(const Handle& other) const { return value != other.value; }
+};
+
+// dense pool of items addressed by generational handles. slots map to a packed item
+// array, removal moves the last item into the hole, so walking all the items for
+// destruction stays a linear pass over contiguous memory. the device keeps the raw api
+// objects in here, resolving a handle is two array reads, no refcount involved.
+template<typename T, typename Tag = T>
+class HandlePool {
+    std::vector<T> items_;
+    std::vector<uint32_t> item_slots_;
+    std::vector<uint32_t> slot_items_;
+    std::vector<uint32_t> slot_generations_;
+    std::vector<uint32_t> free_slots_;
+
+public:
+    Handle<Tag> add(const T& item) {
+        uint32_t slot;
+        if (free_slots_.empty()) {
+            if (slot_generations_.size() > Handle<Tag>::kIndexMask) {
+                throw std::runtime_error("handle pool is out of slots!");
+            }
+            slot = static_cast<uint32_t>(slot_generations_.size());
+            slot_items_.push_back(0);
+            // generation 0 is kept free, so slot 0 never packs to the invalid handle.
+            slot_generations_.push_back(1);
+        }
+        else {
+            slot = free_slots_.back();
+            free_slots_.pop_back();
+        }
+
+        slot_items_[slot] = static_cast<uint32_t>(items_.size());
+        items_.push_back(item);
+        item_slots_.push_back(slot);
+        return Handle<Tag>(slot, slot_generations_[slot]);
+    }
+
+    bool isValid(const Handle<Tag>& handle) const {
+        uint32_t slot = handle.getIndex();
+        return handle.isValid() &&
+               slot < slot_generations_.size() &&
+               slot_generations_[slot] == handle.getGeneration();
+    }
+
+    T* get(const Handle<Tag>& handle) {
+        return isValid(handle) ? &items_[slot_items_[handle.getIndex()]] : nullptr;
+    }
+
+    bool remove(const Handle<Tag>& handle) {
+        if (!isValid(handle)) {
+            return false;
+        }
+
+        uint32_t slot = handle.getIndex();
+        uint32_t item_idx = slot_items_[slot];
+        uint32_t last_idx = static_cast<uint32_t>(items_.size()) - 1;
+        if (item_idx != last_idx) {
+            items_[item_idx] = std::move(items_[last_idx]);
+            item_slots_[item_idx] = item_slots_[last_idx];
+            slot_items_[item_slots_[item_idx]] = item_idx;
+        }
+        items_.pop_back();
+        item_slots_.pop_back();
+
+        uint32_t generation = (slot_generations_[slot] + 1) & Handle<Tag>::kGenerationMask;
+        slot_generations_[slot] = generation == 0 ? 1 : generation;
+        free_slots_.push_back(slot);
+        return true;
+    }
+
+    std::span<T> getItems() {
+        return std::span<T>(items_.data(), items_.size());
+    }
+
+    size_t size() const {
+        return items_.size();
+    }
+
+    void clear() {
+        for (auto slot : item_slots_) {
+            uint32_t generation = (slot_generations_[slot] + 1) & Handle<Tag>::kGenerationMask;
+            slot_generations_[slot] = generation == 0 ? 1 : generation;
+            free_slots_.push_back(slot);
+        }
+        items_.clear();
+        item_slots_.clear();
+    }
+};
+
+// device objects remember the handle they got registered under, so destroying them
+// through the shared_ptr api doesn't need a search.
+template<typename T>
+class HandleOwner {
+    Handle<T> handle_;
+public:
+    const Handle<T>& getHandle() const { return handle_; }
+    void setHandle(const Handle<T>& handle) { handle_ = handle; }
+};
+
+class Buffer;
+class Image;
+class ImageView;
+class Sampler;
+class ShaderModule;
+class Framebuffer;
+class PipelineLayout;
+class Pipeline;
+class RenderPass;
+class Semaphore;
+class Fence;
+class DescriptorSet;
+
+typedef Handle<Buffer> BufferHandle;
+typedef Handle<Image> ImageHandle;
+typedef Handle<ImageView> ImageViewHandle;
+typedef Handle<Sampler> SamplerHandle;
+typedef Handle<Pipeline> PipelineHandle;
+typedef Handle<PipelineLayout> PipelineLayoutHandle;
+typedef Handle<DescriptorSet> DescriptorSetHandle;
+
+} // namespace renderer
+} // namespace engine
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 
 #include "../renderer.h"
@@ -9,8 +10,55 @@ namespace engine {
 namespace renderer {
 namespace vk {
 
+void* CommandScratchArena::allocate(size_t size, size_t alignment) {
+    while (block_idx_ < blocks_.size()) {
+        auto& block = blocks_[block_idx_];
+        size_t aligned_offset = (offset_ + alignment - 1) & ~(alignment - 1);
+        if (aligned_offset + size <= block.size) {
+            offset_ = aligned_offset + size;
+            return block.data.get() + aligned_offset;
+        }
+        block_idx_++;
+        offset_ = 0;
+    }
+
+    // new blocks at least double the scratch, so growth stops after a few commands.
+    size_t total_size = 0;
+    for (const auto& block : blocks_) {
+        total_size += block.size;
+    }
+    Block block;
+    block.size = std::max(std::max(total_size, size_t(4096)), size + alignment);
+    block.data = std::make_unique<uint8_t[]>(block.size);
+    blocks_.push_back(std::move(block));
+    block_idx_ = blocks_.size() - 1;
+    offset_ = 0;
+    return allocate(size, alignment);
+}
+
+void CommandScratchArena::rewind() {
+    block_idx_ = 0;
+    offset_ = 0;
+}
+
+void CommandScratchArena::reset() {
+    if (blocks_.size() > 1) {
+        size_t total_size = 0;
+        for (const auto& block : blocks_) {
+            total_size += block.size;
+        }
+        blocks_.clear();
+        Block block;
+        block.size = total_size;
+        block.data = std::make_unique<uint8_t[]>(block.size);
+        blocks_.push_back(std::move(block));
+    }
+    rewind();
+}
+
 void VulkanCommandBuffer::beginCommandBuffer(
     CommandBufferUsageFlags flags) {
+    num_recorded_commands_ = 0;
     VkCommandBufferBeginInfo begin_info{};
     begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
     begin_info.flags = helper::toCommandBufferUsageFlags(flags);
@@ -28,6 +76,39 @@ void VulkanCommandBuffer::beginCommandBuffer(
     }
 };
 
+void VulkanCommandBuffer::beginCommandBuffer(
+    CommandBufferUsageFlags flags,
+    const CommandBufferInheritanceInfo& inheritance) {
+    num_recorded_commands_ = 0;
+    VkCommandBufferInheritanceInfo inheritance_info{};
+    inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    if (inheritance.render_pass) {
+        inheritance_info.renderPass =
+            RENDER_TYPE_PTR(RenderPass, inheritance.render_pass)->get();
+    }
+    inheritance_info.subpass = inheritance.subpass;
+    if (inheritance.frame_buffer) {
+        inheritance_info.framebuffer =
+            RENDER_TYPE_PTR(Framebuffer, inheritance.frame_buffer)->get();
+    }
+
+    VkCommandBufferBeginInfo begin_info{};
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = helper::toCommandBufferUsageFlags(flags);
+    begin_info.pInheritanceInfo = &inheritance_info;
+
+    auto result =
+        vkBeginCommandBuffer(
+            cmd_buf_,
+            &begin_info);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(
+            std::string("failed to start recording secondary command buffer! : ") +
+            VkResultToString(result));
+    }
+}
+
 void VulkanCommandBuffer::endCommandBuffer() {
     auto result =
         vkEndCommandBuffer(cmd_buf_);
@@ -40,169 +121,218 @@ void VulkanCommandBuffer::endCommandBuffer() {
 }
 
 void VulkanCommandBuffer::copyBuffer(
-    std::shared_ptr<Buffer> src_buf,
-    std::shared_ptr<Buffer> dst_buf,
-    std::vector<BufferCopyInfo> copy_regions) {
-    std::vector<VkBufferCopy> vk_copy_regions(copy_regions.size());
+    const std::shared_ptr<Buffer>& src_buf,
+    const std::shared_ptr<Buffer>& dst_buf,
+    std::span<const BufferCopyInfo> copy_regions) {
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkBufferCopy>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkBufferCopy(copy_regions[i]);
     }
-    auto vk_src_buf = RENDER_TYPE_CAST(Buffer, src_buf);
-    auto vk_dst_buf = RENDER_TYPE_CAST(Buffer, dst_buf);
+    auto vk_src_buf = RENDER_TYPE_PTR(Buffer, src_buf);
+    auto vk_dst_buf = RENDER_TYPE_PTR(Buffer, dst_buf);
 
     vkCmdCopyBuffer(
         cmd_buf_,
         vk_src_buf->get(),
         vk_dst_buf->get(),
-        static_cast<uint32_t>(vk_copy_regions.size()),
-        vk_copy_regions.data());
+        static_cast<uint32_t>(copy_regions.size()),
+        vk_copy_regions);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::copyImage(
-    std::shared_ptr<Image> src_img,
+    const std::shared_ptr<Image>& src_img,
     ImageLayout src_img_layout,
-    std::shared_ptr<Image> dst_img,
+    const std::shared_ptr<Image>& dst_img,
     ImageLayout dst_img_layout,
-    std::vector<ImageCopyInfo> copy_regions) {
-    std::vector<VkImageCopy> vk_copy_regions(copy_regions.size());
+    std::span<const ImageCopyInfo> copy_regions) {
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkImageCopy>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkImageCopy(copy_regions[i]);
     }
-    auto vk_src_img = RENDER_TYPE_CAST(Image, src_img);
-    auto vk_dst_img = RENDER_TYPE_CAST(Image, dst_img);
+    auto vk_src_img = RENDER_TYPE_PTR(Image, src_img);
+    auto vk_dst_img = RENDER_TYPE_PTR(Image, dst_img);
     vkCmdCopyImage(
         cmd_buf_,
         vk_src_img->get(),
         helper::toVkImageLayout(src_img_layout),
         vk_dst_img->get(),
         helper::toVkImageLayout(dst_img_layout),
-        static_cast<uint32_t>(vk_copy_regions.size()),
-        vk_copy_regions.data());
+        static_cast<uint32_t>(copy_regions.size()),
+        vk_copy_regions);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::blitImage(
-    std::shared_ptr<Image> src_img,
+    const std::shared_ptr<Image>& src_img,
     ImageLayout src_img_layout,
-    std::shared_ptr<Image> dst_img,
+    const std::shared_ptr<Image>& dst_img,
     ImageLayout dst_img_layout,
-    std::vector<ImageBlitInfo> copy_regions,
+    std::span<const ImageBlitInfo> copy_regions,
     const Filter& filter) {
-    std::vector<VkImageBlit> vk_copy_regions(copy_regions.size());
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkImageBlit>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkImageBlit(copy_regions[i]);
     }
-    auto vk_src_img = RENDER_TYPE_CAST(Image, src_img);
-    auto vk_dst_img = RENDER_TYPE_CAST(Image, dst_img);
+    auto vk_src_img = RENDER_TYPE_PTR(Image, src_img);
+    auto vk_dst_img = RENDER_TYPE_PTR(Image, dst_img);
     vkCmdBlitImage(
         cmd_buf_,
         vk_src_img->get(),
         helper::toVkImageLayout(src_img_layout),
         vk_dst_img->get(),
         helper::toVkImageLayout(dst_img_layout),
-        static_cast<uint32_t>(vk_copy_regions.size()),
-        vk_copy_regions.data(),
+        static_cast<uint32_t>(copy_regions.size()),
+        vk_copy_regions,
         helper::toVkFilter(filter));
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::resolveImage(
-    std::shared_ptr<Image> src_img,
+    const std::shared_ptr<Image>& src_img,
     ImageLayout src_img_layout,
-    std::shared_ptr<Image> dst_img,
+    const std::shared_ptr<Image>& dst_img,
     ImageLayout dst_img_layout,
-    std::vector<ImageResolveInfo> copy_regions) {
-    std::vector<VkImageResolve> vk_copy_regions(copy_regions.size());
+    std::span<const ImageResolveInfo> copy_regions) {
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkImageResolve>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkImageResolve(copy_regions[i]);
     }
-    auto vk_src_img = RENDER_TYPE_CAST(Image, src_img);
-    auto vk_dst_img = RENDER_TYPE_CAST(Image, dst_img);
+    auto vk_src_img = RENDER_TYPE_PTR(Image, src_img);
+    auto vk_dst_img = RENDER_TYPE_PTR(Image, dst_img);
     vkCmdResolveImage(
         cmd_buf_,
         vk_src_img->get(),
         helper::toVkImageLayout(src_img_layout),
         vk_dst_img->get(),
         helper::toVkImageLayout(dst_img_layout),
-        static_cast<uint32_t>(vk_copy_regions.size()),
-        vk_copy_regions.data());
+        static_cast<uint32_t>(copy_regions.size()),
+        vk_copy_regions);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::copyBufferToImage(
-    std::shared_ptr<Buffer> src_buf,
-    std::shared_ptr<Image> dst_image,
-    std::vector<BufferImageCopyInfo> copy_regions,
+    const std::shared_ptr<Buffer>& src_buf,
+    const std::shared_ptr<Image>& dst_image,
+    std::span<const BufferImageCopyInfo> copy_regions,
     ImageLayout layout) {
-    std::vector<VkBufferImageCopy> vk_copy_regions(copy_regions.size());
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkBufferImageCopy>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkBufferImageCopy(copy_regions[i]);
     }
-    auto vk_src_buf = RENDER_TYPE_CAST(Buffer, src_buf);
-    auto vk_dst_image = RENDER_TYPE_CAST(Image, dst_image);
-    vkCmdCopyBufferToImage(cmd_buf_, vk_src_buf->get(), vk_dst_image->get(), helper::toVkImageLayout(layout), static_cast<uint32_t>(vk_copy_regions.size()), vk_copy_regions.data());
+    auto vk_src_buf = RENDER_TYPE_PTR(Buffer, src_buf);
+    auto vk_dst_image = RENDER_TYPE_PTR(Image, dst_image);
+    vkCmdCopyBufferToImage(cmd_buf_, vk_src_buf->get(), vk_dst_image->get(), helper::toVkImageLayout(layout), static_cast<uint32_t>(copy_regions.size()), vk_copy_regions);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::copyImageToBuffer(
-    std::shared_ptr<Image> src_image,
-    std::shared_ptr<Buffer> dst_buf,
-    std::vector<BufferImageCopyInfo> copy_regions,
+    const std::shared_ptr<Image>& src_image,
+    const std::shared_ptr<Buffer>& dst_buf,
+    std::span<const BufferImageCopyInfo> copy_regions,
     ImageLayout layout) {
-    std::vector<VkBufferImageCopy> vk_copy_regions(copy_regions.size());
+    scratch_.rewind();
+    auto vk_copy_regions = scratch_.allocate<VkBufferImageCopy>(copy_regions.size());
     for (uint32_t i = 0; i < copy_regions.size(); i++) {
         vk_copy_regions[i] = helper::toVkBufferImageCopy(copy_regions[i]);
     }
-    auto vk_src_image = RENDER_TYPE_CAST(Image, src_image);
-    auto vk_dst_buf = RENDER_TYPE_CAST(Buffer, dst_buf);
-    vkCmdCopyImageToBuffer(cmd_buf_, vk_src_image->get(), helper::toVkImageLayout(layout), vk_dst_buf->get(), static_cast<uint32_t>(vk_copy_regions.size()), vk_copy_regions.data());
+    auto vk_src_image = RENDER_TYPE_PTR(Image, src_image);
+    auto vk_dst_buf = RENDER_TYPE_PTR(Buffer, dst_buf);
+    vkCmdCopyImageToBuffer(cmd_buf_, vk_src_image->get(), helper::toVkImageLayout(layout), vk_dst_buf->get(), static_cast<uint32_t>(copy_regions.size()), vk_copy_regions);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::bindPipeline(
     PipelineBindPoint bind,
-    std::shared_ptr< Pipeline> pipeline) {
-    auto vk_pipeline = RENDER_TYPE_CAST(Pipeline, pipeline);
+    const std::shared_ptr<Pipeline>& pipeline) {
+    auto vk_pipeline = RENDER_TYPE_PTR(Pipeline, pipeline);
     vkCmdBindPipeline(cmd_buf_, helper::toVkPipelineBindPoint(bind), vk_pipeline->get());
+    num_recorded_commands_++;
+}
+
+void VulkanCommandBuffer::bindPipeline(
+    PipelineBindPoint bind,
+    const PipelineHandle& pipeline) {
+    vkCmdBindPipeline(cmd_buf_, helper::toVkPipelineBindPoint(bind), device_->getVkPipeline(pipeline));
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::bindVertexBuffers(
     uint32_t first_bind,
-    const std::vector<std::shared_ptr<Buffer>>& vertex_buffers,
-    std::vector<uint64_t> offsets) {
-    std::vector<VkDeviceSize> vk_offsets(vertex_buffers.size());
-    std::vector<VkBuffer> vk_vertex_buffers(vertex_buffers.size());
+    std::span<const std::shared_ptr<Buffer>> vertex_buffers,
+    std::span<const uint64_t> offsets) {
+    scratch_.rewind();
+    auto vk_offsets = scratch_.allocate<VkDeviceSize>(vertex_buffers.size());
+    auto vk_vertex_buffers = scratch_.allocate<VkBuffer>(vertex_buffers.size());
 
     for (int i = 0; i < vertex_buffers.size(); i++) {
-        auto vk_vertex_buffer = RENDER_TYPE_CAST(Buffer, vertex_buffers[i]);
+        auto vk_vertex_buffer = RENDER_TYPE_PTR(Buffer, vertex_buffers[i]);
         vk_vertex_buffers[i] = vk_vertex_buffer->get();
         vk_offsets[i] = i < offsets.size() ? offsets[i] : 0;
     }
-    vkCmdBindVertexBuffers(cmd_buf_, first_bind, static_cast<uint32_t>(vk_vertex_buffers.size()), vk_vertex_buffers.data(), vk_offsets.data());
+    vkCmdBindVertexBuffers(cmd_buf_, first_bind, static_cast<uint32_t>(vertex_buffers.size()), vk_vertex_buffers, vk_offsets);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::bindIndexBuffer(
-    std::shared_ptr<Buffer> index_buffer,
+    const std::shared_ptr<Buffer>& index_buffer,
     uint64_t offset,
     IndexType index_type) {
-    auto vk_index_buffer = RENDER_TYPE_CAST(Buffer, index_buffer);
+    auto vk_index_buffer = RENDER_TYPE_PTR(Buffer, index_buffer);
     vkCmdBindIndexBuffer(cmd_buf_, vk_index_buffer->get(), offset, helper::toVkIndexType(index_type));
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::bindDescriptorSets(
     PipelineBindPoint bind_point,
     const std::shared_ptr<PipelineLayout>& pipeline_layout,
-    const DescriptorSetList& desc_sets,
-    const uint32_t first_set_idx/* = 0 */ ) {
-    std::vector<VkDescriptorSet> vk_desc_sets;
-    auto vk_pipeline_layout = RENDER_TYPE_CAST(PipelineLayout, pipeline_layout);
+    std::span<const std::shared_ptr<DescriptorSet>> desc_sets,
+    const uint32_t first_set_idx/* = 0 */,
+    std::span<const uint32_t> dynamic_offsets/* = {} */) {
+    scratch_.rewind();
+    auto vk_desc_sets = scratch_.allocate<VkDescriptorSet>(desc_sets.size());
+    auto vk_pipeline_layout = RENDER_TYPE_PTR(PipelineLayout, pipeline_layout);
     for (auto i = 0; i < desc_sets.size(); i++) {
-        vk_desc_sets.push_back(RENDER_TYPE_CAST(DescriptorSet, desc_sets[i])->get());
+        vk_desc_sets[i] = RENDER_TYPE_PTR(DescriptorSet, desc_sets[i])->get();
     }
     vkCmdBindDescriptorSets(
         cmd_buf_,
         helper::toVkPipelineBindPoint(bind_point),
         vk_pipeline_layout->get(),
         first_set_idx,
-        static_cast<uint32_t>(vk_desc_sets.size()),
-        vk_desc_sets.data(),
-        0,
-        nullptr);
+        static_cast<uint32_t>(desc_sets.size()),
+        vk_desc_sets,
+        static_cast<uint32_t>(dynamic_offsets.size()),
+        dynamic_offsets.data());
+    num_recorded_commands_++;
+}
+
+void VulkanCommandBuffer::bindDescriptorSets(
+    PipelineBindPoint bind_point,
+    const PipelineLayoutHandle& pipeline_layout,
+    std::span<const DescriptorSetHandle> desc_sets,
+    const uint32_t first_set_idx/* = 0 */,
+    std::span<const uint32_t> dynamic_offsets/* = {} */) {
+    scratch_.rewind();
+    auto vk_desc_sets = scratch_.allocate<VkDescriptorSet>(desc_sets.size());
+    for (auto i = 0; i < desc_sets.size(); i++) {
+        vk_desc_sets[i] = device_->getVkDescriptorSet(desc_sets[i]);
+    }
+    vkCmdBindDescriptorSets(
+        cmd_buf_,
+        helper::toVkPipelineBindPoint(bind_point),
+        device_->getVkPipelineLayout(pipeline_layout),
+        first_set_idx,
+        static_cast<uint32_t>(desc_sets.size()),
+        vk_desc_sets,
+        static_cast<uint32_t>(dynamic_offsets.size()),
+        dynamic_offsets.data());
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::pushConstants(
@@ -211,7 +341,7 @@ void VulkanCommandBuffer::pushConstants(
     const void* data,
     uint32_t size,
     uint32_t offset/* = 0*/) {
-    auto vk_pipeline_layout = RENDER_TYPE_CAST(PipelineLayout, pipeline_layout);
+    auto vk_pipeline_layout = RENDER_TYPE_PTR(PipelineLayout, pipeline_layout);
     if (size > 128) {
         std::cerr << "push constant size is too large:" << size << std::endl;
     }
@@ -222,6 +352,26 @@ void VulkanCommandBuffer::pushConstants(
         offset,
         size,
         data);
+    num_recorded_commands_++;
+}
+
+void VulkanCommandBuffer::pushConstants(
+    ShaderStageFlags stages,
+    const PipelineLayoutHandle& pipeline_layout,
+    const void* data,
+    uint32_t size,
+    uint32_t offset/* = 0*/) {
+    if (size > 128) {
+        std::cerr << "push constant size is too large:" << size << std::endl;
+    }
+    vkCmdPushConstants(
+        cmd_buf_,
+        device_->getVkPipelineLayout(pipeline_layout),
+        helper::toVkShaderStageFlags(stages),
+        offset,
+        size,
+        data);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::draw(
@@ -230,6 +380,7 @@ void VulkanCommandBuffer::draw(
     uint32_t first_vertex/* = 0*/,
     uint32_t first_instance/* = 0*/) {
     vkCmdDraw(cmd_buf_, vertex_count, instance_count, first_vertex, first_instance);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::drawIndexed(
@@ -239,6 +390,7 @@ void VulkanCommandBuffer::drawIndexed(
     uint32_t vertex_offset/* = 0*/,
     uint32_t first_instance/* = 0*/) {
     vkCmdDrawIndexed(cmd_buf_, index_count, instance_count, first_index, vertex_offset, first_instance);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::drawIndexedIndirect(
@@ -246,8 +398,9 @@ void VulkanCommandBuffer::drawIndexedIndirect(
     uint32_t buffer_offset/* = 0*/,
     uint32_t draw_count/* = 1*/,
     uint32_t stride/* = sizeof(DrawIndexedIndirectCommand)*/) {
-    auto vk_indirect_buffer = RENDER_TYPE_CAST(Buffer, indirect_draw_cmd_buf.buffer);
+    auto vk_indirect_buffer = RENDER_TYPE_PTR(Buffer, indirect_draw_cmd_buf.buffer);
     vkCmdDrawIndexedIndirect(cmd_buf_, vk_indirect_buffer->get(), buffer_offset, draw_count, stride);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::drawIndirect(
@@ -255,8 +408,9 @@ void VulkanCommandBuffer::drawIndirect(
     uint32_t buffer_offset/* = 0*/,
     uint32_t draw_count/* = 1*/,
     uint32_t stride/* = sizeof(DrawIndirectCommand)*/) {
-    auto vk_indirect_buffer = RENDER_TYPE_CAST(Buffer, indirect_draw_cmd_buf.buffer);
+    auto vk_indirect_buffer = RENDER_TYPE_PTR(Buffer, indirect_draw_cmd_buf.buffer);
     vkCmdDrawIndirect(cmd_buf_, vk_indirect_buffer->get(), buffer_offset, draw_count, stride);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::drawMeshTasks(
@@ -268,6 +422,7 @@ void VulkanCommandBuffer::drawMeshTasks(
         group_count_x,
         group_count_y,
         group_count_z);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::drawMeshTasksIndirect() {
@@ -280,6 +435,7 @@ void VulkanCommandBuffer::drawMeshTasksIndirectCount() {
 
 void VulkanCommandBuffer::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z/* = 1*/) {
     vkCmdDispatch(cmd_buf_, group_count_x, group_count_y, group_count_z);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::traceRays(
@@ -302,21 +458,24 @@ void VulkanCommandBuffer::traceRays(
         size.x,
         size.y,
         size.z);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::beginRenderPass(
-    std::shared_ptr<RenderPass> render_pass,
-    std::shared_ptr<Framebuffer> frame_buffer,
+    const std::shared_ptr<RenderPass>& render_pass,
+    const std::shared_ptr<Framebuffer>& frame_buffer,
     const glm::uvec2& extent,
-    const std::vector<ClearValue>& clear_values) {
-    std::vector<VkClearValue> vk_clear_values(clear_values.size());
+    std::span<const ClearValue> clear_values,
+    SubpassContents contents/* = SubpassContents::INLINE*/) {
+    scratch_.rewind();
+    auto vk_clear_values = scratch_.allocate<VkClearValue>(clear_values.size());
 
     for (int i = 0; i < clear_values.size(); i++) {
         std::memcpy(&vk_clear_values[i].color, &clear_values[i].color, sizeof(VkClearValue));
     }
 
-    auto vk_render_pass = RENDER_TYPE_CAST(RenderPass, render_pass);
-    auto vk_frame_buffer = RENDER_TYPE_CAST(Framebuffer, frame_buffer);
+    auto vk_render_pass = RENDER_TYPE_PTR(RenderPass, render_pass);
+    auto vk_frame_buffer = RENDER_TYPE_PTR(Framebuffer, frame_buffer);
 
     assert(vk_render_pass);
     assert(vk_frame_buffer);
@@ -326,14 +485,30 @@ void VulkanCommandBuffer::beginRenderPass(
     render_pass_info.framebuffer = vk_frame_buffer->get();
     render_pass_info.renderArea.offset = { 0, 0 };
     render_pass_info.renderArea.extent = { extent.x, extent.y };
-    render_pass_info.clearValueCount = static_cast<uint32_t>(vk_clear_values.size());
-    render_pass_info.pClearValues = vk_clear_values.data();
+    render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
+    render_pass_info.pClearValues = vk_clear_values;
 
-    vkCmdBeginRenderPass(cmd_buf_, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(cmd_buf_, &render_pass_info, static_cast<VkSubpassContents>(contents));
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::endRenderPass() {
     vkCmdEndRenderPass(cmd_buf_);
+    num_recorded_commands_++;
+}
+
+void VulkanCommandBuffer::executeCommands(
+    std::span<const std::shared_ptr<CommandBuffer>> cmd_bufs) {
+    scratch_.rewind();
+    auto vk_cmd_bufs = scratch_.allocate<VkCommandBuffer>(cmd_bufs.size());
+    for (auto i = 0; i < cmd_bufs.size(); i++) {
+        vk_cmd_bufs[i] = RENDER_TYPE_PTR(CommandBuffer, cmd_bufs[i])->get();
+    }
+    vkCmdExecuteCommands(
+        cmd_buf_,
+        static_cast<uint32_t>(cmd_bufs.size()),
+        vk_cmd_bufs);
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::reset(uint32_t flags) {
@@ -347,28 +522,32 @@ void VulkanCommandBuffer::reset(uint32_t flags) {
             std::string("reset command buffer error : ") +
             VkResultToString(result));
     }
+
+    scratch_.reset();
+    num_recorded_commands_ = 0;
 }
 
 void VulkanCommandBuffer::addBarriers(
     const BarrierList& barrier_list,
     PipelineStageFlags src_stage_flags,
     PipelineStageFlags dst_stage_flags) {
+    scratch_.rewind();
     auto memory_barrier_count = barrier_list.memory_barriers.size();
-    std::vector<VkMemoryBarrier> memory_barriers(memory_barrier_count);
+    auto memory_barriers = scratch_.allocate<VkMemoryBarrier>(memory_barrier_count);
     for (auto i = 0; i < memory_barrier_count; i++) {
         memory_barriers[i] =
             helper::toVkMemoryBarrier(barrier_list.memory_barriers[i]);
     }
 
     auto buffer_barrier_count = barrier_list.buffer_barriers.size();
-    std::vector<VkBufferMemoryBarrier> buffer_barriers(buffer_barrier_count);
+    auto buffer_barriers = scratch_.allocate<VkBufferMemoryBarrier>(buffer_barrier_count);
     for (auto i = 0; i < buffer_barrier_count; i++) {
         buffer_barriers[i] =
             helper::toVkBufferMemoryBarrier(barrier_list.buffer_barriers[i]);
     }
 
     auto image_barrier_count = barrier_list.image_barriers.size();
-    std::vector<VkImageMemoryBarrier> image_barriers(image_barrier_count);
+    auto image_barriers = scratch_.allocate<VkImageMemoryBarrier>(image_barrier_count);
     for (auto i = 0; i < image_barrier_count; i++) {
         image_barriers[i] =
             helper::toVkImageMemoryBarrier(barrier_list.image_barriers[i]);
@@ -379,10 +558,11 @@ void VulkanCommandBuffer::addBarriers(
         helper::toVkPipelineStageFlags(src_stage_flags),
         helper::toVkPipelineStageFlags(dst_stage_flags),
         0,
-        static_cast<uint32_t>(memory_barrier_count), memory_barriers.data(),
-        static_cast<uint32_t>(buffer_barrier_count), buffer_barriers.data(),
-        static_cast<uint32_t>(image_barrier_count), image_barriers.data()
+        static_cast<uint32_t>(memory_barrier_count), memory_barriers,
+        static_cast<uint32_t>(buffer_barrier_count), buffer_barriers,
+        static_cast<uint32_t>(image_barrier_count), image_barriers
     );
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::addImageBarrier(
@@ -393,7 +573,7 @@ void VulkanCommandBuffer::addImageBarrier(
     uint32_t mip_count/* = 1*/,
     uint32_t base_layer/* = 0*/,
     uint32_t layer_count/* = 1*/) {
-    auto vk_image = RENDER_TYPE_CAST(Image, image);
+    auto vk_image = RENDER_TYPE_PTR(Image, image);
 
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
@@ -419,6 +599,7 @@ void VulkanCommandBuffer::addImageBarrier(
         0, nullptr,
         1, &barrier
     );
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::addBufferBarrier(
@@ -427,7 +608,7 @@ void VulkanCommandBuffer::addBufferBarrier(
     const BufferResourceInfo& dst_info,
     uint32_t size/* = 0*/,
     uint32_t offset/* = 0*/) {
-    auto vk_buffer = RENDER_TYPE_CAST(Buffer, buffer);
+    auto vk_buffer = RENDER_TYPE_PTR(Buffer, buffer);
 
     VkBufferMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -448,6 +629,7 @@ void VulkanCommandBuffer::addBufferBarrier(
         1, &barrier,
         0, nullptr
     );
+    num_recorded_commands_++;
 }
 
 void VulkanCommandBuffer::buildAccelerationStructures(
@@ -472,6 +654,7 @@ void VulkanCommandBuffer::buildAccelerationStructures(
         static_cast<uint32_t>(as_build_geo_list.size()),
         vk_geoms.data(),
         vk_as_build_range_ptr_list.data());
+    num_recorded_commands_++;
 }
 
 } // namespace vk
@@ -6,61 +6,111 @@ namespace engine {
 namespace renderer {
 namespace vk {
 
+// linear scratch memory for the vk structs a command gets translated to. every command
+// rewinds it before use, since vkCmd* copies its parameters, so it only grows to the
+// largest command seen. reset() folds the overflow blocks into a single one.
+class CommandScratchArena {
+    struct Block {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size = 0;
+    };
+    std::vector<Block> blocks_;
+    size_t block_idx_ = 0;
+    size_t offset_ = 0;
+
+    void* allocate(size_t size, size_t alignment);
+
+public:
+    template<typename T>
+    T* allocate(size_t count) {
+        return count == 0 ? nullptr : static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void rewind();
+    void reset();
+};
+
+class VulkanDevice;
+
 class VulkanCommandBuffer : public CommandBuffer {
     VkCommandBuffer    cmd_buf_;
+    // resolves the handle flavoured binds, set by the device that allocated this buffer.
+    VulkanDevice*      device_ = nullptr;
+    CommandScratchArena scratch_;
+    uint64_t num_recorded_commands_ = 0;
 public:
     VkCommandBuffer get() { return cmd_buf_; }
     void set(const VkCommandBuffer& cmd_buf) { cmd_buf_ = cmd_buf; }
+    void setDevice(VulkanDevice* device) { device_ = device; }
+
+    using CommandBuffer::bindDescriptorSets;
 
     virtual void beginCommandBuffer(CommandBufferUsageFlags flags) final;
+    virtual void beginCommandBuffer(
+        CommandBufferUsageFlags flags,
+        const CommandBufferInheritanceInfo& inheritance) final;
     virtual void endCommandBuffer() final;
     virtual void copyBuffer(
-        std::shared_ptr<Buffer> src_buf,
-        std::shared_ptr<Buffer> dst_buf,
-        std::vector<BufferCopyInfo> copy_regions) final;
+        const std::shared_ptr<Buffer>& src_buf,
+        const std::shared_ptr<Buffer>& dst_buf,
+        std::span<const BufferCopyInfo> copy_regions) final;
     virtual void copyImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageCopyInfo> copy_regions) final;
+        std::span<const ImageCopyInfo> copy_regions) final;
     virtual void blitImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageBlitInfo> copy_regions,
+        std::span<const ImageBlitInfo> copy_regions,
         const Filter& filter) final;
     virtual void resolveImage(
-        std::shared_ptr<Image> src_img,
+        const std::shared_ptr<Image>& src_img,
         ImageLayout src_img_layout,
-        std::shared_ptr<Image> dst_img,
+        const std::shared_ptr<Image>& dst_img,
         ImageLayout dst_img_layout,
-        std::vector<ImageResolveInfo> copy_regions) final;
+        std::span<const ImageResolveInfo> copy_regions) final;
     virtual void copyBufferToImage(
-        std::shared_ptr<Buffer> src_buf,
-        std::shared_ptr<Image> dst_image,
-        std::vector<BufferImageCopyInfo> copy_regions,
+        const std::shared_ptr<Buffer>& src_buf,
+        const std::shared_ptr<Image>& dst_image,
+        std::span<const BufferImageCopyInfo> copy_regions,
         ImageLayout layout) final;
     virtual void copyImageToBuffer(
-        std::shared_ptr<Image> src_image,
-        std::shared_ptr<Buffer> dst_buf,
-        std::vector<BufferImageCopyInfo> copy_regions,
+        const std::shared_ptr<Image>& src_image,
+        const std::shared_ptr<Buffer>& dst_buf,
+        std::span<const BufferImageCopyInfo> copy_regions,
         ImageLayout layout) final;
-    virtual void bindPipeline(PipelineBindPoint bind, std::shared_ptr< Pipeline> pipeline) final;
-    virtual void bindVertexBuffers(uint32_t first_bind, const std::vector<std::shared_ptr<renderer::Buffer>>& vertex_buffers, std::vector<uint64_t> offsets) final;
-    virtual void bindIndexBuffer(std::shared_ptr<Buffer> index_buffer, uint64_t offset, IndexType index_type) final;
+    virtual void bindPipeline(PipelineBindPoint bind, const std::shared_ptr<Pipeline>& pipeline) final;
+    virtual void bindPipeline(PipelineBindPoint bind, const PipelineHandle& pipeline) final;
+    virtual void bindVertexBuffers(uint32_t first_bind, std::span<const std::shared_ptr<renderer::Buffer>> vertex_buffers, std::span<const uint64_t> offsets) final;
+    virtual void bindIndexBuffer(const std::shared_ptr<Buffer>& index_buffer, uint64_t offset, IndexType index_type) final;
     virtual void bindDescriptorSets(
         PipelineBindPoint bind_point,
         const std::shared_ptr<PipelineLayout>& pipeline_layout,
-        const DescriptorSetList& desc_sets,
-        const uint32_t first_set_idx = 0) final;
+        std::span<const std::shared_ptr<DescriptorSet>> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::span<const uint32_t> dynamic_offsets = {}) final;
+    virtual void bindDescriptorSets(
+        PipelineBindPoint bind_point,
+        const PipelineLayoutHandle& pipeline_layout,
+        std::span<const DescriptorSetHandle> desc_sets,
+        const uint32_t first_set_idx = 0,
+        std::span<const uint32_t> dynamic_offsets = {}) final;
     virtual void pushConstants(
         ShaderStageFlags stages,
         const std::shared_ptr<PipelineLayout>& pipeline_layout,
         const void* data,
         uint32_t size,
         uint32_t offset = 0) final;
+    virtual void pushConstants(
+        ShaderStageFlags stages,
+        const PipelineLayoutHandle& pipeline_layout,
+        const void* data,
+        uint32_t size,
+        uint32_t offset = 0) final;
     virtual void draw(uint32_t vertex_count, 
         uint32_t instance_count = 1, 
         uint32_t first_vertex = 0, 
@@ -98,11 +148,14 @@ public:
         const StridedDeviceAddressRegion& callable_shader_entry,
         const glm::uvec3& size) final;
     virtual void beginRenderPass(
-        std::shared_ptr<RenderPass> render_pass,
-        std::shared_ptr<Framebuffer> frame_buffer,
+        const std::shared_ptr<RenderPass>& render_pass,
+        const std::shared_ptr<Framebuffer>& frame_buffer,
         const glm::uvec2& extent,
-        const std::vector<ClearValue>& clear_values) final;
+        std::span<const ClearValue> clear_values,
+        SubpassContents contents = SubpassContents::INLINE) final;
     virtual void endRenderPass() final;
+    virtual void executeCommands(
+        std::span<const std::shared_ptr<CommandBuffer>> cmd_bufs) final;
     virtual void reset(uint32_t flags) final;
     virtual void addBarriers(
         const BarrierList& barrier_list,
@@ -126,6 +179,9 @@ public:
     virtual void buildAccelerationStructures(
         const std::vector<AccelerationStructureBuildGeometryInfo>& as_build_geo_list,
         const std::vector<AccelerationStructureBuildRangeInfo>& as_build_range_list) final;
+    virtual uint64_t getNumRecordedCommands() const final {
+        return num_recorded_commands_;
+    }
 };
 
 } // namespace vk
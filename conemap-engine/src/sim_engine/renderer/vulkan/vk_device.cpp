@@ -41,6 +41,15 @@ VulkanDevice::VulkanDevice(
     uint32_t queue_family_index)
     : physical_device_(physical_device), device_(device)
 {
+    VkPhysicalDeviceProperties device_properties;
+    vkGetPhysicalDeviceProperties(
+        RENDER_TYPE_CAST(PhysicalDevice, physical_device)->get(),
+        &device_properties);
+    min_uniform_buffer_offset_alignment_ =
+        std::max(device_properties.limits.minUniformBufferOffsetAlignment, VkDeviceSize(1));
+    min_storage_buffer_offset_alignment_ =
+        std::max(device_properties.limits.minStorageBufferOffsetAlignment, VkDeviceSize(1));
+
     transient_cmd_pool_ =
         createCommandPool(queue_family_index,
             static_cast<uint32_t>(CommandPoolCreateFlagBits::TRANSIENT_BIT) |
@@ -69,17 +78,17 @@ VulkanDevice::VulkanDevice(
 
 VulkanDevice::~VulkanDevice()
 {
-    assert(buffer_list_.size() == 0);
-    assert(image_list_.size() == 0);
-    assert(image_view_list_.size() == 0);
-    assert(shader_list_.size() == 0);
-    assert(sampler_list_.size() == 0);
-    assert(framebuffer_list_.size() == 0);
-    assert(pipeline_layout_list_.size() == 0);
-    assert(pipeline_list_.size() == 0);
-    assert(render_pass_list_.size() == 0);
-    assert(semaphore_list_.size() == 0);
-    assert(fence_list_.size() == 0);
+    assert(buffer_pool_.size() == 0);
+    assert(image_pool_.size() == 0);
+    assert(image_view_pool_.size() == 0);
+    assert(shader_pool_.size() == 0);
+    assert(sampler_pool_.size() == 0);
+    assert(framebuffer_pool_.size() == 0);
+    assert(pipeline_layout_pool_.size() == 0);
+    assert(pipeline_pool_.size() == 0);
+    assert(render_pass_pool_.size() == 0);
+    assert(semaphore_pool_.size() == 0);
+    assert(fence_pool_.size() == 0);
 }
 
 std::shared_ptr<CommandBuffer> VulkanDevice::setupTransientCommandBuffer() {
@@ -95,6 +104,12 @@ void VulkanDevice::submitAndWaitTransientCommandBuffer() {
     waitForFences({ transient_fence_ });
     resetFences({ transient_fence_ });
     transient_cmd_buffer_->reset(0);
+
+    // with no frame in flight the queue is idle now, so the staging buffers and memory of
+    // the startup uploads and bakes don't have to wait for frame kMaxFramesInFlight.
+    if (!is_frame_started_) {
+        releaseRetiredObjects(UINT64_MAX);
+    }
 }
 
 std::shared_ptr<Buffer> VulkanDevice::createBuffer(
@@ -125,7 +140,7 @@ std::shared_ptr<Buffer> VulkanDevice::createBuffer(
         std::make_shared<VulkanBuffer>(
             buffer,
             static_cast<uint32_t>(buf_size));
-    buffer_list_.push_back(vk_buffer);
+    vk_buffer->setHandle(buffer_pool_.add(buffer));
 
     return vk_buffer;
 }
@@ -199,7 +214,7 @@ std::shared_ptr<Image> VulkanDevice::createImage(
     auto vk_image =
         std::make_shared<VulkanImage>(image);
     vk_image->setImageLayout(layout);
-    image_list_.push_back(vk_image);
+    vk_image->setHandle(image_pool_.add(image));
 
     return vk_image;
 }
@@ -242,7 +257,7 @@ std::shared_ptr<ImageView> VulkanDevice::createImageView(
 
     auto vk_image_view =
         std::make_shared<VulkanImageView>(image_view);
-    image_view_list_.push_back(vk_image_view);
+    vk_image_view->setHandle(image_view_pool_.add(image_view));
 
     return vk_image_view;
 }
@@ -286,7 +301,7 @@ std::shared_ptr<Sampler> VulkanDevice::createSampler(Filter filter, SamplerAddre
 
     auto vk_tex_sampler =
         std::make_shared<VulkanSampler>(tex_sampler);
-    sampler_list_.push_back(vk_tex_sampler);
+    vk_tex_sampler->setHandle(sampler_pool_.add(tex_sampler));
 
     return vk_tex_sampler;
 }
@@ -326,7 +341,7 @@ std::shared_ptr<Semaphore> VulkanDevice::createSemaphore() {
 
     auto vk_semaphore =
         std::make_shared<VulkanSemaphore>(semaphore);
-    semaphore_list_.push_back(vk_semaphore);
+    vk_semaphore->setHandle(semaphore_pool_.add(semaphore));
 
     return vk_semaphore;
 }
@@ -354,7 +369,7 @@ std::shared_ptr<Fence> VulkanDevice::createFence(bool signaled/* = false*/) {
 
     auto vk_fence =
         std::make_shared<VulkanFence>(fence);
-    fence_list_.push_back(vk_fence);
+    vk_fence->setHandle(fence_pool_.add(fence));
     
     return vk_fence;
 }
@@ -362,7 +377,7 @@ std::shared_ptr<Fence> VulkanDevice::createFence(bool signaled/* = false*/) {
 std::shared_ptr<ShaderModule>
 VulkanDevice::createShaderModule(
     uint64_t size,
-    void* data,
+    const void* data,
     ShaderStageFlagBits shader_stage) {
     VkShaderModuleCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -387,7 +402,7 @@ VulkanDevice::createShaderModule(
         std::make_shared<VulkanShaderModule>(
             shader_module,
             shader_stage);
-    shader_list_.push_back(vk_shader_module);
+    vk_shader_module->setHandle(shader_pool_.add(shader_module));
 
     return vk_shader_module;
 }
@@ -434,6 +449,17 @@ std::shared_ptr<Queue> VulkanDevice::getDeviceQueue(
 
 std::shared_ptr<DescriptorSetLayout> VulkanDevice::createDescriptorSetLayout(
     const std::vector<DescriptorSetLayoutBinding>& bindings) {
+    return createDescriptorSetLayout(bindings, false);
+}
+
+std::shared_ptr<DescriptorSetLayout> VulkanDevice::createBindlessDescriptorSetLayout(
+    const std::vector<DescriptorSetLayoutBinding>& bindings) {
+    return createDescriptorSetLayout(bindings, true);
+}
+
+std::shared_ptr<DescriptorSetLayout> VulkanDevice::createDescriptorSetLayout(
+    const std::vector<DescriptorSetLayoutBinding>& bindings,
+    bool is_bindless) {
     std::vector<VkDescriptorSetLayoutBinding> vk_bindings(bindings.size());
     for (auto i = 0; i < bindings.size(); i++) {
         const auto& binding = bindings[i];
@@ -451,6 +477,23 @@ std::shared_ptr<DescriptorSetLayout> VulkanDevice::createDescriptorSetLayout(
     layout_info.bindingCount = static_cast<uint32_t>(vk_bindings.size());
     layout_info.pBindings = vk_bindings.data();
 
+    // bindless arrays don't have to be filled, and slots nobody reads may be written
+    // while command buffers using the set are still pending.
+    std::vector<VkDescriptorBindingFlags> binding_flags;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo binding_flags_info{};
+    if (is_bindless) {
+        binding_flags.resize(
+            vk_bindings.size(),
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+        binding_flags_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        binding_flags_info.bindingCount = static_cast<uint32_t>(binding_flags.size());
+        binding_flags_info.pBindingFlags = binding_flags.data();
+        layout_info.pNext = &binding_flags_info;
+        layout_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    }
+
     VkDescriptorSetLayout descriptor_set_layout;
     auto result =
         vkCreateDescriptorSetLayout(
@@ -524,7 +567,7 @@ std::shared_ptr<RenderPass> VulkanDevice::createRenderPass(
 
     auto vk_render_pass =
         std::make_shared<VulkanRenderPass>(render_pass);
-    render_pass_list_.push_back(vk_render_pass);
+    vk_render_pass->setHandle(render_pass_pool_.add(render_pass));
 
     return vk_render_pass;
 }
@@ -561,6 +604,8 @@ DescriptorSetList VulkanDevice::createDescriptorSets(
     for (uint32_t i = 0; i < buffer_count; i++) {
         auto vk_desc_set = std::make_shared<VulkanDescriptorSet>();
         vk_desc_set->set(vk_desc_sets[i]);
+        vk_desc_set->setHandle(descriptor_set_pool_.add(vk_desc_sets[i]));
+        vk_descriptor_pool->getDescSetHandles().push_back(vk_desc_set->getHandle());
         desc_sets[i] = vk_desc_set;
     }
 
@@ -611,7 +656,7 @@ std::shared_ptr<PipelineLayout> VulkanDevice::createPipelineLayout(
 
     auto vk_pipeline_layout =
         std::make_shared<VulkanPipelineLayout>(pipeline_layout);
-    pipeline_layout_list_.push_back(vk_pipeline_layout);
+    vk_pipeline_layout->setHandle(pipeline_layout_pool_.add(pipeline_layout));
 
     return vk_pipeline_layout;
 }
@@ -686,7 +731,7 @@ std::shared_ptr<Pipeline> VulkanDevice::createPipeline(
 
     auto vk_pipeline =
         std::make_shared<VulkanPipeline>(graphics_pipeline);
-    pipeline_list_.push_back(vk_pipeline);
+    vk_pipeline->setHandle(pipeline_pool_.add(graphics_pipeline));
 
     return vk_pipeline;
 }
@@ -725,7 +770,7 @@ std::shared_ptr<Pipeline> VulkanDevice::createPipeline(
 
     auto vk_pipeline =
         std::make_shared<VulkanPipeline>(compute_pipeline);
-    pipeline_list_.push_back(vk_pipeline);
+    vk_pipeline->setHandle(pipeline_pool_.add(compute_pipeline));
 
     return vk_pipeline;
 }
@@ -770,7 +815,7 @@ std::shared_ptr<Pipeline> VulkanDevice::createPipeline(
 
     auto vk_pipeline =
         std::make_shared<VulkanPipeline>(rt_pipeline);
-    pipeline_list_.push_back(vk_pipeline);
+    vk_pipeline->setHandle(pipeline_pool_.add(rt_pipeline));
 
     return vk_pipeline;
 }
@@ -784,7 +829,8 @@ std::shared_ptr<Swapchain> VulkanDevice::createSwapchain(
     const SurfaceTransformFlagBits& transform,
     const PresentMode& present_mode,
     const ImageUsageFlags& usage,
-    const std::vector<uint32_t>& queue_index) {
+    const std::vector<uint32_t>& queue_index,
+    const std::shared_ptr<Swapchain>& old_swapchain/* = nullptr*/) {
 
     auto vk_surface = RENDER_TYPE_CAST(Surface, surface);
 
@@ -806,7 +852,9 @@ std::shared_ptr<Swapchain> VulkanDevice::createSwapchain(
     create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     create_info.presentMode = helper::toVkPresentMode(present_mode);
     create_info.clipped = VK_TRUE;
-    create_info.oldSwapchain = VK_NULL_HANDLE; //need to be handled when resize.
+    // the old swapchain is only retired by now, presentation can hand its images over.
+    auto vk_old_swapchain = RENDER_TYPE_CAST(Swapchain, old_swapchain);
+    create_info.oldSwapchain = vk_old_swapchain ? vk_old_swapchain->get() : VK_NULL_HANDLE;
 
     VkSwapchainKHR swap_chain;
     auto result =
@@ -865,12 +913,13 @@ std::shared_ptr<Framebuffer> VulkanDevice::createFrameBuffer(
 
     auto vk_frame_buffer =
         std::make_shared<VulkanFramebuffer>(frame_buffer);
-    framebuffer_list_.push_back(vk_frame_buffer);
+    vk_frame_buffer->setHandle(framebuffer_pool_.add(frame_buffer));
 
     return vk_frame_buffer;
 }
 
-std::shared_ptr<DescriptorPool> VulkanDevice::createDescriptorPool() {
+std::shared_ptr<DescriptorPool> VulkanDevice::createDescriptorPool(
+    bool free_descriptor_sets/* = true*/) {
     VkDescriptorPoolSize pool_sizes[] =
     {
         { VK_DESCRIPTOR_TYPE_SAMPLER, 16 },
@@ -888,7 +937,7 @@ std::shared_ptr<DescriptorPool> VulkanDevice::createDescriptorPool() {
     };
     VkDescriptorPoolCreateInfo pool_info = {};
     pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    pool_info.flags = free_descriptor_sets ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
     pool_info.maxSets = 256 * IM_ARRAYSIZE(pool_sizes);
     pool_info.poolSizeCount = (uint32_t)IM_ARRAYSIZE(pool_sizes);
     pool_info.pPoolSizes = pool_sizes;
@@ -913,15 +962,72 @@ std::shared_ptr<DescriptorPool> VulkanDevice::createDescriptorPool() {
     return vk_descriptor_pool;
 }
 
+std::shared_ptr<DescriptorPool> VulkanDevice::createBindlessDescriptorPool(
+    const std::vector<DescriptorSetLayoutBinding>& bindings) {
+    std::vector<VkDescriptorPoolSize> pool_sizes(bindings.size());
+    for (auto i = 0; i < bindings.size(); i++) {
+        pool_sizes[i].type = helper::toVkDescriptorType(bindings[i].descriptor_type);
+        pool_sizes[i].descriptorCount = bindings[i].descriptor_count;
+    }
+
+    VkDescriptorPoolCreateInfo pool_info = {};
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    pool_info.maxSets = 1;
+    pool_info.poolSizeCount = static_cast<uint32_t>(pool_sizes.size());
+    pool_info.pPoolSizes = pool_sizes.data();
+
+    VkDescriptorPool descriptor_pool;
+    auto result =
+        vkCreateDescriptorPool(
+            device_,
+            &pool_info,
+            nullptr,
+            &descriptor_pool);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(
+            std::string("failed to create bindless descriptor pool! : ") +
+            VkResultToString(result));
+    }
+
+    auto vk_descriptor_pool =
+        std::make_shared<VulkanDescriptorPool>();
+    vk_descriptor_pool->set(descriptor_pool);
+    return vk_descriptor_pool;
+}
+
+void VulkanDevice::resetDescriptorPool(
+    const std::shared_ptr<DescriptorPool>& descriptor_pool) {
+    auto vk_descriptor_pool = RENDER_TYPE_CAST(DescriptorPool, descriptor_pool);
+    if (vk_descriptor_pool) {
+        vkResetDescriptorPool(device_, vk_descriptor_pool->get(), 0);
+        releaseDescriptorSetHandles(*vk_descriptor_pool);
+    }
+}
+
 void VulkanDevice::updateDescriptorSets(
     const WriteDescriptorList& write_descriptors) {
+    // reserved up front, the writes point into these arrays.
     std::vector<VkWriteDescriptorSet> descriptor_writes;
-    std::vector<std::shared_ptr<VkDescriptorImageInfo>> desc_images;
-    std::vector<std::shared_ptr<VkDescriptorBufferInfo>> desc_buffers;
-    std::vector<std::unique_ptr<VkAccelerationStructureKHR[]>> desc_ases;
+    std::vector<VkDescriptorImageInfo> desc_images;
+    std::vector<VkDescriptorBufferInfo> desc_buffers;
+    std::vector<VkWriteDescriptorSetAccelerationStructureKHR> desc_as_infos;
+    std::vector<VkAccelerationStructureKHR> desc_ases;
+    descriptor_writes.reserve(write_descriptors.size());
+    desc_images.reserve(write_descriptors.size());
+    desc_buffers.reserve(write_descriptors.size());
+    desc_as_infos.reserve(write_descriptors.size());
+
+    size_t num_ases = 0;
+    for (const auto& src_write_desc : write_descriptors) {
+        if (src_write_desc->desc_type == DescriptorType::ACCELERATION_STRUCTURE_KHR) {
+            num_ases += static_cast<const AccelerationStructDescriptor*>(src_write_desc.get())->acc_structs.size();
+        }
+    }
+    desc_ases.reserve(num_ases);
 
-    for (auto i = 0; i < write_descriptors.size(); i++) {
-        const auto src_write_desc = write_descriptors[i];
+    for (const auto& src_write_desc : write_descriptors) {
         bool is_texture =
             src_write_desc->desc_type == DescriptorType::SAMPLER ||
             src_write_desc->desc_type == DescriptorType::COMBINED_IMAGE_SAMPLER ||
@@ -935,63 +1041,60 @@ void VulkanDevice::updateDescriptorSets(
             src_write_desc->desc_type == DescriptorType::UNIFORM_BUFFER_DYNAMIC ||
             src_write_desc->desc_type == DescriptorType::STORAGE_BUFFER_DYNAMIC;
          
-        auto vk_desc_set = RENDER_TYPE_CAST(DescriptorSet, src_write_desc->desc_set);
+        auto vk_desc_set = static_cast<VulkanDescriptorSet*>(src_write_desc->desc_set.get());
         if (is_texture) {
             const auto src_tex_desc = static_cast<const TextureDescriptor*>(src_write_desc.get());
-            auto vk_texture = RENDER_TYPE_CAST(ImageView, src_tex_desc->texture);
-            
-            auto desc_image = std::make_shared<VkDescriptorImageInfo>();
-            desc_images.push_back(desc_image);
-            desc_image->imageLayout = helper::toVkImageLayout(src_tex_desc->image_layout);
-            desc_image->imageView = vk_texture->get();
+            auto vk_texture = static_cast<VulkanImageView*>(src_tex_desc->texture.get());
+
+            auto& desc_image = desc_images.emplace_back();
+            desc_image.imageLayout = helper::toVkImageLayout(src_tex_desc->image_layout);
+            desc_image.imageView = vk_texture->get();
             if (src_tex_desc->sampler) {
-                desc_image->sampler = RENDER_TYPE_CAST(Sampler, src_tex_desc->sampler)->get();
+                desc_image.sampler = static_cast<VulkanSampler*>(src_tex_desc->sampler.get())->get();
             }
             else {
-                desc_image->sampler = nullptr;
+                desc_image.sampler = nullptr;
             }
 
             descriptor_writes.push_back(
                 helper::addDescriptWrite(
                     vk_desc_set->get(),
-                    desc_image.get(),
+                    &desc_image,
                     src_tex_desc->binding,
                     helper::toVkDescriptorType(src_tex_desc->desc_type)));
+            descriptor_writes.back().dstArrayElement = src_tex_desc->array_element;
         }
         else if (is_buffer) {
             const auto src_buf_desc = static_cast<const BufferDescriptor*>(src_write_desc.get());
-            auto vk_buffer = RENDER_TYPE_CAST(Buffer, src_buf_desc->buffer);
-            auto desc_buffer = std::make_shared<VkDescriptorBufferInfo>();
-            desc_buffers.push_back(desc_buffer);
-            desc_buffer->buffer = vk_buffer->get();
-            desc_buffer->offset = src_buf_desc->offset;
-            desc_buffer->range = src_buf_desc->range;
+            auto vk_buffer = static_cast<VulkanBuffer*>(src_buf_desc->buffer.get());
+            auto& desc_buffer = desc_buffers.emplace_back();
+            desc_buffer.buffer = vk_buffer->get();
+            desc_buffer.offset = src_buf_desc->offset;
+            desc_buffer.range = src_buf_desc->range;
 
             VkWriteDescriptorSet descriptor_write = {};
             descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptor_write.dstSet = vk_desc_set->get();
             descriptor_write.dstBinding = src_buf_desc->binding;
-            descriptor_write.dstArrayElement = 0;
+            descriptor_write.dstArrayElement = src_buf_desc->array_element;
 
             descriptor_write.descriptorType = helper::toVkDescriptorType(src_buf_desc->desc_type);
             descriptor_write.descriptorCount = 1;
-            descriptor_write.pBufferInfo = desc_buffer.get();
+            descriptor_write.pBufferInfo = &desc_buffer;
             descriptor_writes.push_back(descriptor_write);
         }
         else if (src_write_desc->desc_type == DescriptorType::ACCELERATION_STRUCTURE_KHR) {
             const auto src_as_desc = static_cast<const AccelerationStructDescriptor*>(src_write_desc.get());
-            auto desc_buffer = std::make_shared<VkDescriptorBufferInfo>();
 
             auto num_as = static_cast<uint32_t>(src_as_desc->acc_structs.size());
-            auto as_list = std::make_unique<VkAccelerationStructureKHR[]>(num_as);
+            auto as_start = desc_ases.size();
             for (size_t i = 0; i < num_as; i++) {
-                as_list[i] = reinterpret_cast<VkAccelerationStructureKHR>(src_as_desc->acc_structs[i]);
+                desc_ases.push_back(reinterpret_cast<VkAccelerationStructureKHR>(src_as_desc->acc_structs[i]));
             }
-            desc_ases.push_back(std::move(as_list));
-            VkWriteDescriptorSetAccelerationStructureKHR desc_as_info{};
+            auto& desc_as_info = desc_as_infos.emplace_back();
             desc_as_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
             desc_as_info.accelerationStructureCount = num_as;
-            desc_as_info.pAccelerationStructures = desc_ases[desc_ases.size()-1].get();
+            desc_as_info.pAccelerationStructures = desc_ases.data() + as_start;
 
             VkWriteDescriptorSet descriptor_write = {};
             descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
@@ -1016,6 +1119,100 @@ void VulkanDevice::updateDescriptorSets(
         nullptr);
 }
 
+std::shared_ptr<DescriptorUpdateTemplate> VulkanDevice::createDescriptorUpdateTemplate(
+    const std::shared_ptr<DescriptorSetLayout>& descriptor_set_layout,
+    const std::vector<DescriptorSetLayoutBinding>& bindings) {
+    auto vk_descriptor_set_layout = RENDER_TYPE_CAST(DescriptorSetLayout, descriptor_set_layout);
+
+    std::vector<VkDescriptorUpdateTemplateEntry> entries(bindings.size());
+    std::vector<VkDescriptorType> descriptor_types;
+    for (auto i = 0; i < bindings.size(); i++) {
+        auto desc_type = helper::toVkDescriptorType(bindings[i].descriptor_type);
+        // acceleration structures have no place in DescriptorInfo.
+        assert(desc_type != VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
+        entries[i].dstBinding = bindings[i].binding;
+        entries[i].dstArrayElement = 0;
+        entries[i].descriptorCount = bindings[i].descriptor_count;
+        entries[i].descriptorType = desc_type;
+        entries[i].offset = descriptor_types.size() * sizeof(VulkanDescriptorData);
+        entries[i].stride = sizeof(VulkanDescriptorData);
+        descriptor_types.insert(descriptor_types.end(), bindings[i].descriptor_count, desc_type);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo template_info{};
+    template_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    template_info.descriptorUpdateEntryCount = static_cast<uint32_t>(entries.size());
+    template_info.pDescriptorUpdateEntries = entries.data();
+    template_info.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    template_info.descriptorSetLayout = vk_descriptor_set_layout->get();
+
+    VkDescriptorUpdateTemplate update_template;
+    auto result =
+        vkCreateDescriptorUpdateTemplate(
+            device_,
+            &template_info,
+            nullptr,
+            &update_template);
+
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(
+            std::string("failed to create descriptor update template! : ") +
+            VkResultToString(result));
+    }
+
+    return std::make_shared<VulkanDescriptorUpdateTemplate>(
+        update_template,
+        std::move(descriptor_types));
+}
+
+void VulkanDevice::updateDescriptorSet(
+    const std::shared_ptr<DescriptorSet>& desc_set,
+    const std::shared_ptr<DescriptorUpdateTemplate>& update_template,
+    std::span<const DescriptorInfo> descriptors) {
+    auto vk_desc_set = static_cast<VulkanDescriptorSet*>(desc_set.get());
+    auto vk_update_template = static_cast<VulkanDescriptorUpdateTemplate*>(update_template.get());
+    const auto& descriptor_types = vk_update_template->getDescriptorTypes();
+    assert(descriptors.size() == descriptor_types.size());
+
+    // the usual layouts fit on the stack, only really big ones go to the heap.
+    const size_t kMaxStackDescriptors = 32;
+    VulkanDescriptorData stack_data[kMaxStackDescriptors];
+    std::vector<VulkanDescriptorData> heap_data;
+    VulkanDescriptorData* data = stack_data;
+    if (descriptors.size() > kMaxStackDescriptors) {
+        heap_data.resize(descriptors.size());
+        data = heap_data.data();
+    }
+
+    for (size_t i = 0; i < descriptors.size(); i++) {
+        const auto& src = descriptors[i];
+        switch (descriptor_types[i]) {
+        case VK_DESCRIPTOR_TYPE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+            data[i].image.sampler =
+                src.sampler ? static_cast<VulkanSampler*>(src.sampler)->get() : VK_NULL_HANDLE;
+            data[i].image.imageView =
+                src.texture ? static_cast<VulkanImageView*>(src.texture)->get() : VK_NULL_HANDLE;
+            data[i].image.imageLayout = helper::toVkImageLayout(src.image_layout);
+            break;
+        default:
+            data[i].buffer.buffer = static_cast<VulkanBuffer*>(src.buffer)->get();
+            data[i].buffer.offset = src.offset;
+            data[i].buffer.range = src.range;
+            break;
+        }
+    }
+
+    vkUpdateDescriptorSetWithTemplate(
+        device_,
+        vk_desc_set->get(),
+        vk_update_template->get(),
+        data);
+}
+
 void VulkanDevice::updateBufferMemory(
     const std::shared_ptr<DeviceMemory>& memory,
     uint64_t size,
@@ -1180,6 +1377,7 @@ std::vector<std::shared_ptr<CommandBuffer>> VulkanDevice::allocateCommandBuffers
     for (uint32_t i = 0; i < num_buffers; i++) {
         auto cmd_buf = std::make_shared<VulkanCommandBuffer>();
         cmd_buf->set(cmd_bufs[i]);
+        cmd_buf->setDevice(this);
         result[i] = cmd_buf;
     }
 
@@ -1206,150 +1404,133 @@ void VulkanDevice::unmapMemory(std::shared_ptr<DeviceMemory> memory) {
 void VulkanDevice::destroyCommandPool(std::shared_ptr<CommandPool> cmd_pool) {
     auto vk_cmd_pool = RENDER_TYPE_CAST(CommandPool, cmd_pool);
     if (vk_cmd_pool) {
-        vkDestroyCommandPool(device_, vk_cmd_pool->get(), nullptr);
+        retireObject(VK_OBJECT_TYPE_COMMAND_POOL, (uint64_t)vk_cmd_pool->get());
+    }
+}
+
+void VulkanDevice::resetCommandPool(std::shared_ptr<CommandPool> cmd_pool) {
+    auto vk_cmd_pool = RENDER_TYPE_CAST(CommandPool, cmd_pool);
+    if (vk_cmd_pool) {
+        vkResetCommandPool(device_, vk_cmd_pool->get(), 0);
     }
 }
 
 void VulkanDevice::destroySwapchain(std::shared_ptr<Swapchain> swapchain) {
     auto vk_swapchain = RENDER_TYPE_CAST(Swapchain, swapchain);
     if (vk_swapchain) {
-        vkDestroySwapchainKHR(device_, vk_swapchain->get(), nullptr);
+        retireObject(VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)vk_swapchain->get());
     }
 }
 
 void VulkanDevice::destroyDescriptorPool(std::shared_ptr<DescriptorPool> descriptor_pool) {
     auto vk_descriptor_pool = RENDER_TYPE_CAST(DescriptorPool, descriptor_pool);
     if (vk_descriptor_pool) {
-        vkDestroyDescriptorPool(device_, vk_descriptor_pool->get(), nullptr);
+        retireObject(VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)vk_descriptor_pool->get());
+        releaseDescriptorSetHandles(*vk_descriptor_pool);
     }
 }
 
 void VulkanDevice::destroyPipeline(std::shared_ptr<Pipeline> pipeline) {
-    auto result = std::find(pipeline_list_.begin(), pipeline_list_.end(), pipeline);
-    if (result != pipeline_list_.end()) {
-        auto vk_pipeline = RENDER_TYPE_CAST(Pipeline, pipeline);
-        if (vk_pipeline) {
-            vkDestroyPipeline(device_, vk_pipeline->get(), nullptr);
-        }
-        pipeline_list_.erase(result);
+    auto vk_pipeline = pipeline ? pipeline_pool_.get(pipeline->getHandle()) : nullptr;
+    if (vk_pipeline) {
+        retireObject(VK_OBJECT_TYPE_PIPELINE, (uint64_t)*vk_pipeline);
+        pipeline_pool_.remove(pipeline->getHandle());
     }
 }
 
 void VulkanDevice::destroyPipelineLayout(std::shared_ptr<PipelineLayout> pipeline_layout) {
-    auto result = std::find(pipeline_layout_list_.begin(), pipeline_layout_list_.end(), pipeline_layout);
-    if (result != pipeline_layout_list_.end()) {
-        auto vk_pipeline_layout = RENDER_TYPE_CAST(PipelineLayout, pipeline_layout);
-        if (vk_pipeline_layout) {
-            vkDestroyPipelineLayout(device_, vk_pipeline_layout->get(), nullptr);
-        }
-        pipeline_layout_list_.erase(result);
+    auto vk_pipeline_layout = pipeline_layout ? pipeline_layout_pool_.get(pipeline_layout->getHandle()) : nullptr;
+    if (vk_pipeline_layout) {
+        retireObject(VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)*vk_pipeline_layout);
+        pipeline_layout_pool_.remove(pipeline_layout->getHandle());
     }
 }
 
 void VulkanDevice::destroyRenderPass(std::shared_ptr<RenderPass> render_pass) {
-    auto result = std::find(render_pass_list_.begin(), render_pass_list_.end(), render_pass);
-    if (result != render_pass_list_.end()) {
-        auto vk_render_pass = RENDER_TYPE_CAST(RenderPass, render_pass);
-        if (vk_render_pass) {
-            vkDestroyRenderPass(device_, vk_render_pass->get(), nullptr);
-        }
-        render_pass_list_.erase(result);
+    auto vk_render_pass = render_pass ? render_pass_pool_.get(render_pass->getHandle()) : nullptr;
+    if (vk_render_pass) {
+        retireObject(VK_OBJECT_TYPE_RENDER_PASS, (uint64_t)*vk_render_pass);
+        render_pass_pool_.remove(render_pass->getHandle());
     }
 }
 
 void VulkanDevice::destroyFramebuffer(std::shared_ptr<Framebuffer> frame_buffer) {
-    auto result = std::find(framebuffer_list_.begin(), framebuffer_list_.end(), frame_buffer);
-    if (result != framebuffer_list_.end()) {
-        auto vk_framebuffer = RENDER_TYPE_CAST(Framebuffer, frame_buffer);
-        if (vk_framebuffer) {
-            vkDestroyFramebuffer(device_, vk_framebuffer->get(), nullptr);
-        }
-        framebuffer_list_.erase(result);
+    auto vk_frame_buffer = frame_buffer ? framebuffer_pool_.get(frame_buffer->getHandle()) : nullptr;
+    if (vk_frame_buffer) {
+        retireObject(VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)*vk_frame_buffer);
+        framebuffer_pool_.remove(frame_buffer->getHandle());
     }
 }
 
 void VulkanDevice::destroyImageView(std::shared_ptr<ImageView> image_view) {
-    auto result = std::find(image_view_list_.begin(), image_view_list_.end(), image_view);
-    if (result != image_view_list_.end()) {
-        auto vk_image_view = RENDER_TYPE_CAST(ImageView, image_view);
-        if (vk_image_view) {
-            vkDestroyImageView(device_, vk_image_view->get(), nullptr);
-        }
-        image_view_list_.erase(result);
+    auto vk_image_view = image_view ? image_view_pool_.get(image_view->getHandle()) : nullptr;
+    if (vk_image_view) {
+        retireObject(VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)*vk_image_view);
+        image_view_pool_.remove(image_view->getHandle());
     }
 }
 
 void VulkanDevice::destroySampler(std::shared_ptr<Sampler> sampler) {
-    auto result = std::find(sampler_list_.begin(), sampler_list_.end(), sampler);
-    if (result != sampler_list_.end()) {
-        auto vk_sampler = RENDER_TYPE_CAST(Sampler, sampler);
-        if (vk_sampler) {
-            vkDestroySampler(device_, vk_sampler->get(), nullptr);
-        }
-        sampler_list_.erase(result);
+    auto vk_sampler = sampler ? sampler_pool_.get(sampler->getHandle()) : nullptr;
+    if (vk_sampler) {
+        retireObject(VK_OBJECT_TYPE_SAMPLER, (uint64_t)*vk_sampler);
+        sampler_pool_.remove(sampler->getHandle());
     }
 }
 
 void VulkanDevice::destroyImage(std::shared_ptr<Image> image) {
-    auto result = std::find(image_list_.begin(), image_list_.end(), image);
-    if (result != image_list_.end()) {
-        auto vk_image = RENDER_TYPE_CAST(Image, image);
-        if (vk_image) {
-            vkDestroyImage(device_, vk_image->get(), nullptr);
-        }
-        image_list_.erase(result);
+    auto vk_image = image ? image_pool_.get(image->getHandle()) : nullptr;
+    if (vk_image) {
+        retireObject(VK_OBJECT_TYPE_IMAGE, (uint64_t)*vk_image);
+        image_pool_.remove(image->getHandle());
     }
 }
 
 void VulkanDevice::destroyBuffer(std::shared_ptr<Buffer> buffer) {
-    auto result = std::find(buffer_list_.begin(), buffer_list_.end(), buffer);
-    if (result != buffer_list_.end()) {
-        auto vk_buffer = RENDER_TYPE_CAST(Buffer, buffer);
-        if (vk_buffer) {
-            vkDestroyBuffer(device_, vk_buffer->get(), nullptr);
-        }
-        buffer_list_.erase(result);
+    auto vk_buffer = buffer ? buffer_pool_.get(buffer->getHandle()) : nullptr;
+    if (vk_buffer) {
+        retireObject(VK_OBJECT_TYPE_BUFFER, (uint64_t)*vk_buffer);
+        buffer_pool_.remove(buffer->getHandle());
     }
 }
 
 void VulkanDevice::destroySemaphore(std::shared_ptr<Semaphore> semaphore) {
-    auto result = std::find(semaphore_list_.begin(), semaphore_list_.end(), semaphore);
-    if (result != semaphore_list_.end()) {
-        auto vk_semaphore = RENDER_TYPE_CAST(Semaphore, semaphore);
-        if (vk_semaphore) {
-            vkDestroySemaphore(device_, vk_semaphore->get(), nullptr);
-        }
-        semaphore_list_.erase(result);
+    auto vk_semaphore = semaphore ? semaphore_pool_.get(semaphore->getHandle()) : nullptr;
+    if (vk_semaphore) {
+        retireObject(VK_OBJECT_TYPE_SEMAPHORE, (uint64_t)*vk_semaphore);
+        semaphore_pool_.remove(semaphore->getHandle());
     }
 }
 
 void VulkanDevice::destroyFence(std::shared_ptr<Fence> fence) {
-    auto result = std::find(fence_list_.begin(), fence_list_.end(), fence);
-    if (result != fence_list_.end()) {
-        auto vk_fence = RENDER_TYPE_CAST(Fence, fence);
-        if (vk_fence) {
-            vkDestroyFence(device_, vk_fence->get(), nullptr);
-        }
-        fence_list_.erase(result);
+    auto vk_fence = fence ? fence_pool_.get(fence->getHandle()) : nullptr;
+    if (vk_fence) {
+        retireObject(VK_OBJECT_TYPE_FENCE, (uint64_t)*vk_fence);
+        fence_pool_.remove(fence->getHandle());
     }
 }
 
 void VulkanDevice::destroyDescriptorSetLayout(std::shared_ptr<DescriptorSetLayout> layout) {
     auto vk_layout = RENDER_TYPE_CAST(DescriptorSetLayout, layout);
     if (vk_layout) {
-        vkDestroyDescriptorSetLayout(device_, vk_layout->get(), nullptr);
+        retireObject(VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)vk_layout->get());
+    }
+}
+
+void VulkanDevice::destroyDescriptorUpdateTemplate(
+    std::shared_ptr<DescriptorUpdateTemplate> update_template) {
+    auto vk_update_template = RENDER_TYPE_CAST(DescriptorUpdateTemplate, update_template);
+    if (vk_update_template) {
+        retireObject(VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE, (uint64_t)vk_update_template->get());
     }
 }
 
 void VulkanDevice::destroyShaderModule(
     std::shared_ptr<ShaderModule> shader_module) {
-    auto result = std::find(shader_list_.begin(), shader_list_.end(), shader_module);
-    if (result != shader_list_.end()) {
-        auto vk_shader_module = RENDER_TYPE_CAST(ShaderModule, shader_module);
-        if (vk_shader_module) {
-            vkDestroyShaderModule(device_, vk_shader_module->get(), nullptr);
-        }
-        shader_list_.erase(result);
+    auto vk_shader_module = shader_module ? shader_pool_.get(shader_module->getHandle()) : nullptr;
+    if (vk_shader_module) {
+        retireObject(VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)*vk_shader_module);
+        shader_pool_.remove(shader_module->getHandle());
     }
 }
 
@@ -1363,26 +1544,29 @@ void VulkanDevice::destroy() {
 
     destroyFence(transient_fence_);
 
+    // whatever is still retired goes now, the device has to be idle at this point.
+    releaseRetiredObjects(UINT64_MAX);
+
     vkDestroyDevice(device_, nullptr);
 }
 
 void VulkanDevice::freeMemory(std::shared_ptr<DeviceMemory> memory) {
     auto vk_memory = RENDER_TYPE_CAST(DeviceMemory, memory);
     if (vk_memory) {
-        vkFreeMemory(device_, vk_memory->get(), nullptr);
+        retireObject(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)vk_memory->get());
     }
 }
 
 void VulkanDevice::freeCommandBuffers(std::shared_ptr<CommandPool> cmd_pool, const std::vector<std::shared_ptr<CommandBuffer>>& cmd_bufs) {
     auto vk_cmd_pool = RENDER_TYPE_CAST(CommandPool, cmd_pool);
     if (vk_cmd_pool) {
-        std::vector<VkCommandBuffer> vk_cmd_bufs(cmd_bufs.size());
-        for (uint32_t i = 0; i < cmd_bufs.size(); i++) {
-            auto vk_cmd_buf = RENDER_TYPE_CAST(CommandBuffer, cmd_bufs[i]);
-            vk_cmd_bufs[i] = vk_cmd_buf->get();
+        for (const auto& cmd_buf : cmd_bufs) {
+            auto vk_cmd_buf = RENDER_TYPE_CAST(CommandBuffer, cmd_buf);
+            retireObject(
+                VK_OBJECT_TYPE_COMMAND_BUFFER,
+                (uint64_t)vk_cmd_buf->get(),
+                (uint64_t)vk_cmd_pool->get());
         }
-
-        vkFreeCommandBuffers(device_, vk_cmd_pool->get(), static_cast<uint32_t>(vk_cmd_bufs.size()), vk_cmd_bufs.data());
     }
 }
 
@@ -1467,6 +1651,93 @@ void VulkanDevice::waitIdle() {
             std::string("wait for device idle error : ") +
             VkResultToString(result));
     }
+
+    releaseRetiredObjects(UINT64_MAX);
+}
+
+void VulkanDevice::beginFrame(uint64_t frame_index) {
+    frame_index_ = frame_index;
+    is_frame_started_ = true;
+}
+
+void VulkanDevice::releaseRetiredObjects(uint64_t completed_frame_index) {
+    // objects are retired in frame order, so the finished ones sit at the front.
+    while (!retired_objects_.empty() &&
+           retired_objects_.front().frame_index <= completed_frame_index) {
+        releaseObject(retired_objects_.front());
+        retired_objects_.pop_front();
+    }
+}
+
+void VulkanDevice::retireObject(
+    VkObjectType type,
+    uint64_t object,
+    uint64_t parent/* = 0*/) {
+    retired_objects_.push_back({ frame_index_, type, object, parent });
+}
+
+void VulkanDevice::releaseObject(const RetiredObject& retired) {
+    switch (retired.type) {
+    case VK_OBJECT_TYPE_COMMAND_BUFFER: {
+        auto cmd_buf = (VkCommandBuffer)retired.object;
+        vkFreeCommandBuffers(device_, (VkCommandPool)retired.parent, 1, &cmd_buf);
+        break;
+    }
+    case VK_OBJECT_TYPE_COMMAND_POOL:
+        vkDestroyCommandPool(device_, (VkCommandPool)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+        vkDestroySwapchainKHR(device_, (VkSwapchainKHR)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+        vkDestroyDescriptorPool(device_, (VkDescriptorPool)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE:
+        vkDestroyPipeline(device_, (VkPipeline)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+        vkDestroyPipelineLayout(device_, (VkPipelineLayout)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_RENDER_PASS:
+        vkDestroyRenderPass(device_, (VkRenderPass)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_FRAMEBUFFER:
+        vkDestroyFramebuffer(device_, (VkFramebuffer)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+        vkDestroyImageView(device_, (VkImageView)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_SAMPLER:
+        vkDestroySampler(device_, (VkSampler)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_IMAGE:
+        vkDestroyImage(device_, (VkImage)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_BUFFER:
+        vkDestroyBuffer(device_, (VkBuffer)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_SEMAPHORE:
+        vkDestroySemaphore(device_, (VkSemaphore)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_FENCE:
+        vkDestroyFence(device_, (VkFence)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+        vkDestroyDescriptorSetLayout(device_, (VkDescriptorSetLayout)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_UPDATE_TEMPLATE:
+        vkDestroyDescriptorUpdateTemplate(device_, (VkDescriptorUpdateTemplate)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_SHADER_MODULE:
+        vkDestroyShaderModule(device_, (VkShaderModule)retired.object, nullptr);
+        break;
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+        vkFreeMemory(device_, (VkDeviceMemory)retired.object, nullptr);
+        break;
+    default:
+        assert(0);
+        break;
+    }
 }
 
 void VulkanDevice::getAccelerationStructureBuildSizes(
@@ -1527,6 +1798,14 @@ DeviceAddress VulkanDevice::getAccelerationStructureDeviceAddress(const Accelera
     return result;
 }
 
+void VulkanDevice::releaseDescriptorSetHandles(VulkanDescriptorPool& descriptor_pool) {
+    auto& desc_set_handles = descriptor_pool.getDescSetHandles();
+    for (const auto& handle : desc_set_handles) {
+        descriptor_set_pool_.remove(handle);
+    }
+    desc_set_handles.clear();
+}
+
 void VulkanDevice::getRayTracingShaderGroupHandles(
     const std::shared_ptr<Pipeline>& pipeline,
     const uint32_t group_count,
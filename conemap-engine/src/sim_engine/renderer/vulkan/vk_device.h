@@ -1,5 +1,6 @@
 #pragma once
 
+#include <deque>
 #include <vulkan/vulkan.h>
 #include "../device.h"
 
@@ -9,6 +10,8 @@ namespace vk {
 
 const char* VkResultToString(VkResult result);
 
+class VulkanDescriptorPool;
+
 class VulkanDevice : public Device {
     VkDevice        device_;
     const std::shared_ptr<PhysicalDevice>& physical_device_;
@@ -16,17 +19,45 @@ class VulkanDevice : public Device {
     std::shared_ptr<CommandBuffer> transient_cmd_buffer_;
     std::shared_ptr<Queue> transient_compute_queue_;
     std::shared_ptr<Fence> transient_fence_;
-    std::vector<std::shared_ptr<Buffer>> buffer_list_;
-    std::vector<std::shared_ptr<Image>> image_list_;
-    std::vector<std::shared_ptr<ImageView>> image_view_list_;
-    std::vector<std::shared_ptr<Sampler>> sampler_list_;
-    std::vector<std::shared_ptr<ShaderModule>> shader_list_;
-    std::vector<std::shared_ptr<Framebuffer>> framebuffer_list_;
-    std::vector<std::shared_ptr<PipelineLayout>> pipeline_layout_list_;
-    std::vector<std::shared_ptr<Pipeline>> pipeline_list_;
-    std::vector<std::shared_ptr<RenderPass>> render_pass_list_;
-    std::vector<std::shared_ptr<Semaphore>> semaphore_list_;
-    std::vector<std::shared_ptr<Fence>> fence_list_;
+    uint64_t min_uniform_buffer_offset_alignment_ = 256;
+    uint64_t min_storage_buffer_offset_alignment_ = 256;
+    // raw vulkan objects of the live device objects, keyed by the handle the wrapper
+    // carries. destroy and command recording resolve handles through these.
+    HandlePool<VkBuffer, Buffer> buffer_pool_;
+    HandlePool<VkImage, Image> image_pool_;
+    HandlePool<VkImageView, ImageView> image_view_pool_;
+    HandlePool<VkSampler, Sampler> sampler_pool_;
+    HandlePool<VkShaderModule, ShaderModule> shader_pool_;
+    HandlePool<VkFramebuffer, Framebuffer> framebuffer_pool_;
+    HandlePool<VkPipelineLayout, PipelineLayout> pipeline_layout_pool_;
+    HandlePool<VkPipeline, Pipeline> pipeline_pool_;
+    HandlePool<VkRenderPass, RenderPass> render_pass_pool_;
+    HandlePool<VkSemaphore, Semaphore> semaphore_pool_;
+    HandlePool<VkFence, Fence> fence_pool_;
+    // sets die with their descriptor pool, reset and destroy of the pool drop them here.
+    HandlePool<VkDescriptorSet, DescriptorSet> descriptor_set_pool_;
+
+    // vulkan objects the destroy calls retired, kept alive until the gpu is past the
+    // frame they got retired in.
+    struct RetiredObject {
+        uint64_t frame_index;
+        VkObjectType type;
+        uint64_t object;
+        // command pool of a retired command buffer.
+        uint64_t parent;
+    };
+    std::deque<RetiredObject> retired_objects_;
+    uint64_t frame_index_ = 0;
+    // until the first beginFrame only the transient submits use the gpu, and those are
+    // waited for on the spot.
+    bool is_frame_started_ = false;
+
+    void retireObject(VkObjectType type, uint64_t object, uint64_t parent = 0);
+    std::shared_ptr<DescriptorSetLayout> createDescriptorSetLayout(
+        const std::vector<DescriptorSetLayoutBinding>& bindings,
+        bool is_bindless);
+    void releaseObject(const RetiredObject& retired);
+    void releaseDescriptorSetHandles(VulkanDescriptorPool& descriptor_pool);
 
 public:
     VulkanDevice(
@@ -41,7 +72,12 @@ public:
     virtual void submitAndWaitTransientCommandBuffer() final;
     const std::shared_ptr<PhysicalDevice>& getPhysicalDevice() {
         return physical_device_; }
-    virtual std::shared_ptr<DescriptorPool> createDescriptorPool() final;
+    virtual std::shared_ptr<DescriptorPool> createDescriptorPool(bool free_descriptor_sets = true) final;
+    virtual void resetDescriptorPool(const std::shared_ptr<DescriptorPool>& descriptor_pool) final;
+    virtual std::shared_ptr<DescriptorSetLayout> createBindlessDescriptorSetLayout(
+        const std::vector<DescriptorSetLayoutBinding>& bindings) final;
+    virtual std::shared_ptr<DescriptorPool> createBindlessDescriptorPool(
+        const std::vector<DescriptorSetLayoutBinding>& bindings) final;
     virtual void createBuffer(
         const uint64_t& buffer_size,
         const BufferUsageFlags& usage,
@@ -51,6 +87,13 @@ public:
         std::shared_ptr<DeviceMemory>& buffer_memory) final;
     virtual void updateDescriptorSets(
         const WriteDescriptorList& write_descriptors) final;
+    virtual std::shared_ptr<DescriptorUpdateTemplate> createDescriptorUpdateTemplate(
+        const std::shared_ptr<DescriptorSetLayout>& descriptor_set_layout,
+        const std::vector<DescriptorSetLayoutBinding>& bindings) final;
+    virtual void updateDescriptorSet(
+        const std::shared_ptr<DescriptorSet>& desc_set,
+        const std::shared_ptr<DescriptorUpdateTemplate>& update_template,
+        std::span<const DescriptorInfo> descriptors) final;
     virtual DescriptorSetList createDescriptorSets(
         std::shared_ptr<DescriptorPool> descriptor_pool,
         std::shared_ptr<DescriptorSetLayout> descriptor_set_layout,
@@ -90,7 +133,8 @@ public:
         const SurfaceTransformFlagBits& transform,
         const PresentMode& present_mode,
         const ImageUsageFlags& usage,
-        const std::vector<uint32_t>& queue_index) final;
+        const std::vector<uint32_t>& queue_index,
+        const std::shared_ptr<Swapchain>& old_swapchain = nullptr) final;
     virtual void updateBufferMemory(
         const std::shared_ptr<DeviceMemory>& memory,
         uint64_t size,
@@ -127,7 +171,7 @@ public:
     virtual std::shared_ptr<ShaderModule>
         createShaderModule(
             uint64_t size,
-            void* data,
+            const void* data,
             ShaderStageFlagBits shader_stage) final;
     virtual std::shared_ptr<ImageView>
         createImageView(
@@ -152,7 +196,12 @@ public:
     virtual std::vector<std::shared_ptr<CommandBuffer>> allocateCommandBuffers(std::shared_ptr<CommandPool> cmd_pool, uint32_t num_buffers, bool is_primary = true) final;
     virtual void* mapMemory(std::shared_ptr<DeviceMemory> memory, uint64_t size, uint64_t offset = 0) final;
     virtual void unmapMemory(std::shared_ptr<DeviceMemory> memory) final;
+    virtual uint64_t getMinUniformBufferOffsetAlignment() final {
+        return min_uniform_buffer_offset_alignment_; }
+    virtual uint64_t getMinStorageBufferOffsetAlignment() final {
+        return min_storage_buffer_offset_alignment_; }
     virtual void destroyCommandPool(std::shared_ptr<CommandPool> cmd_pool) final;
+    virtual void resetCommandPool(std::shared_ptr<CommandPool> cmd_pool) final;
     virtual void destroySwapchain(std::shared_ptr<Swapchain> swapchain) final;
     virtual void destroyDescriptorPool(std::shared_ptr<DescriptorPool> descriptor_pool) final;
     virtual void destroyPipeline(std::shared_ptr<Pipeline> pipeline) final;
@@ -166,6 +215,7 @@ public:
     virtual void destroySemaphore(std::shared_ptr<Semaphore> semaphore) final;
     virtual void destroyFence(std::shared_ptr<Fence> fence) final;
     virtual void destroyDescriptorSetLayout(std::shared_ptr<DescriptorSetLayout> layout) final;
+    virtual void destroyDescriptorUpdateTemplate(std::shared_ptr<DescriptorUpdateTemplate> update_template) final;
     virtual void destroyShaderModule(std::shared_ptr<ShaderModule> layout) final;
     virtual void destroy() final;
     virtual void freeMemory(std::shared_ptr<DeviceMemory> memory) final;
@@ -174,6 +224,8 @@ public:
     virtual void waitForFences(const std::vector<std::shared_ptr<Fence>>& fences) final;
     virtual void waitForSemaphores(const std::vector<std::shared_ptr<Semaphore>>& semaphores, uint64_t value) final;
     virtual void waitIdle() final;
+    virtual void beginFrame(uint64_t frame_index) final;
+    virtual void releaseRetiredObjects(uint64_t completed_frame_index) final;
     virtual void getAccelerationStructureBuildSizes(
         AccelerationStructureBuildType         as_build_type,
         const AccelerationStructureBuildGeometryInfo& build_info,
@@ -189,6 +241,36 @@ public:
         const uint32_t group_count,
         const uint32_t sbt_size,
         void* shader_handle_storage) final;
+
+    // stale handles resolve to VK_NULL_HANDLE.
+    VkBuffer getVkBuffer(const BufferHandle& handle) {
+        auto buffer = buffer_pool_.get(handle);
+        return buffer ? *buffer : VK_NULL_HANDLE;
+    }
+    VkImage getVkImage(const ImageHandle& handle) {
+        auto image = image_pool_.get(handle);
+        return image ? *image : VK_NULL_HANDLE;
+    }
+    VkImageView getVkImageView(const ImageViewHandle& handle) {
+        auto image_view = image_view_pool_.get(handle);
+        return image_view ? *image_view : VK_NULL_HANDLE;
+    }
+    VkSampler getVkSampler(const SamplerHandle& handle) {
+        auto sampler = sampler_pool_.get(handle);
+        return sampler ? *sampler : VK_NULL_HANDLE;
+    }
+    VkPipeline getVkPipeline(const PipelineHandle& handle) {
+        auto pipeline = pipeline_pool_.get(handle);
+        return pipeline ? *pipeline : VK_NULL_HANDLE;
+    }
+    VkPipelineLayout getVkPipelineLayout(const PipelineLayoutHandle& handle) {
+        auto pipeline_layout = pipeline_layout_pool_.get(handle);
+        return pipeline_layout ? *pipeline_layout : VK_NULL_HANDLE;
+    }
+    VkDescriptorSet getVkDescriptorSet(const DescriptorSetHandle& handle) {
+        auto desc_set = descriptor_set_pool_.get(handle);
+        return desc_set ? *desc_set : VK_NULL_HANDLE;
+    }
 };
 
 } // namespace vk
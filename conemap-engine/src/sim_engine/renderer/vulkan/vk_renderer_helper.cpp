@@ -1903,6 +1903,7 @@ std::shared_ptr<renderer::Device> createLogicalDevice(
     device_features.shaderInt16 = VK_TRUE;
     device_features.multiDrawIndirect = VK_TRUE;
     device_features.multiViewport = VK_TRUE;
+    device_features.fragmentStoresAndAtomics = VK_TRUE;
 
     VkDeviceCreateInfo create_info{};
     create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1928,6 +1929,7 @@ std::shared_ptr<renderer::Device> createLogicalDevice(
     VkPhysicalDeviceBufferDeviceAddressFeatures enabled_buffer_device_address_features{};
     VkPhysicalDeviceMaintenance4Features enabled_maintenance4_features{};
     VkPhysicalDeviceFloat16Int8FeaturesKHR enabled_float16_int8_features{};
+    VkPhysicalDeviceDescriptorIndexingFeatures enabled_descriptor_indexing_features{};
 
     // Enable features required for ray tracing using feature chaining via pNext		
     enabled_buffer_device_address_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
@@ -1942,11 +1944,22 @@ std::shared_ptr<renderer::Device> createLogicalDevice(
     enabled_float16_int8_features.shaderInt8 = VK_TRUE;
     enabled_float16_int8_features.pNext = &enabled_maintenance4_features;
 
+    // bindless texture table.
+    enabled_descriptor_indexing_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+    enabled_descriptor_indexing_features.runtimeDescriptorArray = VK_TRUE;
+    enabled_descriptor_indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+    enabled_descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    enabled_descriptor_indexing_features.descriptorBindingStorageImageUpdateAfterBind = VK_TRUE;
+    enabled_descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+    enabled_descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    enabled_descriptor_indexing_features.shaderStorageImageArrayNonUniformIndexing = VK_TRUE;
+    enabled_descriptor_indexing_features.pNext = &enabled_float16_int8_features;
+
     // If a pNext(Chain) has been passed, we need to add it to the device creation info
     VkPhysicalDeviceFeatures2 physical_device_features2{};
     physical_device_features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
     physical_device_features2.features = device_features;
-    physical_device_features2.pNext = &enabled_float16_int8_features;
+    physical_device_features2.pNext = &enabled_descriptor_indexing_features;
     create_info.pEnabledFeatures = nullptr;
     create_info.pNext = &physical_device_features2;
 
@@ -12,152 +12,60 @@ const glm::uvec2 g_cache_block_size =
         kPrtShadowGenBlockCacheSizeX,
         kPrtShadowGenBlockCacheSizeY);
 
-er::WriteDescriptorList addConemapGenInitTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const std::shared_ptr<er::ImageView>& src_image,
-    const std::shared_ptr<er::ImageView>& dst_image_0,
-    const std::shared_ptr<er::ImageView>& dst_image_1) {
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(3);
-
-    // height/depth map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::COMBINED_IMAGE_SAMPLER,
-        SRC_TEX_INDEX,
-        texture_sampler,
-        src_image,
-        er::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX,
-        nullptr,
-        dst_image_0,
-        er::ImageLayout::GENERAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX_1,
-        nullptr,
-        dst_image_1,
-        er::ImageLayout::GENERAL);
-
-    return descriptor_writes;
+std::vector<er::DescriptorSetLayoutBinding> getConemapGenInitBindings() {
+    return {
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::COMBINED_IMAGE_SAMPLER),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX_1,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE) };
 }
 
-er::WriteDescriptorList addConemapGenTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const std::shared_ptr<er::ImageView>& src_image,
-    const std::shared_ptr<er::ImageView>& minmax_depth_image,
-    const std::shared_ptr<er::ImageView>& dst_image_0,
-    const std::shared_ptr<er::ImageView>& dst_image_1) {
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(4);
-
-    // height/depth map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::COMBINED_IMAGE_SAMPLER,
-        SRC_TEX_INDEX,
-        texture_sampler,
-        src_image,
-        er::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
-
-    // minmax depth texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        SRC_INFO_TEX_INDEX,
-        nullptr,
-        minmax_depth_image,
-        er::ImageLayout::GENERAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX,
-        nullptr,
-        dst_image_0,
-        er::ImageLayout::GENERAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX_1,
-        nullptr,
-        dst_image_1,
-        er::ImageLayout::GENERAL);
-
-    return descriptor_writes;
+std::vector<er::DescriptorSetLayoutBinding> getConemapGenBindings() {
+    return {
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::COMBINED_IMAGE_SAMPLER),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_INFO_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX_1,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE) };
 }
 
-er::WriteDescriptorList addConemapPackTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const std::shared_ptr<er::ImageView>& src_image,
-    const std::shared_ptr<er::ImageView>& src_image_0,
-    const std::shared_ptr<er::ImageView>& src_image_1,
-    const std::shared_ptr<er::ImageView>& dst_image) {
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(4);
-
-    // height/depth map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::COMBINED_IMAGE_SAMPLER,
-        SRC_TEX_INDEX,
-        texture_sampler,
-        src_image,
-        er::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
-
-    // minmax depth texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        SRC_TEX_INDEX_1,
-        nullptr,
-        src_image_0,
-        er::ImageLayout::GENERAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        SRC_TEX_INDEX_2,
-        nullptr,
-        src_image_1,
-        er::ImageLayout::GENERAL);
-
-    // conemap/height map texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX,
-        nullptr,
-        dst_image,
-        er::ImageLayout::GENERAL);
-
-    return descriptor_writes;
+std::vector<er::DescriptorSetLayoutBinding> getConemapPackBindings() {
+    return {
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::COMBINED_IMAGE_SAMPLER),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX_1,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX_2,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE),
+        er::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE) };
 }
 
 std::shared_ptr<er::PipelineLayout>
@@ -207,105 +115,91 @@ Conemap::Conemap(
         SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
         renderer::ImageLayout::GENERAL);
 
+    // layouts and their update templates come from the same binding list, the
+    // descriptors below follow its order.
+    auto conemap_gen_init_bindings = getConemapGenInitBindings();
     conemap_gen_init_desc_set_layout_ =
-        device->createDescriptorSetLayout(
-            { renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::COMBINED_IMAGE_SAMPLER),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                DST_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                DST_TEX_INDEX_1,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE) });
+        device->createDescriptorSetLayout(conemap_gen_init_bindings);
+    conemap_gen_init_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            conemap_gen_init_desc_set_layout_,
+            conemap_gen_init_bindings);
 
+    auto conemap_gen_bindings = getConemapGenBindings();
     conemap_gen_desc_set_layout_ =
-        device->createDescriptorSetLayout(
-            { renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::COMBINED_IMAGE_SAMPLER),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_INFO_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                DST_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                DST_TEX_INDEX_1,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE) });
+        device->createDescriptorSetLayout(conemap_gen_bindings);
+    conemap_gen_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            conemap_gen_desc_set_layout_,
+            conemap_gen_bindings);
 
+    auto conemap_pack_bindings = getConemapPackBindings();
     conemap_pack_desc_set_layout_ =
-        device->createDescriptorSetLayout(
-            { renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::COMBINED_IMAGE_SAMPLER),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_TEX_INDEX_1,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                SRC_TEX_INDEX_2,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE),
-              renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
-                DST_TEX_INDEX,
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                er::DescriptorType::STORAGE_IMAGE) });
+        device->createDescriptorSetLayout(conemap_pack_bindings);
+    conemap_pack_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            conemap_pack_desc_set_layout_,
+            conemap_pack_bindings);
 
     conemap_gen_init_tex_desc_set_ =
         device->createDescriptorSets(
             descriptor_pool,
             conemap_gen_init_desc_set_layout_, 1)[0];
 
-    // create a global ibl texture descriptor set.
-    auto conemap_gen_init_texture_descs =
-        addConemapGenInitTextures(
-            conemap_gen_init_tex_desc_set_,
-            texture_sampler,
+    // height/depth map texture, conemap/height map textures.
+    const er::DescriptorInfo conemap_gen_init_descs[] = {
+        er::DescriptorInfo::fromTexture(
             bump_tex.view,
-            conemap_temp_tex_[0]->view,
-            conemap_temp_tex_[1]->view);
-    device->updateDescriptorSets(conemap_gen_init_texture_descs);
+            er::ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+            texture_sampler),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[0]->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[1]->view, er::ImageLayout::GENERAL) };
+    device->updateDescriptorSet(
+        conemap_gen_init_tex_desc_set_,
+        conemap_gen_init_update_template_,
+        conemap_gen_init_descs);
 
     conemap_gen_tex_desc_set_ =
         device->createDescriptorSets(
             descriptor_pool,
             conemap_gen_desc_set_layout_, 1)[0];
 
-    // create a global ibl texture descriptor set.
-    auto conemap_gen_texture_descs =
-        addConemapGenTextures(
-            conemap_gen_tex_desc_set_,
-            texture_sampler,
+    // height/depth map texture, minmax depth texture, conemap/height map textures.
+    const er::DescriptorInfo conemap_gen_descs[] = {
+        er::DescriptorInfo::fromTexture(
             bump_tex.view,
+            er::ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+            texture_sampler),
+        er::DescriptorInfo::fromTexture(
             conemap_obj->getMinmaxDepthTexture()->view,
-            conemap_temp_tex_[0]->view,
-            conemap_temp_tex_[1]->view);
-    device->updateDescriptorSets(conemap_gen_texture_descs);
+            er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[0]->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[1]->view, er::ImageLayout::GENERAL) };
+    device->updateDescriptorSet(
+        conemap_gen_tex_desc_set_,
+        conemap_gen_update_template_,
+        conemap_gen_descs);
 
     conemap_pack_tex_desc_set_ =
         device->createDescriptorSets(
             descriptor_pool,
             conemap_pack_desc_set_layout_, 1)[0];
 
-    // create a global ibl texture descriptor set.
-    auto conemap_pack_texture_descs =
-        addConemapPackTextures(
-            conemap_pack_tex_desc_set_,
-            texture_sampler,
+    // height/depth map texture, conemap/height map textures, packed conemap texture.
+    const er::DescriptorInfo conemap_pack_descs[] = {
+        er::DescriptorInfo::fromTexture(
             bump_tex.view,
-            conemap_temp_tex_[0]->view,
-            conemap_temp_tex_[1]->view,
-            conemap_obj->getConemapTexture()->view);
-    device->updateDescriptorSets(conemap_pack_texture_descs);
+            er::ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+            texture_sampler),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[0]->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(conemap_temp_tex_[1]->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(
+            conemap_obj->getConemapTexture()->view,
+            er::ImageLayout::GENERAL) };
+    device->updateDescriptorSet(
+        conemap_pack_tex_desc_set_,
+        conemap_pack_update_template_,
+        conemap_pack_descs);
 
     conemap_gen_init_pipeline_layout_ =
         createConemapPipelineLayout(
@@ -338,7 +232,9 @@ Conemap::Conemap(
         renderer::helper::createComputePipeline(
             device,
             conemap_pack_pipeline_layout_,
-            "conemap_pack_comp.spv");
+            conemap_obj->isHighPrecisionConemap() ?
+                "conemap_pack_hp_comp.spv" :
+                "conemap_pack_comp.spv");
 }
 
 void Conemap::update(
@@ -366,7 +262,16 @@ void Conemap::update(
         (full_buffer_size.x + kConemapGenBlockCacheSizeX - 1) / kConemapGenBlockCacheSizeX;
     auto block_cache_num_y =
         (full_buffer_size.y + kConemapGenBlockCacheSizeY - 1) / kConemapGenBlockCacheSizeY;
-    auto total_block_cache_count = block_cache_num_x * block_cache_num_y;
+    // tileable sources also take the blocks of the neighbour tiles within the wrap radius.
+    int wrap_block_radius =
+        conemap_obj->isTileable() ?
+        int((conemap_obj->getTileWrapRadius() + kConemapGenBlockCacheSizeX - 1) / kConemapGenBlockCacheSizeX) :
+        0;
+    int block_cache_min = -wrap_block_radius;
+    int block_cache_max_x = int(block_cache_num_x) + wrap_block_radius;
+    int block_cache_max_y = int(block_cache_num_y) + wrap_block_radius;
+    auto total_block_cache_count =
+        (block_cache_max_x - block_cache_min) * (block_cache_max_y - block_cache_min);
 
     renderer::BarrierList barrier_list;
     barrier_list.image_barriers.reserve(1);
@@ -381,6 +286,21 @@ void Conemap::update(
         SET_FLAG_BIT(Access, SHADER_READ_BIT) |
         SET_FLAG_BIT(Access, SHADER_WRITE_BIT));
 
+    // sorted cache block list, reused by every pass.
+    std::vector<uint64_t> block_indexes;
+    block_indexes.reserve(total_block_cache_count);
+
+    // the per block loop records through handles, no shared_ptr gets touched in there.
+    const auto gen_init_pipeline = conemap_gen_init_pipeline_->getHandle();
+    const auto gen_init_pipeline_layout = conemap_gen_init_pipeline_layout_->getHandle();
+    const auto gen_init_tex_desc_set = conemap_gen_init_tex_desc_set_->getHandle();
+    const auto gen_pipeline = conemap_gen_pipeline_->getHandle();
+    const auto gen_pipeline_layout = conemap_gen_pipeline_layout_->getHandle();
+    const auto gen_tex_desc_set = conemap_gen_tex_desc_set_->getHandle();
+    const auto pack_pipeline = conemap_pack_pipeline_->getHandle();
+    const auto pack_pipeline_layout = conemap_pack_pipeline_layout_->getHandle();
+    const auto pack_tex_desc_set = conemap_pack_tex_desc_set_->getHandle();
+
     // generate first pass of conemap with closer blocks.
     for (uint p = pass_start; p < pass_end; p++) {
         glm::uvec2 cur_block_index =
@@ -391,12 +311,12 @@ void Conemap::update(
         {
             cmd_buf->bindPipeline(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_gen_init_pipeline_);
+                gen_init_pipeline);
 
             cmd_buf->bindDescriptorSets(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_gen_init_pipeline_layout_,
-                { conemap_gen_init_tex_desc_set_ });
+                gen_init_pipeline_layout,
+                { gen_init_tex_desc_set });
 
             glsl::ConemapGenParams params = {};
             params.full_size = full_buffer_size;
@@ -404,10 +324,11 @@ void Conemap::update(
             params.dst_block_offset = cur_block_index * dispatch_block_size;
             params.depth_channel = conemap_obj->getDepthChannel();
             params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+            params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
 
             cmd_buf->pushConstants(
                 SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                conemap_gen_init_pipeline_layout_,
+                gen_init_pipeline_layout,
                 &params,
                 sizeof(params));
 
@@ -426,32 +347,40 @@ void Conemap::update(
         {
             cmd_buf->bindPipeline(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_gen_pipeline_);
+                gen_pipeline);
 
             cmd_buf->bindDescriptorSets(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_gen_pipeline_layout_,
-                { conemap_gen_tex_desc_set_ });
+                gen_pipeline_layout,
+                { gen_tex_desc_set });
 
             glsl::ConemapGenParams params = {};
             params.full_size = full_buffer_size;
             params.inv_full_size = glm::vec2(1.0f / params.full_size.x, 1.0f / params.full_size.y);
             params.depth_channel = conemap_obj->getDepthChannel();
             params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+            params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
             params.dst_block_offset = cur_block_index * dispatch_block_size;
 
-            std::vector<uint64_t> block_indexes;
-            block_indexes.reserve(total_block_cache_count);
+            block_indexes.clear();
             for (int i = 0; i < int(total_block_cache_count); i++) {
-                int y = i / block_cache_num_x;
-                int x = i % block_cache_num_x;
+                int y = block_cache_min + i / (block_cache_max_x - block_cache_min);
+                int x = block_cache_min + i % (block_cache_max_x - block_cache_min);
 
                 glm::vec2 block_diff =
                     (glm::vec2(x, y) + 0.5f) * glm::vec2(g_cache_block_size) -
                     (glm::vec2(cur_block_index) + 0.5f) * glm::vec2(dispatch_block_size);
                 float dist = glm::length(block_diff);
+                // blocks off the grid only matter within the wrap radius.
+                bool in_grid =
+                    x >= 0 && y >= 0 && x < int(block_cache_num_x) && y < int(block_cache_num_y);
+                if (!in_grid && dist > float(conemap_obj->getTileWrapRadius()) + g_cache_block_size.x) {
+                    continue;
+                }
                 uint64_t pack_value =
-                    (uint64_t(*((uint32_t*)&dist)) << 32) | (uint64_t(y) << 16) | uint64_t(x);
+                    (uint64_t(*((uint32_t*)&dist)) << 32) |
+                    (uint64_t(y + 0x8000) << 16) |
+                    uint64_t(x + 0x8000);
 
                 block_indexes.push_back(pack_value);
             }
@@ -459,17 +388,17 @@ void Conemap::update(
             std::sort(block_indexes.begin(), block_indexes.end());
 
             for (auto& index : block_indexes) {
-                int y = int((index & 0xffffffff) >> 16);
-                int x = int(index & 0xffff);
+                int y = int((index & 0xffffffff) >> 16) - 0x8000;
+                int x = int(index & 0xffff) - 0x8000;
 
                 params.cache_block_index =
-                    glm::uvec2(x, y);
+                    glm::ivec2(x, y);
                 params.cache_block_offset =
                     params.cache_block_index * glm::ivec2(g_cache_block_size);
 
                 cmd_buf->pushConstants(
                     SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                    conemap_gen_pipeline_layout_,
+                    gen_pipeline_layout,
                     &params,
                     sizeof(params));
 
@@ -488,23 +417,24 @@ void Conemap::update(
         {
             cmd_buf->bindPipeline(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_pack_pipeline_);
+                pack_pipeline);
 
             cmd_buf->bindDescriptorSets(
                 renderer::PipelineBindPoint::COMPUTE,
-                conemap_pack_pipeline_layout_,
-                { conemap_pack_tex_desc_set_ });
+                pack_pipeline_layout,
+                { pack_tex_desc_set });
 
             glsl::ConemapGenParams params = {};
             params.full_size = full_buffer_size;
             params.inv_full_size = glm::vec2(1.0f / params.full_size.x, 1.0f / params.full_size.y);
             params.depth_channel = conemap_obj->getDepthChannel();
             params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+            params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
             params.dst_block_offset = cur_block_index * dispatch_block_size;
 
             cmd_buf->pushConstants(
                 SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                conemap_pack_pipeline_layout_,
+                pack_pipeline_layout,
                 &params,
                 sizeof(params));
 
@@ -547,6 +477,9 @@ void Conemap::destroy(
     device->destroyDescriptorSetLayout(conemap_gen_init_desc_set_layout_);
     device->destroyDescriptorSetLayout(conemap_gen_desc_set_layout_);
     device->destroyDescriptorSetLayout(conemap_pack_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(conemap_gen_init_update_template_);
+    device->destroyDescriptorUpdateTemplate(conemap_gen_update_template_);
+    device->destroyDescriptorUpdateTemplate(conemap_pack_update_template_);
     device->destroyPipelineLayout(conemap_gen_init_pipeline_layout_);
     device->destroyPipelineLayout(conemap_gen_pipeline_layout_);
     device->destroyPipelineLayout(conemap_pack_pipeline_layout_);
@@ -14,6 +14,9 @@ class Conemap {
     std::shared_ptr<renderer::DescriptorSetLayout> conemap_gen_init_desc_set_layout_;
     std::shared_ptr<renderer::DescriptorSetLayout> conemap_gen_desc_set_layout_;
     std::shared_ptr<renderer::DescriptorSetLayout> conemap_pack_desc_set_layout_;
+    std::shared_ptr<renderer::DescriptorUpdateTemplate> conemap_gen_init_update_template_;
+    std::shared_ptr<renderer::DescriptorUpdateTemplate> conemap_gen_update_template_;
+    std::shared_ptr<renderer::DescriptorUpdateTemplate> conemap_pack_update_template_;
     std::shared_ptr<renderer::DescriptorSet> conemap_gen_init_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> conemap_gen_tex_desc_set_;
     std::shared_ptr<renderer::DescriptorSet> conemap_pack_tex_desc_set_;
@@ -54,76 +54,6 @@ std::shared_ptr<er::PipelineLayout> createCubemapPipelineLayout(
         { push_const_range });
 }
 
-er::WriteDescriptorList addPanoramaTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const er::TextureInfo& panorama_tex) {
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(1);
-
-    // envmap texture.
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::COMBINED_IMAGE_SAMPLER,
-        PANORAMA_TEX_INDEX,
-        texture_sampler,
-        panorama_tex.view,
-        er::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
-
-    return descriptor_writes;
-}
-
-er::WriteDescriptorList addIblTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const er::TextureInfo& rt_envmap_tex)
-{
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(1);
-
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::COMBINED_IMAGE_SAMPLER,
-        ENVMAP_TEX_INDEX,
-        texture_sampler,
-        rt_envmap_tex.view,
-        er::ImageLayout::SHADER_READ_ONLY_OPTIMAL);
-
-    return descriptor_writes;
-}
-
-er::WriteDescriptorList addIblComputeTextures(
-    const std::shared_ptr<er::DescriptorSet>& description_set,
-    const std::shared_ptr<er::Sampler>& texture_sampler,
-    const er::TextureInfo& src_tex,
-    const er::TextureInfo& dst_tex)
-{
-    er::WriteDescriptorList descriptor_writes;
-    descriptor_writes.reserve(2);
-
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        SRC_TEX_INDEX,
-        texture_sampler,
-        src_tex.view,
-        er::ImageLayout::GENERAL);
-
-    er::Helper::addOneTexture(
-        descriptor_writes,
-        description_set,
-        er::DescriptorType::STORAGE_IMAGE,
-        DST_TEX_INDEX,
-        texture_sampler,
-        dst_tex.view,
-        er::ImageLayout::GENERAL);
-
-    return descriptor_writes;
-}
-
 std::shared_ptr<er::PipelineLayout> createCubemapComputePipelineLayout(
     const std::shared_ptr<er::Device>& device,
     const std::shared_ptr<er::DescriptorSetLayout>& ibl_comp_desc_set_layout)
@@ -162,7 +92,7 @@ IblCreator::IblCreator(
     auto format = er::Format::R8G8B8A8_UNORM;
     helper::createTextureImage(
         device,
-        "assets/environments/doge2.hdr",
+        getPanoramaFileName(),
         format,
         panorama_tex_);
 
@@ -174,6 +104,8 @@ IblCreator::IblCreator(
 
         ibl_desc_set_layout_ =
             device->createDescriptorSetLayout(bindings);
+        ibl_desc_update_template_ =
+            device->createDescriptorUpdateTemplate(ibl_desc_set_layout_, bindings);
     }
 
     // ibl compute texture descriptor set layout.
@@ -188,6 +120,8 @@ IblCreator::IblCreator(
 
         ibl_comp_desc_set_layout_ =
             device->createDescriptorSetLayout(bindings);
+        ibl_comp_desc_update_template_ =
+            device->createDescriptorUpdateTemplate(ibl_comp_desc_set_layout_, bindings);
     }
 
     createDescriptorSets(
@@ -356,12 +290,16 @@ void IblCreator::createDescriptorSets(
             device->createDescriptorSets(
                 descriptor_pool, ibl_desc_set_layout_, 1)[0];
 
-        // create a global ibl texture descriptor set.
-        auto ibl_texture_descs = addPanoramaTextures(
+        // panorama texture.
+        const er::DescriptorInfo envmap_descs[] = {
+            er::DescriptorInfo::fromTexture(
+                panorama_tex_.view,
+                er::ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+                texture_sampler) };
+        device->updateDescriptorSet(
             envmap_tex_desc_set_,
-            texture_sampler,
-            panorama_tex_);
-        device->updateDescriptorSets(ibl_texture_descs);
+            ibl_desc_update_template_,
+            envmap_descs);
     }
 
     // ibl
@@ -370,12 +308,16 @@ void IblCreator::createDescriptorSets(
         ibl_tex_desc_set_ = device->createDescriptorSets(
             descriptor_pool, ibl_desc_set_layout_, 1)[0];
 
-        // create a global ibl texture descriptor set.
-        auto ibl_texture_descs = addIblTextures(
+        // envmap texture.
+        const er::DescriptorInfo ibl_descs[] = {
+            er::DescriptorInfo::fromTexture(
+                rt_envmap_tex_.view,
+                er::ImageLayout::SHADER_READ_ONLY_OPTIMAL,
+                texture_sampler) };
+        device->updateDescriptorSet(
             ibl_tex_desc_set_,
-            texture_sampler,
-            rt_envmap_tex_);
-        device->updateDescriptorSets(ibl_texture_descs);
+            ibl_desc_update_template_,
+            ibl_descs);
     }
 
     // ibl diffuse compute
@@ -384,13 +326,14 @@ void IblCreator::createDescriptorSets(
         ibl_diffuse_tex_desc_set_ = device->createDescriptorSets(
             descriptor_pool, ibl_comp_desc_set_layout_, 1)[0];
 
-        // create a global ibl texture descriptor set.
-        auto ibl_texture_descs = addIblComputeTextures(
+        // temporary diffuse map in, final diffuse map out.
+        const er::DescriptorInfo ibl_diffuse_descs[] = {
+            er::DescriptorInfo::fromTexture(tmp_ibl_diffuse_tex_.view, er::ImageLayout::GENERAL),
+            er::DescriptorInfo::fromTexture(rt_ibl_diffuse_tex_.view, er::ImageLayout::GENERAL) };
+        device->updateDescriptorSet(
             ibl_diffuse_tex_desc_set_,
-            texture_sampler,
-            tmp_ibl_diffuse_tex_,
-            rt_ibl_diffuse_tex_);
-        device->updateDescriptorSets(ibl_texture_descs);
+            ibl_comp_desc_update_template_,
+            ibl_diffuse_descs);
     }
 
     // ibl specular compute
@@ -399,13 +342,14 @@ void IblCreator::createDescriptorSets(
         ibl_specular_tex_desc_set_ = device->createDescriptorSets(
             descriptor_pool, ibl_comp_desc_set_layout_, 1)[0];
 
-        // create a global ibl texture descriptor set.
-        auto ibl_texture_descs = addIblComputeTextures(
+        // temporary specular map in, final specular map out.
+        const er::DescriptorInfo ibl_specular_descs[] = {
+            er::DescriptorInfo::fromTexture(tmp_ibl_specular_tex_.view, er::ImageLayout::GENERAL),
+            er::DescriptorInfo::fromTexture(rt_ibl_specular_tex_.view, er::ImageLayout::GENERAL) };
+        device->updateDescriptorSet(
             ibl_specular_tex_desc_set_,
-            texture_sampler,
-            tmp_ibl_specular_tex_,
-            rt_ibl_specular_tex_);
-        device->updateDescriptorSets(ibl_texture_descs);
+            ibl_comp_desc_update_template_,
+            ibl_specular_descs);
     }
 
     // ibl sheen compute
@@ -414,13 +358,14 @@ void IblCreator::createDescriptorSets(
         ibl_sheen_tex_desc_set_ = device->createDescriptorSets(
             descriptor_pool, ibl_comp_desc_set_layout_, 1)[0];
 
-        // create a global ibl texture descriptor set.
-        auto ibl_texture_descs = addIblComputeTextures(
+        // temporary sheen map in, final sheen map out.
+        const er::DescriptorInfo ibl_sheen_descs[] = {
+            er::DescriptorInfo::fromTexture(tmp_ibl_sheen_tex_.view, er::ImageLayout::GENERAL),
+            er::DescriptorInfo::fromTexture(rt_ibl_sheen_tex_.view, er::ImageLayout::GENERAL) };
+        device->updateDescriptorSet(
             ibl_sheen_tex_desc_set_,
-            texture_sampler,
-            tmp_ibl_sheen_tex_,
-            rt_ibl_sheen_tex_);
-        device->updateDescriptorSets(ibl_texture_descs);
+            ibl_comp_desc_update_template_,
+            ibl_sheen_descs);
     }
 }
 
@@ -736,6 +681,8 @@ void IblCreator::destroy(
 
     device->destroyDescriptorSetLayout(ibl_desc_set_layout_);
     device->destroyDescriptorSetLayout(ibl_comp_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(ibl_desc_update_template_);
+    device->destroyDescriptorUpdateTemplate(ibl_comp_desc_update_template_);
 
     rt_envmap_tex_.destroy(device);
     panorama_tex_.destroy(device);
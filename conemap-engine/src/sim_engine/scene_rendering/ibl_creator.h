@@ -22,6 +22,8 @@ class IblCreator {
 
     std::shared_ptr<renderer::DescriptorSetLayout> ibl_desc_set_layout_;
     std::shared_ptr<renderer::DescriptorSetLayout> ibl_comp_desc_set_layout_;
+    std::shared_ptr<renderer::DescriptorUpdateTemplate> ibl_desc_update_template_;
+    std::shared_ptr<renderer::DescriptorUpdateTemplate> ibl_comp_desc_update_template_;
     std::shared_ptr<renderer::PipelineLayout> ibl_pipeline_layout_;
     std::shared_ptr<renderer::PipelineLayout> ibl_comp_pipeline_layout_;
 
@@ -32,6 +34,11 @@ class IblCreator {
     std::shared_ptr<renderer::Pipeline> blur_comp_pipeline_;
 
 public:
+    // equirectangular source of the envmap, also read on cpu for sh lighting.
+    static const char* getPanoramaFileName() {
+        return "assets/environments/doge2.hdr";
+    }
+
     IblCreator(
         const std::shared_ptr<renderer::Device>& device,
         const std::shared_ptr<renderer::DescriptorPool>& descriptor_pool,
@@ -1,70 +1,124 @@
 #include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 #include "renderer/renderer_helper.h"
 #include "engine_helper.h"
 #include "shaders/global_definition.glsl.h"
+#include "sh_basis.h"
 #include "prt_shadow.h"
 
 namespace {
     namespace er = engine::renderer;
+    namespace es = engine::scene_rendering;
 
     const glm::uvec2 g_block_size =
         glm::uvec2(kConemapGenBlockCacheSizeX, kConemapGenBlockCacheSizeY);
 
-    er::WriteDescriptorList addPrtShadowGenTextures(
-        const std::shared_ptr<er::DescriptorSet>& description_set,
-        const std::shared_ptr<er::TextureInfo>& shadow_cache_tex,
-        const std::shared_ptr<er::TextureInfo>& dst_texes) {
-        er::WriteDescriptorList descriptor_writes;
-        descriptor_writes.reserve(2);
-
-        // minmax depth texture.
-        er::Helper::addOneTexture(
-            descriptor_writes,
-            description_set,
-            er::DescriptorType::STORAGE_IMAGE,
-            SRC_INFO_TEX_INDEX,
-            nullptr,
-            shadow_cache_tex->view,
-            er::ImageLayout::GENERAL);
+    // guide falloff of the reduced resolution bake upsampling, in depth channel units
+    // and as the power of the normals' cosine.
+    const float kPrtUpsampleDepthSigma = 0.02f;
+    const float kPrtUpsampleNormalPower = 8.0f;
 
-        er::Helper::addOneTexture(
-            descriptor_writes,
-            description_set,
-            er::DescriptorType::STORAGE_IMAGE,
-            DST_TEX_INDEX,
-            nullptr,
-            dst_texes->view,
-            er::ImageLayout::GENERAL);
+    // adaptive row of the bake mode compare when the bake itself samples every azimuth.
+    const float kPrtCompareAdaptiveTolerance = 1.0e-3f;
 
-        return descriptor_writes;
+    // blocks in the (2r + 1) x (2r + 1) square of rings up to r.
+    int getRingBlockCount(int ring_radius) {
+        return (2 * ring_radius + 1) * (2 * ring_radius + 1);
     }
 
-    er::WriteDescriptorList addDsPrtTextures(
-        const std::shared_ptr<er::DescriptorSet>& description_set,
-        const std::shared_ptr<er::TextureInfo>& src_prt_texes,
-        const std::shared_ptr<er::TextureInfo>& dst_prt_texes) {
-        er::WriteDescriptorList descriptor_writes;
-        descriptor_writes.reserve(2);
+    // source block offsets for the fused shadow cache update, ring by ring outside the
+    // init radius and nearest first within a ring, packed as 16 bit x and y + 0x8000.
+    std::vector<uint32_t> buildPrtCacheBlockList() {
+        std::vector<glm::ivec2> offsets;
+        offsets.reserve(
+            getRingBlockCount(kPrtMaxHorizonBlockRadius) - getRingBlockCount(kPrtShadowInitBlockRadius));
+        for (int y = -kPrtMaxHorizonBlockRadius; y <= kPrtMaxHorizonBlockRadius; y++) {
+            for (int x = -kPrtMaxHorizonBlockRadius; x <= kPrtMaxHorizonBlockRadius; x++) {
+                if (std::max(std::abs(x), std::abs(y)) > kPrtShadowInitBlockRadius) {
+                    offsets.push_back(glm::ivec2(x, y));
+                }
+            }
+        }
 
-        er::Helper::addOneTexture(
-            descriptor_writes,
-            description_set,
-            er::DescriptorType::STORAGE_IMAGE,
-            SRC_TEX_INDEX,
-            nullptr,
-            src_prt_texes->view,
-            er::ImageLayout::GENERAL);
+        std::sort(offsets.begin(), offsets.end(),
+            [](const glm::ivec2& a, const glm::ivec2& b) {
+                int ring_a = std::max(std::abs(a.x), std::abs(a.y));
+                int ring_b = std::max(std::abs(b.x), std::abs(b.y));
+                if (ring_a != ring_b) {
+                    return ring_a < ring_b;
+                }
+                return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+            });
 
-        er::Helper::addOneTexture(
-            descriptor_writes,
-            description_set,
-            er::DescriptorType::STORAGE_IMAGE,
-            DST_TEX_INDEX,
-            nullptr,
-            dst_prt_texes->view,
-            er::ImageLayout::GENERAL);
+        std::vector<uint32_t> block_list(offsets.size());
+        for (size_t i = 0; i < offsets.size(); i++) {
+            block_list[i] =
+                (uint32_t(offsets[i].y + 0x8000) << 16) | uint32_t(offsets[i].x + 0x8000);
+        }
+
+        return block_list;
+    }
 
-        return descriptor_writes;
+    // cumulative zonal integral table, accumulated in double and stored as float.
+    // largest difference of the 25 sh coefficients between two prt_texes_ readbacks, a pixel
+    // is 8 rgba32f texels, texels 0 - 5 hold s = 1 .. 24 and texel 6 the dc term.
+    float getMaxPrtCoeffDiff(
+        const std::vector<float>& coeffs_a,
+        const std::vector<float>& coeffs_b) {
+        float max_diff = 0.0f;
+        for (size_t p = 0; p + 32 <= coeffs_a.size(); p += 32) {
+            for (size_t s = 0; s < 25; s++) {
+                max_diff = std::max(max_diff, std::abs(coeffs_a[p + s] - coeffs_b[p + s]));
+            }
+        }
+        return max_diff;
+    }
+
+    // mean over the block rows of the max sh coefficient step between column_a of one
+    // baked block and column_b of another.
+    float getMeanPrtColumnStep(
+        const std::vector<float>& coeffs_a,
+        uint32_t column_a,
+        const std::vector<float>& coeffs_b,
+        uint32_t column_b,
+        uint32_t num_rows) {
+        double sum_step = 0.0;
+        for (uint32_t y = 0; y < num_rows; y++) {
+            size_t p_a = (size_t(y) * g_block_size.x + column_a) * 32;
+            size_t p_b = (size_t(y) * g_block_size.x + column_b) * 32;
+            float max_step = 0.0f;
+            for (size_t s = 0; s < 25; s++) {
+                max_step = std::max(max_step, std::abs(coeffs_a[p_a + s] - coeffs_b[p_b + s]));
+            }
+            sum_step += max_step;
+        }
+        return float(sum_step / std::max(num_rows, 1u));
+    }
+
+    std::vector<float> bakePrtZonalLut() {
+        const double step_theta = glm::pi<double>() * 0.5 / kPrtThetaSampleCount;
+        std::vector<float> lut(kPrtThetaSampleCount * kPrtZonalLutStride);
+        double sum_coeffs[es::PrtShBasis::kLegendreCount] = {};
+        double sum_weight = 0.0;
+        for (int t = 0; t < kPrtThetaSampleCount; t++) {
+            double theta = (t + 0.5) * step_theta;  // From 0 to pi / 2
+            double coeffs[es::PrtShBasis::kLegendreCount];
+            es::PrtShBasis::fillZonalCoeffs<double>(coeffs, theta);
+            double weight =
+                (2.0 * glm::pi<double>() * std::sin(theta) / kPrtPhiSampleCount) / step_theta;
+
+            for (int i = 0; i < es::PrtShBasis::kLegendreCount; i++) {
+                sum_coeffs[i] += coeffs[i] * weight;
+                lut[t * kPrtZonalLutStride + i] = float(sum_coeffs[i]);
+            }
+            sum_weight += weight;
+            lut[t * kPrtZonalLutStride + 15] = float(sum_weight);
+        }
+
+        return lut;
     }
 
     std::shared_ptr<er::PipelineLayout>
@@ -95,6 +149,20 @@ namespace {
             { push_const_range });
     }
 
+    std::shared_ptr<er::PipelineLayout>
+        createPrtUpsamplePipelineLayout(
+            const std::shared_ptr<er::Device>& device,
+            const std::shared_ptr<er::DescriptorSetLayout>& desc_set_layout) {
+        er::PushConstantRange push_const_range{};
+        push_const_range.stage_flags = SET_FLAG_BIT(ShaderStage, COMPUTE_BIT);
+        push_const_range.offset = 0;
+        push_const_range.size = sizeof(glsl::PrtUpsampleParams);
+
+        return device->createPipelineLayout(
+            { desc_set_layout },
+            { push_const_range });
+    }
+
     std::shared_ptr<er::PipelineLayout>
         createPrtDsPipelineLayout(
             const std::shared_ptr<er::Device>& device,
@@ -140,6 +208,20 @@ PrtShadow::PrtShadow(
         SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
         renderer::ImageLayout::GENERAL);
 
+    // half resolution block plus halo, quarter resolution only uses part of it.
+    const glm::uvec2 low_res_buffer_size =
+        (g_block_size / glm::uvec2(2) + glm::uvec2(2 * kPrtBakeHaloSize)) * glm::uvec2(8, 1);
+
+    prt_low_res_texes_ = std::make_shared<renderer::TextureInfo>();
+    renderer::Helper::create2DTextureImage(
+        device,
+        renderer::Format::R32G32B32A32_SFLOAT,
+        low_res_buffer_size,
+        *prt_low_res_texes_,
+        SET_FLAG_BIT(ImageUsage, SAMPLED_BIT) |
+        SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
+        renderer::ImageLayout::GENERAL);
+
     // 400 sample rays per pixel saved tangent angle for shadowing.
     const glm::uvec2 prt_shadow_cache_tex_size =
         g_block_size * glm::uvec2(uint(std::sqrt(kPrtPhiSampleCount / 4)));
@@ -167,9 +249,57 @@ PrtShadow::PrtShadow(
         SET_FLAG_BIT(ImageUsage, STORAGE_BIT),
         renderer::ImageLayout::GENERAL);
 
+    auto zonal_lut = bakePrtZonalLut();
+    prt_zonal_lut_buffer_ =
+        helper::createUnifiedMeshBuffer(
+            device,
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+            zonal_lut.size() * sizeof(zonal_lut[0]),
+            zonal_lut.data());
+
+    auto cache_block_list = buildPrtCacheBlockList();
+    prt_cache_block_list_buffer_ =
+        helper::createUnifiedMeshBuffer(
+            device,
+            SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+            cache_block_list.size() * sizeof(cache_block_list[0]),
+            cache_block_list.data());
+
+    prt_pack_stats_buffer_ = std::make_shared<renderer::BufferInfo>();
+    device->createBuffer(
+        sizeof(glsl::PrtPackStats) * kPrtPackModeCount,
+        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        prt_pack_stats_buffer_->buffer,
+        prt_pack_stats_buffer_->memory);
+
+    glsl::PrtPackStats pack_stats[kPrtPackModeCount] = {};
+    device->updateBufferMemory(
+        prt_pack_stats_buffer_->memory,
+        sizeof(pack_stats),
+        pack_stats);
+
+    prt_adaptive_stats_buffer_ = std::make_shared<renderer::BufferInfo>();
+    device->createBuffer(
+        sizeof(glsl::PrtAdaptiveStats),
+        SET_FLAG_BIT(BufferUsage, STORAGE_BUFFER_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        prt_adaptive_stats_buffer_->buffer,
+        prt_adaptive_stats_buffer_->memory);
+
+    glsl::PrtAdaptiveStats adaptive_stats{};
+    device->updateBufferMemory(
+        prt_adaptive_stats_buffer_->memory,
+        sizeof(adaptive_stats),
+        &adaptive_stats);
+
     // create a prt shadow texture descriptor set layout.
     std::vector<renderer::DescriptorSetLayoutBinding> prt_shadow_gen_with_cache_bindings;
-    prt_shadow_gen_with_cache_bindings.reserve(2);
+    prt_shadow_gen_with_cache_bindings.reserve(3);
     prt_shadow_gen_with_cache_bindings.push_back(
         renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
             SRC_INFO_TEX_INDEX,
@@ -182,8 +312,18 @@ PrtShadow::PrtShadow(
             SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
             er::DescriptorType::STORAGE_IMAGE));
 
+    prt_shadow_gen_with_cache_bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_ZONAL_LUT_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_BUFFER));
+
     prt_shadow_gen_with_cache_desc_set_layout_ =
         device->createDescriptorSetLayout(prt_shadow_gen_with_cache_bindings);
+    prt_shadow_gen_with_cache_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_shadow_gen_with_cache_desc_set_layout_,
+            prt_shadow_gen_with_cache_bindings);
 
     // create prt texture descriptor sets.
     prt_shadow_gen_with_cache_tex_desc_set_ =
@@ -191,12 +331,17 @@ PrtShadow::PrtShadow(
             descriptor_pool,
             prt_shadow_gen_with_cache_desc_set_layout_, 1)[0];
 
-    auto prt_shadow_gen_with_cache_texture_descs =
-        addPrtShadowGenTextures(
-            prt_shadow_gen_with_cache_tex_desc_set_,
-            prt_shadow_cache_texes_,
-            prt_texes_);
-    device->updateDescriptorSets(prt_shadow_gen_with_cache_texture_descs);
+    // shadow cache texture, prt textures, zonal lut.
+    const er::DescriptorInfo prt_shadow_gen_with_cache_descs[] = {
+        er::DescriptorInfo::fromTexture(prt_shadow_cache_texes_->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(prt_texes_->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromBuffer(
+            prt_zonal_lut_buffer_->buffer,
+            prt_zonal_lut_buffer_->buffer->getSize()) };
+    device->updateDescriptorSet(
+        prt_shadow_gen_with_cache_tex_desc_set_,
+        prt_shadow_gen_with_cache_desc_update_template_,
+        prt_shadow_gen_with_cache_descs);
 
     prt_shadow_gen_with_cache_pipeline_layout_ =
         createPrtShadowGenPipelineLayout(
@@ -225,8 +370,39 @@ PrtShadow::PrtShadow(
             SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
             er::DescriptorType::STORAGE_IMAGE));
 
+    // prt shadow gen additionally reads the zonal lut, conemap plus minmax
+    // depth for the accelerated horizon search, and writes the adaptive sampling stats.
+    auto prt_shadow_gen_bindings = bindings;
+    prt_shadow_gen_bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_ZONAL_LUT_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_BUFFER));
+
+    prt_shadow_gen_bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX_1,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::COMBINED_IMAGE_SAMPLER));
+
+    prt_shadow_gen_bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_INFO_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE));
+
+    prt_shadow_gen_bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_ADAPTIVE_STATS_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_BUFFER));
+
     prt_shadow_gen_desc_set_layout_ =
-        device->createDescriptorSetLayout(bindings);
+        device->createDescriptorSetLayout(prt_shadow_gen_bindings);
+    prt_shadow_gen_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_shadow_gen_desc_set_layout_,
+            prt_shadow_gen_bindings);
 
     prt_shadow_gen_pipeline_layout_ =
         createPrtShadowGenPipelineLayout(
@@ -239,8 +415,57 @@ PrtShadow::PrtShadow(
             prt_shadow_gen_pipeline_layout_,
             "prt_shadow_gen_comp.spv");
 
+    prt_shadow_gen_conemap_pipeline_ =
+        renderer::helper::createComputePipeline(
+            device,
+            prt_shadow_gen_pipeline_layout_,
+            "prt_shadow_gen_conemap_comp.spv");
+
+    // height guided upsampling of the reduced resolution bake.
+    std::vector<renderer::DescriptorSetLayoutBinding> prt_upsample_bindings;
+    prt_upsample_bindings.reserve(3);
+    prt_upsample_bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::COMBINED_IMAGE_SAMPLER));
+
+    prt_upsample_bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            SRC_INFO_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE));
+
+    prt_upsample_bindings.push_back(
+        renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
+            DST_TEX_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_IMAGE));
+
+    prt_upsample_desc_set_layout_ =
+        device->createDescriptorSetLayout(prt_upsample_bindings);
+    prt_upsample_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_upsample_desc_set_layout_,
+            prt_upsample_bindings);
+
+    prt_upsample_pipeline_layout_ =
+        createPrtUpsamplePipelineLayout(
+            device,
+            prt_upsample_desc_set_layout_);
+
+    prt_upsample_pipeline_ =
+        renderer::helper::createComputePipeline(
+            device,
+            prt_upsample_pipeline_layout_,
+            "prt_upsample_comp.spv");
+
     prt_shadow_cache_desc_set_layout_ =
         device->createDescriptorSetLayout(bindings);
+    prt_shadow_cache_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_shadow_cache_desc_set_layout_,
+            bindings);
 
     prt_shadow_cache_pipeline_layout_ =
         createPrtShadowGenPipelineLayout(
@@ -254,7 +479,7 @@ PrtShadow::PrtShadow(
             "prt_shadow_cache_init_comp.spv");
 
     std::vector<renderer::DescriptorSetLayoutBinding> prt_shadow_update_bindings;
-    prt_shadow_update_bindings.reserve(3);
+    prt_shadow_update_bindings.reserve(4);
     prt_shadow_update_bindings.push_back(
         renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
             SRC_TEX_INDEX,
@@ -273,8 +498,18 @@ PrtShadow::PrtShadow(
             SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
             er::DescriptorType::STORAGE_IMAGE));
 
+    prt_shadow_update_bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_CACHE_BLOCK_LIST_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_BUFFER));
+
     prt_shadow_cache_update_desc_set_layout_ =
         device->createDescriptorSetLayout(prt_shadow_update_bindings);
+    prt_shadow_cache_update_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_shadow_cache_update_desc_set_layout_,
+            prt_shadow_update_bindings);
 
     prt_shadow_cache_update_pipeline_layout_ =
         createPrtShadowCacheUpdatePipelineLayout(
@@ -304,19 +539,24 @@ PrtShadow::PrtShadow(
 
     prt_ds_desc_set_layout_ =
         device->createDescriptorSetLayout(ds_bindings);
+    prt_ds_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            prt_ds_desc_set_layout_,
+            ds_bindings);
 
     prt_ds_tex_desc_set_ =
         device->createDescriptorSets(
             descriptor_pool,
             prt_ds_desc_set_layout_, 1)[0];
 
-    // create a global ibl texture descriptor set.
-    auto prt_ds_texture_descs =
-        addDsPrtTextures(
-            prt_ds_tex_desc_set_,
-            prt_texes_,
-            prt_ds_texes_);
-    device->updateDescriptorSets(prt_ds_texture_descs);
+    // prt textures, downsampled prt textures.
+    const er::DescriptorInfo prt_ds_descs[] = {
+        er::DescriptorInfo::fromTexture(prt_texes_->view, er::ImageLayout::GENERAL),
+        er::DescriptorInfo::fromTexture(prt_ds_texes_->view, er::ImageLayout::GENERAL) };
+    device->updateDescriptorSet(
+        prt_ds_tex_desc_set_,
+        prt_ds_desc_update_template_,
+        prt_ds_descs);
 
     prt_ds_first_pipeline_layout_ =
         createPrtDsPipelineLayout(
@@ -332,6 +572,10 @@ PrtShadow::PrtShadow(
     // create a global ibl texture descriptor set layout.
     gen_prt_pack_info_desc_set_layout_ =
         device->createDescriptorSetLayout(ds_bindings);
+    gen_prt_pack_info_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            gen_prt_pack_info_desc_set_layout_,
+            ds_bindings);
 
     gen_prt_pack_info_pipeline_layout_ =
         createPrtPackPipelineLayout(
@@ -346,7 +590,7 @@ PrtShadow::PrtShadow(
 
     // create a global ibl texture descriptor set layout.
     std::vector<renderer::DescriptorSetLayoutBinding> pack_bindings;
-    pack_bindings.reserve(3);
+    pack_bindings.reserve(4);
     pack_bindings.push_back(
         renderer::helper::getTextureSamplerDescriptionSetLayoutBinding(
             SRC_TEX_INDEX,
@@ -365,8 +609,18 @@ PrtShadow::PrtShadow(
             SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
             er::DescriptorType::STORAGE_IMAGE));
 
+    pack_bindings.push_back(
+        renderer::helper::getBufferDescriptionSetLayoutBinding(
+            PRT_PACK_STATS_INDEX,
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            er::DescriptorType::STORAGE_BUFFER));
+
     pack_prt_desc_set_layout_ =
         device->createDescriptorSetLayout(pack_bindings);
+    pack_prt_desc_update_template_ =
+        device->createDescriptorUpdateTemplate(
+            pack_prt_desc_set_layout_,
+            pack_bindings);
 
     pack_prt_pipeline_layout_ =
         createPrtPackPipelineLayout(
@@ -380,14 +634,301 @@ PrtShadow::PrtShadow(
             "pack_prt_comp.spv");
 }
 
+void PrtShadow::dispatchPrtShadowGen(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    const std::shared_ptr<renderer::DescriptorSet>& desc_set,
+    const glm::uvec2& block_offset,
+    const glm::vec2& pixel_sample_size,
+    const glm::uvec2& dispatch_size,
+    uint32_t halo_size,
+    bool collect_adaptive_stats) {
+    cmd_buf->bindPipeline(
+        renderer::PipelineBindPoint::COMPUTE,
+        use_conemap_horizon_search_ ?
+            prt_shadow_gen_conemap_pipeline_ :
+            prt_shadow_gen_pipeline_);
+    glsl::PrtGenParams params = {};
+    params.size = glm::uvec2(conemap_obj->getPackTexture()->size);
+    params.inv_size = glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
+    params.block_offset = block_offset;
+    params.pixel_sample_size = pixel_sample_size;
+    params.shadow_intensity = conemap_obj->getShadowIntensity();
+    params.depth_channel = conemap_obj->getDepthChannel();
+    params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+    params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
+    params.sample_rate = 1.0f;
+    params.is_high_precision_conemap =
+        conemap_obj->isHighPrecisionConemap() ? 1 : 0;
+    params.adaptive_tolerance = adaptive_tolerance_;
+    params.collect_adaptive_stats = collect_adaptive_stats ? 1 : 0;
+    params.dispatch_size = dispatch_size;
+    params.halo_size = halo_size;
+    params.horizon_radius = getHorizonRadius(conemap_obj);
+    params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+        prt_shadow_gen_pipeline_layout_,
+        &params,
+        sizeof(params));
+
+    cmd_buf->bindDescriptorSets(
+        renderer::PipelineBindPoint::COMPUTE,
+        prt_shadow_gen_pipeline_layout_,
+        { desc_set });
+
+    cmd_buf->dispatch(
+        (dispatch_size.x + 31) / 32,
+        (dispatch_size.y + 31) / 32,
+        1);
+}
+
+uint32_t PrtShadow::getHorizonRadius(
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) const {
+    if (conemap_obj->isTileable()) {
+        return std::max(
+            std::min(horizon_radius_, conemap_obj->getTileWrapRadius()),
+            uint32_t(kConemapGenBlockCacheSizeX));
+    }
+    return horizon_radius_;
+}
+
+uint32_t PrtShadow::getNumPasses(
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) const {
+    auto block_count =
+        (glm::uvec2(conemap_obj->getPackTexture()->size) + g_block_size - glm::uvec2(1)) / g_block_size;
+    return block_count.x * block_count.y;
+}
+
 void PrtShadow::update(
     const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
-    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    uint32_t pass_start,
+    uint32_t pass_end) {
 
     auto src_size =
         glm::uvec2(conemap_obj->getPackTexture()->size);
 
-    // create coarse prt textures.
+    auto block_count =
+        (src_size + g_block_size - glm::uvec2(1)) / g_block_size;
+
+    // global range from a coarse prt pass, shared by all the blocks. it lives in the
+    // pack info texture, so later passes don't depend on anything else recorded here.
+    // block banded bakes collecting the error need it too, every block gets packed with
+    // the global range as reference before its own range replaces it.
+    if (pass_start == 0 &&
+        (pack_mode_ == kPrtPackGlobalUniform || collect_pack_error_)) {
+        renderer::helper::transitMapTextureToStoreImage(
+            cmd_buf,
+            { prt_texes_->image });
+
+        dispatchPrtShadowGen(
+            cmd_buf,
+            conemap_obj,
+            conemap_obj->getPrtShadowGenTexDescSet(),
+            glm::uvec2(0),
+            glm::vec2(src_size) / glm::vec2(g_block_size),
+            g_block_size,
+            0,
+            false);
+
+        renderer::helper::transitMapTextureFromStoreImage(
+            cmd_buf,
+            { prt_texes_->image },
+            renderer::ImageLayout::GENERAL);
+
+        std::vector<glm::uvec2> block_indexes;
+        block_indexes.reserve(block_count.x * block_count.y);
+        for (uint y = 0; y < block_count.y; y++) {
+            for (uint x = 0; x < block_count.x; x++) {
+                block_indexes.push_back(glm::uvec2(x, y));
+            }
+        }
+        updatePackInfo(cmd_buf, conemap_obj, block_indexes, 1.2f, kPrtPackGlobalUniform);
+    }
+
+    pass_end = std::min(pass_end, block_count.x * block_count.y);
+
+    // block intermediates get recycled by every pass.
+    for (uint p = pass_start; p < pass_end; p++) {
+        uint block_x = p % block_count.x;
+        uint block_y = p / block_count.x;
+
+        // bake every bake_downscale_ pixel plus a halo, then upsample back to the full block.
+        if (bake_downscale_ > 1) {
+            recordLowResBake(
+                cmd_buf,
+                conemap_obj,
+                glm::uvec2(block_x, block_y) * g_block_size,
+                bake_downscale_,
+                collect_adaptive_stats_);
+        }
+        // adaptive azimuth sampling marches the rays of every pixel directly, the
+        // tangent cache always holds all the kPrtPhiSampleCount azimuths.
+        else if (adaptive_tolerance_ > 0.0f) {
+            renderer::helper::transitMapTextureToStoreImage(
+                cmd_buf,
+                { prt_texes_->image });
+
+            dispatchPrtShadowGen(
+                cmd_buf,
+                conemap_obj,
+                conemap_obj->getPrtShadowGenTexDescSet(),
+                glm::uvec2(block_x, block_y) * g_block_size,
+                glm::vec2(1.0f),
+                g_block_size,
+                0,
+                collect_adaptive_stats_);
+
+            renderer::helper::transitMapTextureFromStoreImage(
+                cmd_buf,
+                { prt_texes_->image },
+                renderer::ImageLayout::GENERAL);
+        }
+        else {
+            recordTangentCacheBake(cmd_buf, conemap_obj, glm::uvec2(block_x, block_y));
+        }
+
+        if (pack_mode_ == kPrtPackBlockBanded) {
+            if (collect_pack_error_) {
+                recordPackBlock(
+                    cmd_buf,
+                    conemap_obj,
+                    glm::uvec2(block_x, block_y),
+                    kPrtPackGlobalUniform,
+                    false);
+            }
+
+            // tight range of this block only.
+            updatePackInfo(
+                cmd_buf,
+                conemap_obj,
+                { glm::uvec2(block_x, block_y) },
+                1.0f,
+                kPrtPackBlockBanded);
+        }
+
+        recordPackBlock(
+            cmd_buf,
+            conemap_obj,
+            glm::uvec2(block_x, block_y),
+            pack_mode_,
+            true);
+
+        last_block_index_ = glm::uvec2(block_x, block_y);
+    }
+}
+
+void PrtShadow::recordTangentCacheBake(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    const glm::uvec2& block_index) {
+    auto src_size =
+        glm::uvec2(conemap_obj->getPackTexture()->size);
+
+    // cache shadow ray's tangent value.
+    {
+        renderer::helper::transitMapTextureToStoreImage(
+            cmd_buf,
+            { prt_shadow_cache_texes_->image });
+
+        cmd_buf->bindPipeline(
+            renderer::PipelineBindPoint::COMPUTE,
+            prt_shadow_cache_pipeline_);
+        glsl::PrtGenParams params = {};
+        params.size = src_size;
+        params.inv_size =
+            glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
+        params.block_offset = block_index * g_block_size;
+        params.shadow_intensity = conemap_obj->getShadowIntensity();
+        params.depth_channel = conemap_obj->getDepthChannel();
+        params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+        params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
+        params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
+
+        cmd_buf->pushConstants(
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            prt_shadow_cache_pipeline_layout_,
+            &params,
+            sizeof(params));
+
+        cmd_buf->bindDescriptorSets(
+            renderer::PipelineBindPoint::COMPUTE,
+            prt_shadow_cache_pipeline_layout_,
+            { conemap_obj->getPrtShadowCacheTexDescSet() });
+
+        cmd_buf->dispatch(
+            (g_block_size.x + kConemapGenDispatchX - 1) / kConemapGenDispatchX,
+            (g_block_size.y + kConemapGenDispatchY - 1) / kConemapGenDispatchY,
+            1);
+
+        renderer::helper::transitMapTextureFromStoreImage(
+            cmd_buf,
+            { prt_shadow_cache_texes_->image },
+            renderer::ImageLayout::GENERAL);
+    }
+
+    // go through all the other cache blocks, update cache shadow ray's tangent value.
+    {
+        auto block_cache_num_x =
+            (src_size.x + kConemapGenBlockCacheSizeX - 1) / kConemapGenBlockCacheSizeX;
+        auto block_cache_num_y =
+            (src_size.y + kConemapGenBlockCacheSizeY - 1) / kConemapGenBlockCacheSizeY;
+        // the block list is ordered by rings around the destination block, so
+        // its leading entries are exactly the rings within the horizon radius.
+        // rings past the grid wrap into the neighbour tiles on tileable sources.
+        int ring_radius =
+            int((getHorizonRadius(conemap_obj) + kConemapGenBlockCacheSizeX - 1) / kConemapGenBlockCacheSizeX);
+        if (!conemap_obj->isTileable()) {
+            ring_radius =
+                std::min(ring_radius, int(std::max(block_cache_num_x, block_cache_num_y)) - 1);
+        }
+        ring_radius = std::min(ring_radius, kPrtMaxHorizonBlockRadius);
+        uint32_t num_blocks =
+            ring_radius > kPrtShadowInitBlockRadius ?
+            uint32_t(getRingBlockCount(ring_radius) - getRingBlockCount(kPrtShadowInitBlockRadius)) :
+            0;
+
+        cmd_buf->bindPipeline(
+            renderer::PipelineBindPoint::COMPUTE,
+            prt_shadow_cache_update_pipeline_);
+
+        cmd_buf->bindDescriptorSets(
+            renderer::PipelineBindPoint::COMPUTE,
+            prt_shadow_cache_update_pipeline_layout_,
+            { conemap_obj->getPrtShadowCacheUpdateTexDescSet() });
+
+        glsl::PrtShadowCacheGenParams params = {};
+        params.size = src_size;
+        params.inv_size = glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
+        params.dst_block_index = glm::ivec2(block_index);
+        params.dst_block_offset = glm::ivec2(block_index) * glm::ivec2(g_block_size);
+        params.depth_channel = conemap_obj->getDepthChannel();
+        params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
+        params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
+        params.shadow_intensity = conemap_obj->getShadowIntensity();
+        params.num_blocks = num_blocks;
+        params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
+
+        cmd_buf->pushConstants(
+            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+            prt_shadow_cache_update_pipeline_layout_,
+            &params,
+            sizeof(params));
+
+        // all the source blocks in one dispatch, a single barrier afterwards.
+        cmd_buf->dispatch(
+            (g_block_size.x + kConemapGenDispatchX - 1) / kConemapGenDispatchX,
+            (g_block_size.y + kConemapGenDispatchY - 1) / kConemapGenDispatchY,
+            1);
+
+        renderer::helper::transitMapTextureToStoreImage(
+            cmd_buf,
+            { prt_shadow_cache_texes_->image });
+    }
+
+    // create prt textures.
     {
         renderer::helper::transitMapTextureToStoreImage(
             cmd_buf,
@@ -395,33 +936,30 @@ void PrtShadow::update(
 
         cmd_buf->bindPipeline(
             renderer::PipelineBindPoint::COMPUTE,
-            prt_shadow_gen_pipeline_);
+            prt_shadow_gen_with_cache_pipeline_);
         glsl::PrtGenParams params = {};
         params.size = src_size;
         params.inv_size = glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
-        params.block_offset = glm::uvec2(0);
-        params.pixel_sample_size =
-            glm::vec2(params.size) / glm::vec2(g_block_size);
+        params.block_offset = block_index * g_block_size;
         params.shadow_intensity = conemap_obj->getShadowIntensity();
         params.depth_channel = conemap_obj->getDepthChannel();
         params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
         params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
-        params.sample_rate = 1.0f;
 
         cmd_buf->pushConstants(
             SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-            prt_shadow_gen_pipeline_layout_,
+            prt_shadow_gen_with_cache_pipeline_layout_,
             &params,
             sizeof(params));
 
         cmd_buf->bindDescriptorSets(
             renderer::PipelineBindPoint::COMPUTE,
-            prt_shadow_gen_pipeline_layout_,
-            { conemap_obj->getPrtShadowGenTexDescSet() });
+            prt_shadow_gen_with_cache_pipeline_layout_,
+            { prt_shadow_gen_with_cache_tex_desc_set_ });
 
         cmd_buf->dispatch(
-            (g_block_size.x + 31) / 32,
-            (g_block_size.y + 31) / 32,
+            (g_block_size.x + kPrtShadowGenDispatchX - 1) / kPrtShadowGenDispatchX,
+            (g_block_size.y + kPrtShadowGenDispatchY - 1) / kPrtShadowGenDispatchY,
             1);
 
         renderer::helper::transitMapTextureFromStoreImage(
@@ -429,7 +967,127 @@ void PrtShadow::update(
             { prt_texes_->image },
             renderer::ImageLayout::GENERAL);
     }
+}
+
+void PrtShadow::recordLowResBake(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    const glm::uvec2& block_offset,
+    uint32_t downscale,
+    bool collect_adaptive_stats) {
+    auto src_size =
+        glm::uvec2(conemap_obj->getPackTexture()->size);
+
+    renderer::helper::transitMapTextureToStoreImage(
+        cmd_buf,
+        { prt_low_res_texes_->image });
+
+    dispatchPrtShadowGen(
+        cmd_buf,
+        conemap_obj,
+        conemap_obj->getPrtShadowGenLowResTexDescSet(),
+        block_offset,
+        glm::vec2(float(downscale)),
+        g_block_size / glm::uvec2(downscale) + glm::uvec2(2 * kPrtBakeHaloSize),
+        kPrtBakeHaloSize,
+        collect_adaptive_stats);
+
+    renderer::helper::transitMapTextureFromStoreImage(
+        cmd_buf,
+        { prt_low_res_texes_->image },
+        renderer::ImageLayout::GENERAL);
+
+    renderer::helper::transitMapTextureToStoreImage(
+        cmd_buf,
+        { prt_texes_->image });
+
+    cmd_buf->bindPipeline(
+        renderer::PipelineBindPoint::COMPUTE,
+        prt_upsample_pipeline_);
+    glsl::PrtUpsampleParams params = {};
+    params.size = src_size;
+    params.block_offset = block_offset;
+    params.scale = downscale;
+    params.halo_size = kPrtBakeHaloSize;
+    params.depth_channel = conemap_obj->getDepthChannel();
+    params.shadow_intensity = conemap_obj->getShadowIntensity();
+    params.depth_sigma = kPrtUpsampleDepthSigma;
+    params.normal_power = kPrtUpsampleNormalPower;
+    params.is_tileable = conemap_obj->isTileable() ? 1 : 0;
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+        prt_upsample_pipeline_layout_,
+        &params,
+        sizeof(params));
+
+    cmd_buf->bindDescriptorSets(
+        renderer::PipelineBindPoint::COMPUTE,
+        prt_upsample_pipeline_layout_,
+        { conemap_obj->getPrtUpsampleTexDescSet() });
+
+    cmd_buf->dispatch(
+        (g_block_size.x + 7) / 8,
+        (g_block_size.y + 7) / 8,
+        1);
+
+    renderer::helper::transitMapTextureFromStoreImage(
+        cmd_buf,
+        { prt_texes_->image },
+        renderer::ImageLayout::GENERAL);
+}
+
+void PrtShadow::recordPackBlock(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    const glm::uvec2& block_index,
+    uint32_t pack_mode,
+    bool store_packed) {
+    renderer::helper::transitMapTextureToStoreImage(cmd_buf, { conemap_obj->getPackTexture()->image });
+
+    cmd_buf->bindPipeline(
+        renderer::PipelineBindPoint::COMPUTE,
+        pack_prt_pipeline_);
+
+    glsl::PrtPackParams params = {};
+    params.size = g_block_size;
+    params.block_index = block_index;
+    params.block_offset = block_index * g_block_size;
+    params.range_scale = 1.0f;
+    params.pack_mode = pack_mode;
+    params.collect_error = collect_pack_error_ ? 1 : 0;
+    params.store_packed = store_packed ? 1 : 0;
+
+    cmd_buf->pushConstants(
+        SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+        pack_prt_pipeline_layout_,
+        &params,
+        sizeof(params));
+
+    cmd_buf->bindDescriptorSets(
+        renderer::PipelineBindPoint::COMPUTE,
+        pack_prt_pipeline_layout_,
+        { conemap_obj->getPackPrtTexDescSet() });
+
+    cmd_buf->dispatch(
+        (g_block_size.x + 7) / 8,
+        (g_block_size.y + 7) / 8,
+        1);
+
+    if (store_packed) {
+        cmd_buf->addImageBarrier(
+            conemap_obj->getPackTexture()->image,
+            er::Helper::getImageAsStore(),
+            er::Helper::getImageAsStore());
+    }
+}
 
+void PrtShadow::updatePackInfo(
+    const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+    const std::vector<glm::uvec2>& block_indexes,
+    float range_scale,
+    uint32_t pack_mode) {
     {
         er::helper::transitMapTextureToStoreImage(
             cmd_buf,
@@ -460,23 +1118,27 @@ void PrtShadow::update(
             renderer::PipelineBindPoint::COMPUTE,
             gen_prt_pack_info_pipeline_);
 
-        glsl::PrtPackParams params = {};
-        params.size = (g_block_size + uvec2(15)) / uvec2(16);
-        params.block_index = glm::uvec2(0);
-        params.range_scale = 1.2f;
-
-        cmd_buf->pushConstants(
-            SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-            gen_prt_pack_info_pipeline_layout_,
-            &params,
-            sizeof(params));
-
         cmd_buf->bindDescriptorSets(
             renderer::PipelineBindPoint::COMPUTE,
             gen_prt_pack_info_pipeline_layout_,
             { conemap_obj->getGenPrtPackInfoTexDescSet() });
 
-        cmd_buf->dispatch(1, 1, 1);
+        glsl::PrtPackParams params = {};
+        params.size = (g_block_size + uvec2(15)) / uvec2(16);
+        params.range_scale = range_scale;
+        params.pack_mode = pack_mode;
+
+        for (const auto& block_index : block_indexes) {
+            params.block_index = block_index;
+
+            cmd_buf->pushConstants(
+                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
+                gen_prt_pack_info_pipeline_layout_,
+                &params,
+                sizeof(params));
+
+            cmd_buf->dispatch(1, 1, 1);
+        }
 
         er::BarrierList barrier_list;
         er::helper::addTexturesToBarrierList(
@@ -491,217 +1153,278 @@ void PrtShadow::update(
             SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT),
             SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT));
     }
+}
 
-    auto block_count =
-        (src_size + g_block_size - glm::uvec2(1)) / g_block_size;
-
-    auto num_passes = block_count.x * block_count.y;
-
-    for (uint p = 0; p < num_passes; p++) {
-        uint block_x = p % block_count.x;
-        uint block_y = p / block_count.x;
-
-        // cache shadow ray's tangent value.
-        {
-            renderer::helper::transitMapTextureToStoreImage(
-                cmd_buf,
-                { prt_shadow_cache_texes_->image });
-
-            cmd_buf->bindPipeline(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_cache_pipeline_);
-            glsl::PrtGenParams params = {};
-            params.size = src_size;
-            params.inv_size =
-                glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
-            params.block_offset =
-                glm::uvec2(block_x, block_y) * g_block_size;
-            params.shadow_intensity = conemap_obj->getShadowIntensity();
-            params.depth_channel = conemap_obj->getDepthChannel();
-            params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
-            params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
-
-            cmd_buf->pushConstants(
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                prt_shadow_cache_pipeline_layout_,
-                &params,
-                sizeof(params));
-
-            cmd_buf->bindDescriptorSets(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_cache_pipeline_layout_,
-                { conemap_obj->getPrtShadowCacheTexDescSet() });
-
-            cmd_buf->dispatch(
-                (g_block_size.x + kConemapGenDispatchX - 1) / kConemapGenDispatchX,
-                (g_block_size.y + kConemapGenDispatchY - 1) / kConemapGenDispatchY,
-                1);
-
-            renderer::helper::transitMapTextureFromStoreImage(
-                cmd_buf,
-                { prt_shadow_cache_texes_->image },
-                renderer::ImageLayout::GENERAL);
+void PrtShadow::reportPackError(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    glsl::PrtPackStats pack_stats[kPrtPackModeCount] = {};
+    device->dumpBufferMemory(
+        prt_pack_stats_buffer_->memory,
+        sizeof(pack_stats),
+        pack_stats);
+
+    // repack the last baked block a number of times per mode, the bake's own mode goes last
+    // so the pack texture ends up as baked. error collection stays off while timing.
+    const uint32_t num_bench_dispatches = 64;
+    const uint32_t bench_modes[kPrtPackModeCount] = {
+        pack_mode_ == kPrtPackGlobalUniform ? uint32_t(kPrtPackBlockBanded) : uint32_t(kPrtPackGlobalUniform),
+        pack_mode_ };
+    double pack_throughput[kPrtPackModeCount] = {};
+    auto saved_collect_pack_error = collect_pack_error_;
+    collect_pack_error_ = false;
+    for (auto pack_mode : bench_modes) {
+        auto start_point = std::chrono::high_resolution_clock::now();
+        const auto& cmd_buf = device->setupTransientCommandBuffer();
+        for (uint32_t i = 0; i < num_bench_dispatches; i++) {
+            recordPackBlock(cmd_buf, conemap_obj, last_block_index_, pack_mode, true);
         }
+        device->submitAndWaitTransientCommandBuffer();
+        auto end_point = std::chrono::high_resolution_clock::now();
+        double seconds = std::chrono::duration<double>(end_point - start_point).count();
+        pack_throughput[pack_mode] =
+            double(num_bench_dispatches) * g_block_size.x * g_block_size.y * 25 /
+            std::max(seconds, 1e-9);
+    }
+    collect_pack_error_ = saved_collect_pack_error;
 
-        // go through all the other cache blocks, update cache shadow ray's tangent value.
-        {
-            auto block_cache_num_x =
-                (src_size.x + kConemapGenBlockCacheSizeX - 1) / kConemapGenBlockCacheSizeX;
-            auto block_cache_num_y =
-                (src_size.y + kConemapGenBlockCacheSizeY - 1) / kConemapGenBlockCacheSizeY;
-            auto total_block_num = block_cache_num_x * block_cache_num_y;
-
-            cmd_buf->bindPipeline(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_cache_update_pipeline_);
-
-            cmd_buf->bindDescriptorSets(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_cache_update_pipeline_layout_,
-                { conemap_obj->getPrtShadowCacheUpdateTexDescSet() });
-
-            glsl::PrtShadowCacheGenParams params = {};
-            params.size = src_size;
-            params.inv_size = glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
-            params.depth_channel = conemap_obj->getDepthChannel();
-            params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
-            params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
-            params.shadow_intensity = conemap_obj->getShadowIntensity();
-
-            std::vector<uint32_t> block_indexes;
-            block_indexes.reserve(total_block_num);
-            for (int i = 0; i < int(total_block_num); i++) {
-                int y = i / block_cache_num_x;
-                int x = i % block_cache_num_x;
-
-                if (x >= int(block_x - kPrtShadowInitBlockRadius) &&
-                    x <= int(block_x + kPrtShadowInitBlockRadius) &&
-                    y >= int(block_y - kPrtShadowInitBlockRadius) &&
-                    y <= int(block_y + kPrtShadowInitBlockRadius)) {
-                    continue;
-                }
-
-                glm::vec2 block_diff =
-                    glm::vec2(x, y) - glm::vec2(block_x, block_y);
-                float dist = glm::length(block_diff);
-                uint32_t pack_value =
-                    (uint32_t(dist * 256.0f) << 16) | (y << 8) | x;
-
-                block_indexes.push_back(pack_value);
-            }
-
-            std::sort(block_indexes.begin(), block_indexes.end());
-
-            for (auto& block_index : block_indexes) {
-                int y = (block_index >> 8) & 0xff;
-                int x = block_index & 0xff;
-
-                params.block_index =
-                    glm::uvec2(x, y);
-                params.block_offset =
-                    glm::uvec2(
-                        x * kConemapGenBlockCacheSizeX,
-                        y * kConemapGenBlockCacheSizeY);
-                params.dst_block_offset =
-                    glm::uvec2(
-                        block_x * kConemapGenBlockCacheSizeX,
-                        block_y * kConemapGenBlockCacheSizeY);
-
-                cmd_buf->pushConstants(
-                    SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                    prt_shadow_cache_update_pipeline_layout_,
-                    &params,
-                    sizeof(params));
-
-                cmd_buf->dispatch(
-                    (g_block_size.x + kConemapGenDispatchX - 1) / kConemapGenDispatchX,
-                    (g_block_size.y + kConemapGenDispatchY - 1) / kConemapGenDispatchY,
-                    1);
-
-                renderer::helper::transitMapTextureToStoreImage(
-                    cmd_buf,
-                    { prt_shadow_cache_texes_->image });
-            }
+    for (uint32_t pack_mode = 0; pack_mode < kPrtPackModeCount; pack_mode++) {
+        const auto& stats = pack_stats[pack_mode];
+        if (stats.num_coeffs == 0) {
+            continue;
         }
 
-        // create prt textures.
-        {
-            renderer::helper::transitMapTextureToStoreImage(
-                cmd_buf,
-                { prt_texes_->image });
-
-            cmd_buf->bindPipeline(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_gen_with_cache_pipeline_);
-            glsl::PrtGenParams params = {};
-            params.size = src_size;
-            params.inv_size = glm::vec2(1.0f / params.size.x, 1.0f / params.size.y);
-            params.block_offset =
-                glm::uvec2(block_x, block_y) * g_block_size;
-            params.shadow_intensity = conemap_obj->getShadowIntensity();
-            params.depth_channel = conemap_obj->getDepthChannel();
-            params.is_height_map = conemap_obj->isHeightMap() ? 1 : 0;
-            params.shadow_noise_thread = conemap_obj->getShadowNoiseThread();
-
-            cmd_buf->pushConstants(
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                prt_shadow_gen_with_cache_pipeline_layout_,
-                &params,
-                sizeof(params));
-
-            cmd_buf->bindDescriptorSets(
-                renderer::PipelineBindPoint::COMPUTE,
-                prt_shadow_gen_with_cache_pipeline_layout_,
-                { prt_shadow_gen_with_cache_tex_desc_set_ });
+        double sum_sq_error =
+            (double(stats.sum_sq_error_hi) * 4294967296.0 +
+             double(stats.sum_sq_error_lo)) / kPrtPackErrorScale;
+        std::cout <<
+            "prt pack error (" <<
+            (pack_mode == kPrtPackGlobalUniform ? "global range, 5 bits" : "block range, banded bits") <<
+            (pack_mode == pack_mode_ ? "" : ", reference") <<
+            "): rms " <<
+            std::sqrt(sum_sq_error / double(stats.num_coeffs)) <<
+            ", max " <<
+            std::bit_cast<float>(stats.max_error) <<
+            ", coeffs " <<
+            stats.num_coeffs <<
+            ", pack " <<
+            pack_throughput[pack_mode] / 1.0e6 <<
+            " Mcoeffs/s" <<
+            std::endl;
+    }
 
-            cmd_buf->dispatch(
-                (g_block_size.x + kPrtShadowGenDispatchX - 1) / kPrtShadowGenDispatchX,
-                (g_block_size.y + kPrtShadowGenDispatchY - 1) / kPrtShadowGenDispatchY,
-                1);
+    for (auto& stats : pack_stats) {
+        stats = {};
+    }
+    device->updateBufferMemory(
+        prt_pack_stats_buffer_->memory,
+        sizeof(pack_stats),
+        pack_stats);
+}
 
-            renderer::helper::transitMapTextureFromStoreImage(
-                cmd_buf,
-                { prt_texes_->image },
-                renderer::ImageLayout::GENERAL);
+void PrtShadow::reportAdaptiveSampling(
+    const std::shared_ptr<renderer::Device>& device) {
+    glsl::PrtAdaptiveStats adaptive_stats{};
+    device->dumpBufferMemory(
+        prt_adaptive_stats_buffer_->memory,
+        sizeof(adaptive_stats),
+        &adaptive_stats);
+
+    if (adaptive_stats.num_pixels > 0) {
+        double sum_samples =
+            double(adaptive_stats.sum_samples_hi) * 4294967296.0 +
+            double(adaptive_stats.sum_samples_lo);
+        double sum_error =
+            (double(adaptive_stats.sum_error_hi) * 4294967296.0 +
+             double(adaptive_stats.sum_error_lo)) / kPrtAdaptiveErrorScale;
+        double avg_samples = sum_samples / double(adaptive_stats.num_pixels);
+        std::cout <<
+            "prt adaptive sampling (tolerance " << adaptive_tolerance_ <<
+            "): avg azimuths " << avg_samples <<
+            " of " << kPrtPhiSampleCount <<
+            " (" << kPrtPhiSampleCount / avg_samples << "x fewer)" <<
+            ", avg error " << sum_error / double(adaptive_stats.num_pixels) <<
+            ", max error " << std::bit_cast<float>(adaptive_stats.max_error) <<
+            ", pixels per level";
+        for (int l = 0; l < kPrtAdaptivePhiLevelCount; l++) {
+            std::cout << " " << (kPrtAdaptivePhiBaseCount << l) << ":" << adaptive_stats.level_pixels[l];
         }
+        std::cout << std::endl;
+    }
 
-        {
-            renderer::helper::transitMapTextureToStoreImage(cmd_buf, { conemap_obj->getPackTexture()->image });
-
-            cmd_buf->bindPipeline(
-                renderer::PipelineBindPoint::COMPUTE,
-                pack_prt_pipeline_);
+    adaptive_stats = {};
+    device->updateBufferMemory(
+        prt_adaptive_stats_buffer_->memory,
+        sizeof(adaptive_stats),
+        &adaptive_stats);
+}
 
-            glsl::PrtPackParams params = {};
-            params.size = g_block_size;
-            params.block_index =
-                glm::uvec2(block_x, block_y);
-            params.block_offset =
-                glm::uvec2(block_x, block_y) * g_block_size;
-            params.range_scale = 1.0f;
+void PrtShadow::compareBakeModes(
+    const std::shared_ptr<renderer::Device>& device,
+    const std::shared_ptr<game_object::ConemapObj>& conemap_obj) {
+    auto src_size =
+        glm::uvec2(conemap_obj->getPackTexture()->size);
+    auto block_count =
+        (src_size + g_block_size - glm::uvec2(1)) / g_block_size;
+    auto block_offset = block_count / glm::uvec2(2) * g_block_size;
+
+    const uint64_t readback_size =
+        uint64_t(prt_texes_->size.x) * prt_texes_->size.y * 4 * sizeof(float);
+    auto readback_buffer = std::make_shared<renderer::BufferInfo>();
+    device->createBuffer(
+        readback_size,
+        SET_FLAG_BIT(BufferUsage, TRANSFER_DST_BIT),
+        SET_FLAG_BIT(MemoryProperty, HOST_VISIBLE_BIT) |
+        SET_FLAG_BIT(MemoryProperty, HOST_COHERENT_BIT),
+        0,
+        readback_buffer->buffer,
+        readback_buffer->memory);
+
+    auto saved_conemap_horizon_search = use_conemap_horizon_search_;
+    auto saved_adaptive_tolerance = adaptive_tolerance_;
+
+    // one submission per bake, the time covers the bake plus the same small readback every time.
+    auto bakeBlock = [&](auto record_bake, std::vector<float>& coeffs) {
+        auto start_point = std::chrono::high_resolution_clock::now();
+        const auto& cmd_buf = device->setupTransientCommandBuffer();
+        record_bake(cmd_buf);
+
+        cmd_buf->addImageBarrier(
+            prt_texes_->image,
+            { renderer::ImageLayout::GENERAL,
+              SET_FLAG_BIT(Access, SHADER_WRITE_BIT),
+              SET_FLAG_BIT(PipelineStage, COMPUTE_SHADER_BIT) },
+            { renderer::ImageLayout::GENERAL,
+              SET_FLAG_BIT(Access, TRANSFER_READ_BIT),
+              SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) });
+
+        std::vector<renderer::BufferImageCopyInfo> copy_regions(1);
+        auto& region = copy_regions[0];
+        region.buffer_offset = 0;
+        region.buffer_row_length = 0;
+        region.buffer_image_height = 0;
+        region.image_subresource.aspect_mask = SET_FLAG_BIT(ImageAspect, COLOR_BIT);
+        region.image_subresource.mip_level = 0;
+        region.image_subresource.base_array_layer = 0;
+        region.image_subresource.layer_count = 1;
+        region.image_offset = glm::ivec3(0);
+        region.image_extent = glm::uvec3(prt_texes_->size.x, prt_texes_->size.y, 1);
+        cmd_buf->copyImageToBuffer(
+            prt_texes_->image,
+            readback_buffer->buffer,
+            copy_regions,
+            renderer::ImageLayout::GENERAL);
 
-            cmd_buf->pushConstants(
-                SET_FLAG_BIT(ShaderStage, COMPUTE_BIT),
-                pack_prt_pipeline_layout_,
-                &params,
-                sizeof(params));
+        cmd_buf->addBufferBarrier(
+            readback_buffer->buffer,
+            { SET_FLAG_BIT(Access, TRANSFER_WRITE_BIT), SET_FLAG_BIT(PipelineStage, TRANSFER_BIT) },
+            { SET_FLAG_BIT(Access, HOST_READ_BIT), SET_FLAG_BIT(PipelineStage, HOST_BIT) },
+            uint32_t(readback_size));
+        device->submitAndWaitTransientCommandBuffer();
+
+        auto end_point = std::chrono::high_resolution_clock::now();
+        coeffs.resize(readback_size / sizeof(float));
+        device->dumpBufferMemory(
+            readback_buffer->memory,
+            readback_size,
+            coeffs.data());
+
+        return std::chrono::duration<double, std::milli>(end_point - start_point).count();
+    };
+
+    // every azimuth of every pixel marched directly, with the pipeline picked by
+    // use_conemap_horizon_search_ and adaptive_tolerance_.
+    bool collect_adaptive_stats = false;
+    glm::uvec2 march_block_offset = block_offset;
+    auto marchBlock = [&](const std::shared_ptr<renderer::CommandBuffer>& cmd_buf) {
+        renderer::helper::transitMapTextureToStoreImage(
+            cmd_buf,
+            { prt_texes_->image });
 
-            cmd_buf->bindDescriptorSets(
-                renderer::PipelineBindPoint::COMPUTE,
-                pack_prt_pipeline_layout_,
-                { conemap_obj->getPackPrtTexDescSet() });
+        dispatchPrtShadowGen(
+            cmd_buf,
+            conemap_obj,
+            conemap_obj->getPrtShadowGenTexDescSet(),
+            march_block_offset,
+            glm::vec2(1.0f),
+            g_block_size,
+            0,
+            collect_adaptive_stats);
+    };
+
+    std::vector<float> reference_coeffs, coeffs;
+    use_conemap_horizon_search_ = false;
+    adaptive_tolerance_ = 0.0f;
+    auto reference_ms = bakeBlock(marchBlock, reference_coeffs);
+    std::cout <<
+        "prt bake compare, block at " << block_offset.x << ", " << block_offset.y <<
+        ": brute force " << reference_ms << "ms" << std::endl;
+
+    auto printBakeMode = [&](const char* name, double ms) {
+        std::cout <<
+            "prt bake compare, " << name << ": " << ms << "ms (" <<
+            reference_ms / std::max(ms, 1e-6) << "x), max coeff diff " <<
+            getMaxPrtCoeffDiff(reference_coeffs, coeffs) << std::endl;
+    };
+
+    use_conemap_horizon_search_ = true;
+    printBakeMode("conemap horizon search", bakeBlock(marchBlock, coeffs));
+
+    // the bake reported and reset its own adaptive stats already, these cover this block only.
+    adaptive_tolerance_ =
+        saved_adaptive_tolerance > 0.0f ? saved_adaptive_tolerance : kPrtCompareAdaptiveTolerance;
+    collect_adaptive_stats = true;
+    printBakeMode("adaptive azimuths", bakeBlock(marchBlock, coeffs));
+    reportAdaptiveSampling(device);
+
+    // the full resolution default, fused cache update over all the source blocks in range.
+    adaptive_tolerance_ = 0.0f;
+    printBakeMode(
+        "shadow ray tangent cache",
+        bakeBlock([&](const std::shared_ptr<renderer::CommandBuffer>& cmd_buf) {
+            recordTangentCacheBake(cmd_buf, conemap_obj, block_offset / g_block_size);
+        }, coeffs));
+
+    // half resolution plus halo, upsampled back to the full block.
+    printBakeMode(
+        "2x downscale and upsample",
+        bakeBlock([&](const std::shared_ptr<renderer::CommandBuffer>& cmd_buf) {
+            recordLowResBake(cmd_buf, conemap_obj, block_offset, 2, false);
+        }, coeffs));
+
+    // wrap seam of the center block row, brute force so the non wrapped conemap stays out
+    // of it. the first and last source columns are neighbours on a tiled surface, with the
+    // wrap aware bake their coefficients should step about as much as interior neighbours.
+    auto saved_tileable = conemap_obj->isTileable();
+    auto saved_wrap_radius = conemap_obj->getTileWrapRadius();
+    auto last_column_offset = (src_size.x - 1) / g_block_size.x * g_block_size.x;
+    auto last_column = src_size.x - 1 - last_column_offset;
+    auto num_rows = std::min(g_block_size.y, src_size.y - block_offset.y);
+    use_conemap_horizon_search_ = false;
+
+    std::vector<float> first_coeffs, last_coeffs;
+    float seam_steps[2];
+    for (int wrap = 0; wrap < 2; wrap++) {
+        conemap_obj->setTileable(
+            wrap == 1,
+            saved_tileable ? saved_wrap_radius : horizon_radius_);
+        march_block_offset = glm::uvec2(0, block_offset.y);
+        bakeBlock(marchBlock, first_coeffs);
+        march_block_offset = glm::uvec2(last_column_offset, block_offset.y);
+        bakeBlock(marchBlock, last_coeffs);
+        seam_steps[wrap] = getMeanPrtColumnStep(last_coeffs, last_column, first_coeffs, 0, num_rows);
+    }
+    conemap_obj->setTileable(saved_tileable, saved_wrap_radius);
 
-            cmd_buf->dispatch(
-                (g_block_size.x + 7) / 8,
-                (g_block_size.y + 7) / 8,
-                1);
+    std::cout <<
+        "prt bake compare, wrap seam at row " << block_offset.y <<
+        ": interior column step " << getMeanPrtColumnStep(first_coeffs, 0, first_coeffs, 1, num_rows) <<
+        ", seam step clipped " << seam_steps[0] <<
+        ", wrap aware " << seam_steps[1] << std::endl;
 
-            cmd_buf->addImageBarrier(
-                conemap_obj->getPackTexture()->image,
-                er::Helper::getImageAsStore(),
-                er::Helper::getImageAsStore());
-        }
-    }
+    use_conemap_horizon_search_ = saved_conemap_horizon_search;
+    adaptive_tolerance_ = saved_adaptive_tolerance;
+    readback_buffer->destroy(device);
 }
 
 void PrtShadow::destroy(
@@ -719,22 +1442,54 @@ void PrtShadow::destroy(
         prt_shadow_cache_texes_->destroy(device);
     }
 
+    if (prt_low_res_texes_) {
+        prt_low_res_texes_->destroy(device);
+    }
+
+    if (prt_zonal_lut_buffer_) {
+        prt_zonal_lut_buffer_->destroy(device);
+    }
+
+    if (prt_pack_stats_buffer_) {
+        prt_pack_stats_buffer_->destroy(device);
+    }
+
+    if (prt_adaptive_stats_buffer_) {
+        prt_adaptive_stats_buffer_->destroy(device);
+    }
+
+    if (prt_cache_block_list_buffer_) {
+        prt_cache_block_list_buffer_->destroy(device);
+    }
+
     device->destroyDescriptorSetLayout(prt_shadow_gen_with_cache_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_shadow_gen_with_cache_desc_update_template_);
     device->destroyPipelineLayout(prt_shadow_gen_with_cache_pipeline_layout_);
     device->destroyPipeline(prt_shadow_gen_with_cache_pipeline_);
     device->destroyDescriptorSetLayout(prt_shadow_cache_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_shadow_cache_desc_update_template_);
     device->destroyPipelineLayout(prt_shadow_cache_pipeline_layout_);
     device->destroyPipeline(prt_shadow_cache_pipeline_);
     device->destroyDescriptorSetLayout(prt_shadow_cache_update_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_shadow_cache_update_desc_update_template_);
     device->destroyPipelineLayout(prt_shadow_cache_update_pipeline_layout_);
     device->destroyPipeline(prt_shadow_cache_update_pipeline_);
     device->destroyDescriptorSetLayout(prt_shadow_gen_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_shadow_gen_desc_update_template_);
     device->destroyPipelineLayout(prt_shadow_gen_pipeline_layout_);
     device->destroyPipeline(prt_shadow_gen_pipeline_);
+    device->destroyPipeline(prt_shadow_gen_conemap_pipeline_);
+    device->destroyDescriptorSetLayout(prt_upsample_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_upsample_desc_update_template_);
+    device->destroyPipelineLayout(prt_upsample_pipeline_layout_);
+    device->destroyPipeline(prt_upsample_pipeline_);
 
     device->destroyDescriptorSetLayout(prt_ds_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(prt_ds_desc_update_template_);
     device->destroyDescriptorSetLayout(gen_prt_pack_info_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(gen_prt_pack_info_desc_update_template_);
     device->destroyDescriptorSetLayout(pack_prt_desc_set_layout_);
+    device->destroyDescriptorUpdateTemplate(pack_prt_desc_update_template_);
     device->destroyPipelineLayout(prt_ds_first_pipeline_layout_);
     device->destroyPipeline(prt_ds_first_pipeline_);
     device->destroyPipelineLayout(gen_prt_pack_info_pipeline_layout_);
@@ -11,15 +11,23 @@ namespace engine {
     namespace scene_rendering {
 
         class PrtShadow {
-            const uint32_t s_max_prt_buffer_size = 4096;
-
             std::shared_ptr<renderer::DescriptorSetLayout> prt_shadow_cache_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> prt_shadow_cache_update_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> prt_shadow_gen_with_cache_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> prt_shadow_gen_desc_set_layout_;
+            std::shared_ptr<renderer::DescriptorSetLayout> prt_upsample_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> prt_ds_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> gen_prt_pack_info_desc_set_layout_;
             std::shared_ptr<renderer::DescriptorSetLayout> pack_prt_desc_set_layout_;
+            // one per layout above, built from the same bindings.
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_shadow_cache_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_shadow_cache_update_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_shadow_gen_with_cache_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_shadow_gen_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_upsample_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> prt_ds_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> gen_prt_pack_info_desc_update_template_;
+            std::shared_ptr<renderer::DescriptorUpdateTemplate> pack_prt_desc_update_template_;
             std::shared_ptr<renderer::PipelineLayout> prt_shadow_cache_pipeline_layout_;
             std::shared_ptr<renderer::Pipeline> prt_shadow_cache_pipeline_;
             std::shared_ptr<renderer::PipelineLayout> prt_shadow_cache_update_pipeline_layout_;
@@ -28,6 +36,9 @@ namespace engine {
             std::shared_ptr<renderer::Pipeline> prt_shadow_gen_with_cache_pipeline_;
             std::shared_ptr<renderer::PipelineLayout> prt_shadow_gen_pipeline_layout_;
             std::shared_ptr<renderer::Pipeline> prt_shadow_gen_pipeline_;
+            std::shared_ptr<renderer::Pipeline> prt_shadow_gen_conemap_pipeline_;
+            std::shared_ptr<renderer::PipelineLayout> prt_upsample_pipeline_layout_;
+            std::shared_ptr<renderer::Pipeline> prt_upsample_pipeline_;
             std::shared_ptr<renderer::PipelineLayout> prt_ds_first_pipeline_layout_;
             std::shared_ptr<renderer::Pipeline> prt_ds_first_pipeline_;
             std::shared_ptr<renderer::PipelineLayout> gen_prt_pack_info_pipeline_layout_;
@@ -40,6 +51,72 @@ namespace engine {
             std::shared_ptr<renderer::TextureInfo> prt_texes_;
             std::shared_ptr<renderer::TextureInfo> prt_ds_texes_;
             std::shared_ptr<renderer::TextureInfo> prt_shadow_cache_texes_;
+            std::shared_ptr<renderer::TextureInfo> prt_low_res_texes_;
+            std::shared_ptr<renderer::BufferInfo> prt_zonal_lut_buffer_;
+            std::shared_ptr<renderer::BufferInfo> prt_cache_block_list_buffer_;
+
+            std::shared_ptr<renderer::BufferInfo> prt_pack_stats_buffer_;
+            std::shared_ptr<renderer::BufferInfo> prt_adaptive_stats_buffer_;
+
+            // skip empty space of horizon rays with conemap and minmax depth.
+            bool use_conemap_horizon_search_ = true;
+            // kPrtPackGlobalUniform or kPrtPackBlockBanded.
+            uint32_t pack_mode_ = kPrtPackBlockBanded;
+            bool collect_pack_error_ = false;
+            // refine azimuths per pixel until the sh change drops below this, 0 bakes
+            // every azimuth through the shadow ray tangent cache.
+            float adaptive_tolerance_ = 0.0f;
+            bool collect_adaptive_stats_ = false;
+            // 1 bakes every pixel, 2 or 4 bake a reduced grid and upsample it guided by the height.
+            uint32_t bake_downscale_ = 1;
+            // horizon rays stop this many pixels away, sources up to this size see the whole texture.
+            uint32_t horizon_radius_ = 4096;
+            // its coefficients are still in prt_texes_ after the bake, the pack benchmark reuses them.
+            glm::uvec2 last_block_index_ = glm::uvec2(0);
+
+            // tileable sources also stop at the tile wrap radius.
+            uint32_t getHorizonRadius(
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj) const;
+
+            void dispatchPrtShadowGen(
+                const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                const std::shared_ptr<renderer::DescriptorSet>& desc_set,
+                const glm::uvec2& block_offset,
+                const glm::vec2& pixel_sample_size,
+                const glm::uvec2& dispatch_size,
+                uint32_t halo_size,
+                bool collect_adaptive_stats);
+
+            // bakes all the kPrtPhiSampleCount azimuths of the block through the shadow ray
+            // tangent cache, filled by one fused dispatch over every source block in range.
+            void recordTangentCacheBake(
+                const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                const glm::uvec2& block_index);
+
+            // bakes every downscale pixel of the block plus a halo into prt_low_res_texes_, then
+            // upsamples it guided by height and normal into prt_texes_.
+            void recordLowResBake(
+                const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                const glm::uvec2& block_offset,
+                uint32_t downscale,
+                bool collect_adaptive_stats);
+
+            void updatePackInfo(
+                const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                const std::vector<glm::uvec2>& block_indexes,
+                float range_scale,
+                uint32_t pack_mode);
+
+            void recordPackBlock(
+                const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                const glm::uvec2& block_index,
+                uint32_t pack_mode,
+                bool store_packed);
 
         public:
             PrtShadow(
@@ -47,9 +124,55 @@ namespace engine {
                 const std::shared_ptr<renderer::DescriptorPool>& descriptor_pool,
                 const std::shared_ptr<renderer::Sampler>& texture_sampler);
 
+            // one pass per prt block, a bake can be split into any number of pass ranges
+            // recorded into separate submissions, as long as pass 0 goes first.
+            uint32_t getNumPasses(
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj) const;
+
             void update(
                 const std::shared_ptr<renderer::CommandBuffer>& cmd_buf,
-                const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj,
+                uint32_t pass_start,
+                uint32_t pass_end);
+
+            inline void setConemapHorizonSearch(bool enable) {
+                use_conemap_horizon_search_ = enable;
+            }
+
+            inline void setPackMode(uint32_t pack_mode) {
+                pack_mode_ = pack_mode;
+            }
+
+            inline void setCollectPackError(bool enable) {
+                collect_pack_error_ = enable;
+            }
+
+            inline void setAdaptiveSampling(float tolerance) {
+                adaptive_tolerance_ = tolerance;
+            }
+
+            inline void setCollectAdaptiveStats(bool enable) {
+                collect_adaptive_stats_ = enable;
+            }
+
+            inline void setHorizonRadius(uint32_t radius) {
+                horizon_radius_ =
+                    std::min(
+                        std::max(radius, uint32_t(kConemapGenBlockCacheSizeX)),
+                        uint32_t(kPrtMaxHorizonBlockRadius * kConemapGenBlockCacheSizeX));
+            }
+
+            inline void setBakeDownscale(uint32_t downscale) {
+                bake_downscale_ = downscale >= 4 ? 4 : (downscale >= 2 ? 2 : 1);
+            }
+
+            inline const std::shared_ptr<renderer::BufferInfo>& getPrtPackStatsBuffer() {
+                return prt_pack_stats_buffer_;
+            }
+
+            inline const std::shared_ptr<renderer::BufferInfo>& getPrtAdaptiveStatsBuffer() {
+                return prt_adaptive_stats_buffer_;
+            }
 
             inline const std::shared_ptr<renderer::TextureInfo>& getPrtTextures() {
                 return prt_texes_;
@@ -63,26 +186,83 @@ namespace engine {
                 return prt_shadow_cache_texes_;
             }
 
+            inline const std::shared_ptr<renderer::TextureInfo>& getPrtLowResTextures() {
+                return prt_low_res_texes_;
+            }
+
+            inline const std::shared_ptr<renderer::BufferInfo>& getPrtZonalLutBuffer() {
+                return prt_zonal_lut_buffer_;
+            }
+
+            inline const std::shared_ptr<renderer::BufferInfo>& getPrtCacheBlockListBuffer() {
+                return prt_cache_block_list_buffer_;
+            }
+
             inline const std::shared_ptr<renderer::DescriptorSetLayout>& getPrtShadowGenDescSetLayout() {
                 return prt_shadow_gen_desc_set_layout_;
             }
 
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getPrtShadowGenDescUpdateTemplate() {
+                return prt_shadow_gen_desc_update_template_;
+            }
+
+            inline const std::shared_ptr<renderer::DescriptorSetLayout>& getPrtUpsampleDescSetLayout() {
+                return prt_upsample_desc_set_layout_;
+            }
+
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getPrtUpsampleDescUpdateTemplate() {
+                return prt_upsample_desc_update_template_;
+            }
+
             inline const std::shared_ptr<renderer::DescriptorSetLayout>& getPrtShadowCacheDescSetLayout() {
                 return prt_shadow_cache_desc_set_layout_;
             }
 
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getPrtShadowCacheDescUpdateTemplate() {
+                return prt_shadow_cache_desc_update_template_;
+            }
+
             inline const std::shared_ptr<renderer::DescriptorSetLayout>& getPrtShadowCacheUpdateDescSetLayout() {
                 return prt_shadow_cache_update_desc_set_layout_;
             }
+
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getPrtShadowCacheUpdateDescUpdateTemplate() {
+                return prt_shadow_cache_update_desc_update_template_;
+            }
                 
             inline const std::shared_ptr<renderer::DescriptorSetLayout>& getGenPrtPackInfoDescSetLayout() {
                 return gen_prt_pack_info_desc_set_layout_;
             }
 
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getGenPrtPackInfoDescUpdateTemplate() {
+                return gen_prt_pack_info_desc_update_template_;
+            }
+
             inline const std::shared_ptr<renderer::DescriptorSetLayout>& getPackPrtDescSetLayout() {
                 return pack_prt_desc_set_layout_;
             }
 
+            inline const std::shared_ptr<renderer::DescriptorUpdateTemplate>& getPackPrtDescUpdateTemplate() {
+                return pack_prt_desc_update_template_;
+            }
+
+            // print packing error of the last bake next to the pack throughput, for the bake's own
+            // pack mode and the global range reference packed alongside it, then reset the counters.
+            void reportPackError(
+                const std::shared_ptr<renderer::Device>& device,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+
+            // print azimuth samples used and error reached by the last adaptive bake, then reset the counters.
+            void reportAdaptiveSampling(const std::shared_ptr<renderer::Device>& device);
+
+            // bakes the center block once per bake mode, each on its own submission, and prints
+            // the time taken and the max sh coefficient difference against the brute force bake.
+            // then prints the coefficient step across the wrap seam of that block row, clipped
+            // and wrap aware.
+            void compareBakeModes(
+                const std::shared_ptr<renderer::Device>& device,
+                const std::shared_ptr<game_object::ConemapObj>& conemap_obj);
+
             void destroy(const std::shared_ptr<renderer::Device>& device);
         };
 
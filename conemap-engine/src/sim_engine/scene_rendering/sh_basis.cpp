@@ -0,0 +1,48 @@
+#include "sh_basis.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace engine {
+namespace scene_rendering {
+namespace sh_detail {
+
+namespace {
+bool detectAvx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // avx also needs the os to save the ymm registers on a context switch, osxsave and
+    // xcr0 bits 1 and 2 tell.
+    __cpuid(info, 1);
+    bool has_osxsave = (info[2] & (1 << 27)) != 0;
+    bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!has_osxsave || !has_avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    // checks the xcr0 bits as well.
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+} // namespace
+
+bool hasAvx2() {
+    static const bool has_avx2 = detectAvx2();
+    return has_avx2;
+}
+
+} // namespace sh_detail
+} // namespace scene_rendering
+} // namespace engine
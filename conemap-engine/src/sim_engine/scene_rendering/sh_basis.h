@@ -0,0 +1,377 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+#include "shaders/global_definition.glsl.h"
+
+namespace engine {
+namespace scene_rendering {
+namespace sh_detail {
+
+// std::sqrt isn't constexpr, newton from above stops once it stops shrinking.
+constexpr double constSqrt(double x) {
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    double r = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 128; i++) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) {
+            break;
+        }
+        r = next;
+    }
+    return r;
+}
+
+constexpr double factorial(int n) {
+    double result = 1.0;
+    for (int i = 2; i <= n; i++) {
+        result *= i;
+    }
+    return result;
+}
+
+// getKValue of prt_sh.glsl.h, the baked prt visibility uses this normalization.
+constexpr double getKValue(int l, int m) {
+    return constSqrt(
+        constSqrt((2 * l + 1) / (4.0 * 3.14159265358979323846)) *
+        factorial(l - m) / factorial(l + m));
+}
+
+constexpr float s_k_value_literals[] = { PRT_SH_K_VALUES };
+
+constexpr bool checkKValueLiterals() {
+    int idx = 0;
+    for (int l = 0; l < 5; l++) {
+        for (int m = 0; m <= l; m++) {
+            if (float(getKValue(l, m)) != s_k_value_literals[idx++]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(
+    checkKValueLiterals(),
+    "PRT_SH_K_VALUES in global_definition.glsl.h is out of sync with getKValue.");
+
+// same op set over 1, 4 or 8 lanes. only mul/add/sub, no fma, so every path rounds alike.
+struct ScalarOps {
+    using Value = float;
+    static constexpr size_t kWidth = 1;
+    static Value load(const float* p) { return *p; }
+    static void store(float* p, Value v) { *p = v; }
+    static Value set(float v) { return v; }
+    static Value add(Value a, Value b) { return a + b; }
+    static Value sub(Value a, Value b) { return a - b; }
+    static Value mul(Value a, Value b) { return a * b; }
+};
+
+// neon is part of every arm64 target, avx2 isn't part of x64. the avx2 ops live in
+// sh_basis_avx2.cpp, the only file built with avx2 codegen, and only run once hasAvx2 said so.
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+struct SimdOps {
+    using Value = float32x4_t;
+    static constexpr size_t kWidth = 4;
+    static Value load(const float* p) { return vld1q_f32(p); }
+    static void store(float* p, Value v) { vst1q_f32(p, v); }
+    static Value set(float v) { return vdupq_n_f32(v); }
+    static Value add(Value a, Value b) { return vaddq_f32(a, b); }
+    static Value sub(Value a, Value b) { return vsubq_f32(a, b); }
+    static Value mul(Value a, Value b) { return vmulq_f32(a, b); }
+};
+#else
+using SimdOps = ScalarOps;
+#endif
+
+// cpuid plus the os saving the ymm registers, checked once. false on anything but x86.
+bool hasAvx2();
+
+// ShBasis<kBands>::evalDirectionsKernel over 8 lanes, from sh_basis_avx2.cpp. returns how
+// many leading directions it wrote, a multiple of 8, or 0 when built without avx2.
+template<int kBands>
+size_t evalDirectionsAvx2(
+    const float* x,
+    const float* y,
+    const float* z,
+    size_t count,
+    float* y_values,
+    size_t stride);
+
+} // namespace sh_detail
+
+// real sh in the prt basis: getKValue normalization, condon-shortley phase, sqrt2 on m != 0,
+// coefficient s = l * l + l + m. scalar functions follow prt_sh.glsl.h op by op with the
+// same float constants, so they give the glsl results bit for bit.
+template<int kBands>
+class ShBasis {
+    static_assert(kBands >= 1 && kBands <= 5, "legendre polynomials are only written out up to band 4.");
+
+    template<class T>
+    static constexpr std::array<T, kBands * (kBands + 1) / 2> makeKValues() {
+        std::array<T, kBands * (kBands + 1) / 2> values{};
+        for (int i = 0; i < int(values.size()); i++) {
+            if constexpr (sizeof(T) == sizeof(float)) {
+                values[i] = sh_detail::s_k_value_literals[i];
+            }
+            else {
+                int l = 0;
+                while ((l + 1) * (l + 2) / 2 <= i) {
+                    l++;
+                }
+                values[i] = T(sh_detail::getKValue(l, i - l * (l + 1) / 2));
+            }
+        }
+        return values;
+    }
+
+    // sqrt2 * getKValue(l, m) evaluated left to right in T, same as the glsl expression.
+    template<class T>
+    static constexpr std::array<T, kBands * (kBands + 1) / 2> makeScaledKValues() {
+        const T sqrt2 = T(sh_detail::constSqrt(2.0));
+        auto values = makeKValues<T>();
+        for (int l = 1; l < kBands; l++) {
+            for (int m = 1; m <= l; m++) {
+                values[getLegendreIndex(l, m)] = sqrt2 * values[getLegendreIndex(l, m)];
+            }
+        }
+        return values;
+    }
+
+    // the kernel reads its constants out of a plain array, std::array accessors would be
+    // inline functions shared with the avx2 translation unit.
+    struct KTable {
+        float values[kBands * (kBands + 1) / 2];
+    };
+
+    static constexpr KTable makeScaledKTable() {
+        KTable table{};
+        auto values = makeScaledKValues<float>();
+        for (int i = 0; i < int(values.size()); i++) {
+            table.values[i] = values[i];
+        }
+        return table;
+    }
+
+    static constexpr KTable kScaledKTable = makeScaledKTable();
+
+public:
+    static constexpr int kCoeffCount = kBands * kBands;
+    static constexpr int kLegendreCount = kBands * (kBands + 1) / 2;
+
+    static constexpr int getLegendreIndex(int l, int m) {
+        return l * (l + 1) / 2 + (m < 0 ? -m : m);
+    }
+
+    static constexpr int getCoeffIndex(int l, int m) {
+        return l * l + l + m;
+    }
+
+    static constexpr int getBand(int s) {
+        int l = 0;
+        while ((l + 1) * (l + 1) <= s) {
+            l++;
+        }
+        return l;
+    }
+
+    static constexpr std::array<float, kLegendreCount> kKValues = makeKValues<float>();
+    static constexpr std::array<float, kLegendreCount> kScaledKValues = makeScaledKValues<float>();
+    static constexpr std::array<double, kLegendreCount> kKValuesDouble = makeKValues<double>();
+    static constexpr std::array<double, kLegendreCount> kScaledKValuesDouble = makeScaledKValues<double>();
+
+    // fillPVauleTablle, associated legendre polynomials of x = cos(theta).
+    template<class T>
+    static void fillPValues(T p_value[kLegendreCount], T x) {
+        T x2 = x * x;
+        T x2_1 = T(1) - x2;
+        T x2_1sqrt = std::sqrt(x2_1);
+
+        p_value[0] = T(1);
+        if constexpr (kBands > 1) {
+            p_value[1] = x;
+            p_value[2] = -x2_1sqrt;
+        }
+        if constexpr (kBands > 2) {
+            T a00 = x * x2_1sqrt;
+            p_value[3] = T(0.5) * (T(3) * x2 - T(1));
+            p_value[4] = T(-3) * a00;
+            p_value[5] = T(3) * x2_1;
+        }
+        if constexpr (kBands > 3) {
+            T x2_1_2_3rd = x2_1sqrt * x2_1;
+            T a01 = (T(-5) * x2 + T(1)) * x2_1sqrt;
+            p_value[6] = T(0.5) * x * (T(5) * x2 - T(3));
+            p_value[7] = T(1.5) * a01;
+            p_value[8] = T(15) * x * x2_1;
+            p_value[9] = T(-15) * x2_1_2_3rd;
+        }
+        if constexpr (kBands > 4) {
+            T x2_s7 = T(7) * x2;
+            T x2_1_2_3rd = x2_1sqrt * x2_1;
+            T a02 = (-x2_s7 + T(3)) * (x * x2_1sqrt);
+            p_value[10] = T(0.125) * ((T(35) * x2 - T(30)) * x2 + T(3));
+            p_value[11] = T(2.5) * a02;
+            p_value[12] = T(7.5) * (x2_s7 - T(1)) * x2_1;
+            p_value[13] = T(-105) * x * x2_1_2_3rd;
+            p_value[14] = T(105) * (x2_1 * x2_1);
+        }
+    }
+
+    // fillPreCalculateCoeffs, normalized m >= 0 legendre terms of one theta.
+    // float follows the glsl bit for bit, double feeds the cpu side prt bakes.
+    template<class T>
+    static void fillZonalCoeffs(T coeffs[kLegendreCount], T theta) {
+        const auto& scaled_k_values = getScaledKValues<T>();
+        T p_value[kLegendreCount];
+        fillPValues<T>(p_value, std::cos(theta));
+        for (int i = 0; i < kLegendreCount; i++) {
+            coeffs[i] = scaled_k_values[i] * p_value[i];
+        }
+    }
+
+    // fillYVauleTablle(y_value, theta, phi).
+    static void fillYValues(float y_value[kCoeffCount], float theta, float phi) {
+        float zonal_coeffs[kLegendreCount];
+        fillZonalCoeffs<float>(zonal_coeffs, theta);
+        fillYValues(y_value, zonal_coeffs, phi);
+    }
+
+    // fillYVauleTablle(y_value, pre_calculate_coeffs, phi).
+    static void fillYValues(float y_value[kCoeffCount], const float zonal_coeffs[kLegendreCount], float phi) {
+        float sin_mphi[kBands], cos_mphi[kBands];
+        for (int m = 1; m < kBands; m++) {
+            sin_mphi[m] = std::sin(float(m) * phi);
+            cos_mphi[m] = std::cos(float(m) * phi);
+        }
+        // sin(1.0f * phi) is sin(phi), so band 1 matches the glsl too.
+
+        for (int l = 0; l < kBands; l++) {
+            y_value[getCoeffIndex(l, 0)] = zonal_coeffs[getLegendreIndex(l, 0)];
+            for (int m = 1; m <= l; m++) {
+                float a = zonal_coeffs[getLegendreIndex(l, m)];
+                y_value[getCoeffIndex(l, -m)] = sin_mphi[m] * a;
+                y_value[getCoeffIndex(l, m)] = cos_mphi[m] * a;
+            }
+        }
+    }
+
+    // batched over unit directions in structure of arrays, theta measured from +z and
+    // phi = atan(y, x). sin(theta)^m * cos/sin(m * phi) comes from (x + iy)^m, so there is
+    // no trig and the same formula runs 8 lanes on avx2, 4 on neon and 1 for the tail,
+    // every lane rounding the same way. output row s starts at y_values + s * stride.
+    static void evalDirections(
+        const float* x,
+        const float* y,
+        const float* z,
+        size_t count,
+        float* y_values,
+        size_t stride) {
+        using SimdOps = sh_detail::SimdOps;
+        size_t i = 0;
+        if (sh_detail::hasAvx2()) {
+            i = sh_detail::evalDirectionsAvx2<kBands>(x, y, z, count, y_values, stride);
+        }
+        for (; i + SimdOps::kWidth <= count; i += SimdOps::kWidth) {
+            evalDirectionsKernel<SimdOps>(x, y, z, i, y_values, stride);
+        }
+        for (; i < count; i++) {
+            evalDirectionsKernel<sh_detail::ScalarOps>(x, y, z, i, y_values, stride);
+        }
+    }
+
+    // legendre polynomials with sin(theta)^m taken out, folded with the scaled k values.
+    // directions [i, i + Ops::kWidth), evalDirections picks the ops.
+    template<class Ops>
+    static void evalDirectionsKernel(
+        const float* x_ptr,
+        const float* y_ptr,
+        const float* z_ptr,
+        size_t i,
+        float* y_values,
+        size_t stride) {
+        using V = typename Ops::Value;
+        constexpr auto& k = kScaledKTable.values;
+        auto c = [](float v) { return Ops::set(v); };
+        auto out = [&](int s, V v) { Ops::store(y_values + s * stride + i, v); };
+
+        V x = Ops::load(x_ptr + i);
+        V y = Ops::load(y_ptr + i);
+        V z = Ops::load(z_ptr + i);
+        V z2 = Ops::mul(z, z);
+
+        out(0, c(k[0]));
+        if constexpr (kBands > 1) {
+            V c11 = c(-k[2]);
+            out(1, Ops::mul(c11, y));
+            out(2, Ops::mul(c(k[1]), z));
+            out(3, Ops::mul(c11, x));
+        }
+        if constexpr (kBands > 2) {
+            V c2 = Ops::sub(Ops::mul(x, x), Ops::mul(y, y));
+            V s2 = Ops::add(Ops::mul(x, y), Ops::mul(y, x));
+            V p21 = Ops::mul(c(-3.0f * k[4]), z);
+            V c22 = c(3.0f * k[5]);
+            out(4, Ops::mul(c22, s2));
+            out(5, Ops::mul(p21, y));
+            out(6, Ops::mul(c(0.5f * k[3]), Ops::sub(Ops::mul(c(3.0f), z2), c(1.0f))));
+            out(7, Ops::mul(p21, x));
+            out(8, Ops::mul(c22, c2));
+
+            if constexpr (kBands > 3) {
+                V c3 = Ops::sub(Ops::mul(x, c2), Ops::mul(y, s2));
+                V s3 = Ops::add(Ops::mul(x, s2), Ops::mul(y, c2));
+                V p31 = Ops::mul(c(1.5f * k[7]), Ops::sub(c(1.0f), Ops::mul(c(5.0f), z2)));
+                V p32 = Ops::mul(c(15.0f * k[8]), z);
+                V c33 = c(-15.0f * k[9]);
+                out(9, Ops::mul(c33, s3));
+                out(10, Ops::mul(p32, s2));
+                out(11, Ops::mul(p31, y));
+                out(12, Ops::mul(Ops::mul(c(0.5f * k[6]), z), Ops::sub(Ops::mul(c(5.0f), z2), c(3.0f))));
+                out(13, Ops::mul(p31, x));
+                out(14, Ops::mul(p32, c2));
+                out(15, Ops::mul(c33, c3));
+
+                if constexpr (kBands > 4) {
+                    V c4 = Ops::sub(Ops::mul(x, c3), Ops::mul(y, s3));
+                    V s4 = Ops::add(Ops::mul(x, s3), Ops::mul(y, c3));
+                    V p41 = Ops::mul(Ops::mul(c(2.5f * k[11]), Ops::sub(c(3.0f), Ops::mul(c(7.0f), z2))), z);
+                    V p42 = Ops::mul(c(7.5f * k[12]), Ops::sub(Ops::mul(c(7.0f), z2), c(1.0f)));
+                    V p43 = Ops::mul(c(-105.0f * k[13]), z);
+                    V c44 = c(105.0f * k[14]);
+                    V p40 = Ops::add(Ops::mul(Ops::sub(Ops::mul(c(35.0f), z2), c(30.0f)), z2), c(3.0f));
+                    out(16, Ops::mul(c44, s4));
+                    out(17, Ops::mul(p43, s3));
+                    out(18, Ops::mul(p42, s2));
+                    out(19, Ops::mul(p41, y));
+                    out(20, Ops::mul(c(0.125f * k[10]), p40));
+                    out(21, Ops::mul(p41, x));
+                    out(22, Ops::mul(p42, c2));
+                    out(23, Ops::mul(p43, c3));
+                    out(24, Ops::mul(c44, c4));
+                }
+            }
+        }
+    }
+
+private:
+    template<class T>
+    static constexpr const std::array<T, kLegendreCount>& getScaledKValues() {
+        if constexpr (sizeof(T) == sizeof(float)) {
+            return kScaledKValues;
+        }
+        else {
+            return kScaledKValuesDouble;
+        }
+    }
+};
+
+using PrtShBasis = ShBasis<5>;
+
+} // namespace scene_rendering
+} // namespace engine
@@ -0,0 +1,56 @@
+#include "sh_basis.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// the only engine file built with avx2 codegen (engine.vcxproj sets it per file), nothing in
+// here runs before sh_detail::hasAvx2() said yes. keep it to the kernel, an inline function
+// from a shared header could get linked into the rest of the engine in its avx2 form.
+
+namespace engine {
+namespace scene_rendering {
+namespace sh_detail {
+
+namespace {
+#if defined(__AVX2__)
+struct Avx2Ops {
+    using Value = __m256;
+    static constexpr size_t kWidth = 8;
+    static Value load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Value v) { _mm256_storeu_ps(p, v); }
+    static Value set(float v) { return _mm256_set1_ps(v); }
+    static Value add(Value a, Value b) { return _mm256_add_ps(a, b); }
+    static Value sub(Value a, Value b) { return _mm256_sub_ps(a, b); }
+    static Value mul(Value a, Value b) { return _mm256_mul_ps(a, b); }
+};
+#endif
+} // namespace
+
+template<int kBands>
+size_t evalDirectionsAvx2(
+    const float* x,
+    const float* y,
+    const float* z,
+    size_t count,
+    float* y_values,
+    size_t stride) {
+#if defined(__AVX2__)
+    size_t i = 0;
+    for (; i + Avx2Ops::kWidth <= count; i += Avx2Ops::kWidth) {
+        ShBasis<kBands>::template evalDirectionsKernel<Avx2Ops>(x, y, z, i, y_values, stride);
+    }
+    return i;
+#else
+    return 0;
+#endif
+}
+
+template size_t evalDirectionsAvx2<1>(const float*, const float*, const float*, size_t, float*, size_t);
+template size_t evalDirectionsAvx2<2>(const float*, const float*, const float*, size_t, float*, size_t);
+template size_t evalDirectionsAvx2<3>(const float*, const float*, const float*, size_t, float*, size_t);
+template size_t evalDirectionsAvx2<4>(const float*, const float*, const float*, size_t, float*, size_t);
+template size_t evalDirectionsAvx2<5>(const float*, const float*, const float*, size_t, float*, size_t);
+
+} // namespace sh_detail
+} // namespace scene_rendering
+} // namespace engine
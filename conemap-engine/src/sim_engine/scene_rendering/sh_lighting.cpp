@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include "engine_helper.h"
+#include "sh_basis.h"
+#include "sh_lighting.h"
+
+namespace {
+    using engine::scene_rendering::PrtShBasis;
+
+    // directions evaluated per chunk, kept on the stack.
+    const int kShChunkSize = 64;
+
+    // getKValue only keeps the fourth root of (2l + 1) / 4pi, so the prt basis is off the
+    // orthonormal one by that factor per band. projecting the light in the prt basis as well
+    // and scaling by its square makes the dot product with the baked visibility come out right.
+    double getPrtBandScale(int l)
+    {
+        return std::sqrt((2 * l + 1) / (4.0 * glm::pi<double>()));
+    }
+
+    // funk-hecke factors of a uniform cap normalized by its solid angle, 1 for a delta light.
+    // integral of P_l from cos(half_angle) to 1 is (P_l-1 - P_l+1) / (2l + 1).
+    void getCapBandFactors(double factors[5], double half_angle) {
+        if (half_angle < 1e-3) {
+            std::fill(factors, factors + 5, 1.0);
+            return;
+        }
+
+        double x = std::cos(std::min(half_angle, glm::pi<double>()));
+        double p[6];
+        p[0] = 1.0;
+        p[1] = x;
+        for (int l = 1; l < 5; l++) {
+            p[l + 1] = ((2 * l + 1) * x * p[l] - l * p[l - 1]) / (l + 1);
+        }
+
+        double inv_area = 1.0 / (1.0 - x);
+        factors[0] = 1.0;
+        for (int l = 1; l < 5; l++) {
+            factors[l] = (p[l - 1] - p[l + 1]) / (2 * l + 1) * inv_area;
+        }
+    }
+} // namespace
+
+namespace engine {
+namespace scene_rendering {
+
+void ShLighting::loadEnvironment(
+    const std::string& panorama_file_name,
+    const glm::uvec2& sample_size) {
+    glm::uvec2 image_size;
+    auto image_data = helper::loadImageFile(panorama_file_name, image_size);
+
+    uint32_t num_samples = sample_size.x * sample_size.y;
+    env_dir_x_.resize(num_samples);
+    env_dir_y_.resize(num_samples);
+    env_dir_z_.resize(num_samples);
+    env_weights_.resize(num_samples);
+
+    const float pi = glm::pi<float>();
+    for (uint32_t j = 0; j < sample_size.y; j++) {
+        uint32_t y0 = j * image_size.y / sample_size.y;
+        uint32_t y1 = std::max((j + 1) * image_size.y / sample_size.y, y0 + 1);
+        // v = 1 - acos(dir.y) / pi.
+        float theta = (1.0f - (j + 0.5f) / sample_size.y) * pi;
+        float solid_angle =
+            std::sin(theta) * (pi / sample_size.y) * (2.0f * pi / sample_size.x);
+
+        for (uint32_t i = 0; i < sample_size.x; i++) {
+            uint32_t x0 = i * image_size.x / sample_size.x;
+            uint32_t x1 = std::max((i + 1) * image_size.x / sample_size.x, x0 + 1);
+
+            float sum_luminance = 0.0f;
+            for (uint32_t y = y0; y < y1; y++) {
+                for (uint32_t x = x0; x < x1; x++) {
+                    const uint8_t* pixel = &image_data[(size_t(y) * image_size.x + x) * 4];
+                    sum_luminance += 0.2126f * pixel[0] + 0.7152f * pixel[1] + 0.0722f * pixel[2];
+                }
+            }
+
+            // u = 0.5 + 0.5 * atan(dir.z, dir.x) / pi.
+            float phi = ((i + 0.5f) / sample_size.x - 0.5f) * 2.0f * pi;
+            uint32_t idx = j * sample_size.x + i;
+            env_dir_x_[idx] = std::sin(theta) * std::cos(phi);
+            env_dir_y_[idx] = std::cos(theta);
+            env_dir_z_[idx] = std::sin(theta) * std::sin(phi);
+            env_weights_[idx] =
+                sum_luminance / (255.0f * (x1 - x0) * (y1 - y0)) * solid_angle;
+        }
+    }
+}
+
+void ShLighting::setTangentFrame(
+    const glm::mat4& model_mat,
+    float height_scale) {
+    tangent_u_ = glm::normalize(glm::vec3(model_mat * glm::vec4(1, 0, 0, 0)));
+    normal_ = glm::normalize(glm::vec3(model_mat * glm::vec4(0, 1, 0, 0)));
+    tangent_v_ = glm::normalize(glm::vec3(model_mat * glm::vec4(0, 0, 1, 0)));
+    inv_height_scale_ = 1.0f / std::max(std::abs(height_scale), 1e-4f);
+}
+
+// slopes get steeper with the height scale, so the warped normal component shrinks.
+glm::vec3 ShLighting::toTangentSpace(const glm::vec3& dir) const {
+    return glm::normalize(
+        glm::vec3(
+            glm::dot(dir, tangent_u_),
+            glm::dot(dir, tangent_v_),
+            glm::dot(dir, normal_) * inv_height_scale_));
+}
+
+void ShLighting::projectTangentCap(
+    float coeffs[kPrtShCoeffCount],
+    const glm::vec3& tangent_dir,
+    float half_angle) const {
+    float y_values[kPrtShCoeffCount];
+    PrtShBasis::evalDirections(&tangent_dir.x, &tangent_dir.y, &tangent_dir.z, 1, y_values, 1);
+
+    double band_factors[5];
+    getCapBandFactors(band_factors, half_angle);
+
+    // baked visibility is normalized to 1 / 2pi of the hemisphere integral.
+    for (int s = 0; s < kPrtShCoeffCount; s++) {
+        int l = PrtShBasis::getBand(s);
+        coeffs[s] = float(
+            2.0 * glm::pi<double>() * band_factors[l] * getPrtBandScale(l) * y_values[s]);
+    }
+}
+
+void ShLighting::projectDirectionalLight(
+    float coeffs[kPrtShCoeffCount],
+    const glm::vec3& dir_to_light,
+    float half_angle) const {
+    // cap is kept round after the height warp, only its center gets warped.
+    projectTangentCap(coeffs, toTangentSpace(dir_to_light), half_angle);
+}
+
+void ShLighting::projectEnvironment(
+    float coeffs[kPrtShCoeffCount]) const {
+    if (env_weights_.empty()) {
+        projectTangentCap(coeffs, glm::vec3(0, 0, 1), glm::half_pi<float>());
+        return;
+    }
+
+    double sum_coeffs[kPrtShCoeffCount] = {};
+    double sum_weight = 0.0;
+    float x[kShChunkSize], y[kShChunkSize], z[kShChunkSize], w[kShChunkSize];
+    float y_values[kPrtShCoeffCount][kShChunkSize];
+    for (size_t base = 0; base < env_weights_.size(); base += kShChunkSize) {
+        int count = int(std::min(env_weights_.size() - base, size_t(kShChunkSize)));
+        for (int i = 0; i < count; i++) {
+            glm::vec3 dir(env_dir_x_[base + i], env_dir_y_[base + i], env_dir_z_[base + i]);
+            // lower hemisphere is blocked by the surface itself.
+            w[i] = glm::dot(dir, normal_) > 0.0f ? env_weights_[base + i] : 0.0f;
+            glm::vec3 tangent_dir = toTangentSpace(dir);
+            x[i] = tangent_dir.x;
+            y[i] = tangent_dir.y;
+            z[i] = tangent_dir.z;
+        }
+
+        PrtShBasis::evalDirections(x, y, z, count, &y_values[0][0], kShChunkSize);
+
+        for (int s = 0; s < kPrtShCoeffCount; s++) {
+            float sum = 0.0f;
+            for (int i = 0; i < count; i++) {
+                sum += y_values[s][i] * w[i];
+            }
+            sum_coeffs[s] += sum;
+        }
+
+        for (int i = 0; i < count; i++) {
+            sum_weight += w[i];
+        }
+    }
+
+    if (sum_weight <= 0.0) {
+        projectTangentCap(coeffs, glm::vec3(0, 0, 1), glm::half_pi<float>());
+        return;
+    }
+
+    // samples are warped one by one, so solid angle weights stay the unwarped ones.
+    for (int s = 0; s < kPrtShCoeffCount; s++) {
+        coeffs[s] = float(
+            2.0 * glm::pi<double>() * getPrtBandScale(PrtShBasis::getBand(s)) * sum_coeffs[s] / sum_weight);
+    }
+}
+
+}// namespace scene_rendering
+}// namespace engine
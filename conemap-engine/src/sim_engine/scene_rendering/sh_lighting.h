@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "renderer/renderer.h"
+#include "shaders/global_definition.glsl.h"
+
+namespace engine {
+namespace scene_rendering {
+
+// projects lights and the ibl environment into order 5 sh in the tangent frame PrtShadow
+// bakes visibility in, same basis and coefficient order as fillYVauleTablle.
+// output is scaled so a dot with the baked visibility gives the visible fraction of the light.
+class ShLighting {
+    // low resolution lat-long copy of the ibl panorama, directions and luminance * solid angle
+    // kept as separate arrays so the projection runs over plain float streams.
+    std::vector<float> env_dir_x_;
+    std::vector<float> env_dir_y_;
+    std::vector<float> env_dir_z_;
+    std::vector<float> env_weights_;
+
+    glm::vec3 tangent_u_ = glm::vec3(1, 0, 0);
+    glm::vec3 tangent_v_ = glm::vec3(0, 0, 1);
+    glm::vec3 normal_ = glm::vec3(0, 1, 0);
+    float inv_height_scale_ = 1.0f;
+
+    glm::vec3 toTangentSpace(const glm::vec3& dir) const;
+
+    void projectTangentCap(
+        float coeffs[kPrtShCoeffCount],
+        const glm::vec3& tangent_dir,
+        float half_angle) const;
+
+public:
+    // panorama gets box filtered down to sample_size, same lat-long mapping as dirToUV in cube_ibl.frag.
+    void loadEnvironment(
+        const std::string& panorama_file_name,
+        const glm::uvec2& sample_size = glm::uvec2(64, 32));
+
+    // u along model x, v along model z, the bake's normal axis is stretched by 1 / height scale.
+    void setTangentFrame(
+        const glm::mat4& model_mat,
+        float height_scale);
+
+    // sphere light seen under half_angle around dir_to_light, 0 gives a delta directional light.
+    void projectDirectionalLight(
+        float coeffs[kPrtShCoeffCount],
+        const glm::vec3& dir_to_light,
+        float half_angle) const;
+
+    // luminance weighted upper hemisphere of the environment, uniform sky if nothing got loaded.
+    void projectEnvironment(
+        float coeffs[kPrtShCoeffCount]) const;
+};
+
+}// namespace scene_rendering
+}// namespace engine
@@ -0,0 +1,11 @@
+// global bindless texture table, needs GL_EXT_nonuniform_qualifier.
+#ifndef BINDLESS_TABLE_SET
+#define BINDLESS_TABLE_SET 0
+#endif
+
+layout(set = BINDLESS_TABLE_SET, binding = BINDLESS_TEXTURE_INDEX) uniform sampler2D bindless_textures[];
+
+// storage images are declared with their format, every shader aliases the binding with
+// the formats it needs.
+#define BINDLESS_STORAGE_IMAGES(format, image_type, name) \
+    layout(set = BINDLESS_TABLE_SET, binding = BINDLESS_STORAGE_IMAGE_INDEX, format) uniform image_type name[]
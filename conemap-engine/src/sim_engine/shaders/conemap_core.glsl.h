@@ -0,0 +1,161 @@
+// shared by conemap_test.frag and conemap_parallax.comp, conemap_tex has to be declared before including.
+const int s_cone_steps = 15;
+const int s_binary_steps = 8;
+#ifdef HIGH_PRECISION_CONEMAP
+// stop cone stepping once a step moves less than this along z. the rgba8 conemap keeps the
+// fixed step count, its quantized cones stall early and the extra steps still refine the hit.
+const float s_min_cone_step = 1.0f / 4096.0f;
+#endif
+// restart a bit above last frame's hit to absorb small view changes.
+const float s_history_depth_margin = 1.0f / 64.0f;
+
+int g_cone_step_count = 0;
+
+float getConeTangent(float conemap_value)
+{
+#ifdef HIGH_PRECISION_CONEMAP
+    return conemap_value;
+#else
+    const float half_pi = PI / 2.0f;
+    return tan(conemap_value * half_pi);
+#endif
+}
+
+// the rgba8 path keeps the implicit lod fetch it always used. the half float conemap is
+// sampled at lod 0, it holds cone tangents and filtering across mips would widen the cones.
+vec4 sampleConemap(vec2 uv)
+{
+#ifdef HIGH_PRECISION_CONEMAP
+    return textureLod(conemap_tex, uv, 0.0f);
+#else
+    return texture(conemap_tex, uv);
+#endif
+}
+
+// scale the ray so it stays inside the [0, 1] uv range of the conemap.
+vec3 getClampedConeRay(vec3 v, vec3 p0)
+{
+    float scale_x = 1.0f;
+    if (v.x > 0.0f && p0.x + v.x > 1.0f)
+    {
+        scale_x = (1.0f - p0.x) / v.x;
+    }
+
+    if (v.x < 0.0f && p0.x + v.x < 0.0f)
+    {
+        scale_x = p0.x / (-v.x);
+    }
+
+    vec3 clamped_v = v * scale_x;
+
+    float scale_y = 1.0f;
+    if (clamped_v.y > 0.0f && p0.y + clamped_v.y > 1.0f)
+    {
+        scale_y = (1.0f - p0.y) / clamped_v.y;
+
+    }
+
+    if (clamped_v.y < 0.0f && p0.y + clamped_v.y < 0.0f)
+    {
+        scale_y = p0.y / (-clamped_v.y);
+    }
+
+    return clamped_v * scale_y;
+}
+
+// conservative cone steps only, they never step past the surface so the result stays on the
+// near side of the hit.
+float conservativeConeStepping(vec3 iv, vec3 p0, int num_steps)
+{
+    vec3 v = iv / iv.z;
+    float max_z = getClampedConeRay(v, p0).z;
+    float dist = length(vec2(v));
+
+    float cast_z = 0.0f;
+    for (int i = 0; i < num_steps; i++)
+    {
+        vec3 p = p0 + v * cast_z;
+        vec4 relief_map_info = textureLod(conemap_tex, vec2(p), 0.0f);
+        float height = clamp(relief_map_info.z - p.z, 0.0f, 1.0f);
+        // .x is the relaxed cone, only valid at tangent points and free to pass the surface.
+        float tan_cone_angle = getConeTangent(relief_map_info.y);
+        cast_z = min(cast_z + height / (dist * tan_cone_angle + 1.0f), max_z);
+    }
+
+    return cast_z;
+}
+
+vec3 relaxedConeStepping(vec3 iv, vec3 ip, bool use_conserve_conemap, float history_z, out float hit_z)
+{
+    vec3 v = iv / iv.z;
+    vec3 p0 = ip;
+
+    vec3 clamped_v = getClampedConeRay(v, p0);
+
+    float dist = length(vec2(v));
+
+    vec4 relief_map_info = sampleConemap(vec2(p0));
+    float height = clamp(relief_map_info.z - p0.z, 0.0f, 1.0f);
+
+    float tan_cone_angle = getConeTangent(relief_map_info.y);
+    float start_z = !use_conserve_conemap ? 0.0f : min(height / (dist * tan_cone_angle + 1.0f), clamped_v.z);
+
+    // start from the reprojected hit depth if the ray is still above the surface there, and
+    // nothing in between can be hit: one conservative cone step from start_z has to reach the
+    // restart point. a thin feature moving in front of last frame's hit fails that, those
+    // pixels keep the full march.
+    if (history_z > 0.0f) {
+        float history_start_z = min(max(history_z - s_history_depth_margin, start_z), clamped_v.z);
+        vec3 start_p = p0 + v * start_z;
+        vec4 start_info = textureLod(conemap_tex, vec2(start_p), 0.0f);
+        float start_height = clamp(start_info.z - start_p.z, 0.0f, 1.0f);
+        float safe_z = start_z + start_height / (dist * getConeTangent(start_info.y) + 1.0f);
+        vec3 history_p = p0 + v * history_start_z;
+        if (safe_z >= history_start_z &&
+            history_p.z < textureLod(conemap_tex, vec2(history_p), 0.0f).z) {
+            start_z = history_start_z;
+        }
+    }
+
+    float cast_z = start_z;
+
+    vec3 p = p0;
+    for (int i = 0; i < s_cone_steps; i++)
+    {
+        p = p0 + v * cast_z;
+        vec4 relief_map_info = sampleConemap(vec2(p));
+
+        //The use of the saturate() function when calculating the distance to move guarantees that we stop on the first visited texel for which the viewing ray is under the relief surface.
+        float height = clamp(relief_map_info.z - p.z, 0.0f, 1.0f);
+
+        float tan_cone_angle = getConeTangent(relief_map_info.x);
+        float next_z = min(cast_z + height / (dist * tan_cone_angle + 1.0f), clamped_v.z);
+        g_cone_step_count++;
+
+#ifdef HIGH_PRECISION_CONEMAP
+        bool converged = next_z - cast_z < s_min_cone_step;
+        cast_z = next_z;
+        if (converged)
+            break;
+#else
+        cast_z = next_z;
+#endif
+    }
+
+    float step_z = (cast_z - start_z) * 0.5f;
+    float current_z = start_z + step_z;
+
+    for (int i = 0; i < s_binary_steps; i++)
+    {
+        p = p0 + v * current_z;
+        vec4 relief_map_info = sampleConemap(vec2(p));
+        step_z *= 0.5f;
+        if (p.z < relief_map_info.z)
+            current_z += step_z;
+        else
+            current_z -= step_z;
+    }
+
+    hit_z = current_z;
+    return p;
+}
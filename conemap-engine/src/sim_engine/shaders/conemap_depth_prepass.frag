@@ -0,0 +1,50 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_conservative_depth : enable
+#include "global_definition.glsl.h"
+
+layout(push_constant) uniform PrtLightUniformBufferObject {
+    PrtLightParams params;
+};
+
+layout(std430, set = VIEW_PARAMS_SET, binding = VIEW_CAMERA_BUFFER_INDEX) readonly buffer CameraInfoBuffer {
+	GameCameraInfo camera_info;
+};
+
+layout(location = 0) in ObjectVsPsData in_data;
+
+layout(set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_TEX_INDEX) uniform sampler2D conemap_tex;
+
+#include "conemap_core.glsl.h"
+
+// pushing the depth further away only, keeps early depth test usable for this pass.
+layout(depth_greater) out float gl_FragDepth;
+
+const int s_prepass_cone_steps = 4;
+
+void main() {
+    mat3 world2local =
+        mat3(
+            in_data.vertex_tangent,
+            in_data.vertex_binormal,
+            in_data.vertex_normal);
+
+    vec3 view_ws = in_data.vertex_position - camera_info.position.xyz;
+    vec3 v = world2local * view_ws;
+    v.z = abs(v.z);
+    v.xy *= params.height_scale;
+
+    float hit_z =
+        conservativeConeStepping(
+            v,
+            vec3(in_data.vertex_tex_coord.xy, 0.0),
+            s_prepass_cone_steps);
+
+    // uv range [0, 1] spans 2 world units on the unit plane.
+    float depth_ws = hit_z * abs(params.height_scale) * 2.0f;
+    float view_depth = abs(dot(view_ws, normalize(in_data.vertex_normal)));
+    vec3 hit_position_ws = in_data.vertex_position + view_ws * (depth_ws / max(view_depth, 1e-5f));
+
+    vec4 clip_pos = camera_info.view_proj * vec4(hit_position_ws, 1.0f);
+    gl_FragDepth = max(clip_pos.z / clip_pos.w, gl_FragCoord.z);
+}
@@ -5,6 +5,7 @@
 #include "brdf.glsl.h"
 #include "punctual.glsl.h"
 #include "prt_core.glsl.h"
+#include "prt_pack.glsl.h"
 
 layout(push_constant) uniform PrtLightUniformBufferObject {
     PrtLightParams params;
@@ -23,91 +24,181 @@ layout(set = PBR_MATERIAL_PARAMS_SET, binding = PBR_CONSTANT_INDEX) uniform Mate
 #include "ibl.glsl.h"
 #include "pbr_lighting.glsl.h"
 
+#ifdef EARLY_DEPTH_TEST
+// depth comes from conemap_depth_prepass.frag, hidden pixels get rejected before the march.
+layout(early_fragment_tests) in;
+#endif
+
+#ifdef VISIBILITY_RESOLVE
+// full screen pass, surface attributes are rebuilt from the visibility buffer.
+layout(set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_TEX_INDEX, r32ui) uniform readonly uimage2D visibility_img;
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_POSITION_BUFFER_INDEX) readonly buffer VisibilityPositionBuffer {
+    float vertex_positions[];
+};
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_NORMAL_BUFFER_INDEX) readonly buffer VisibilityNormalBuffer {
+    float vertex_normals[];
+};
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_TANGENT_BUFFER_INDEX) readonly buffer VisibilityTangentBuffer {
+    float vertex_tangents[];
+};
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_UV_BUFFER_INDEX) readonly buffer VisibilityUvBuffer {
+    float vertex_uvs[];
+};
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = VISIBILITY_INDEX_BUFFER_INDEX) readonly buffer VisibilityIndexBuffer {
+    uint vertex_indices[];
+};
+#else
 layout(location = 0) in ObjectVsPsData in_data;
+#endif
 
 layout(set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_TEX_INDEX) uniform sampler2D conemap_tex;
 layout(set = PBR_MATERIAL_PARAMS_SET, binding = PRT_PACK_TEX_INDEX, rgba32ui) uniform readonly uimage2D src_prt_pack_img;
 layout(set = PBR_MATERIAL_PARAMS_SET, binding = PRT_PACK_INFO_TEX_INDEX, rgba32f) uniform readonly image2D src_prt_packed_info_img;
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_STEP_STATS_INDEX) buffer ConemapStepStatsBuffer {
+    ConemapStepStats step_stats;
+};
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_PREV_CAMERA_INDEX) readonly buffer PrevCameraInfoBuffer {
+    GameCameraInfo prev_camera_info;
+};
+// x: hit depth along the ray, yz: surface uv the ray started from.
+layout(set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_HISTORY_TEX_INDEX_0, rgba32f) uniform image2D hit_history_img_0;
+layout(set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_HISTORY_TEX_INDEX_1, rgba32f) uniform image2D hit_history_img_1;
+// xy: hit uv, z: hit depth along the ray, w: 1 if valid. written by conemap_parallax.comp.
+layout(set = PBR_MATERIAL_PARAMS_SET, binding = CONEMAP_PARALLAX_TEX_INDEX, rgba32f) uniform readonly image2D parallax_img;
+layout(std430, set = PBR_MATERIAL_PARAMS_SET, binding = PRT_LIGHT_COEFFS_INDEX) readonly buffer PrtLightCoeffsBuffer {
+    PrtLightCoeffs prt_light;
+};
 
-const int s_cone_steps = 15;
-const int s_binary_steps = 8;
-
-vec3 relaxedConeStepping(vec3 iv, vec3 ip, bool use_conserve_conemap)
-{
-    vec3 v = iv / iv.z;
-    vec3 p0 = ip;
-
-    float scale_x = 1.0f;
-    if (v.x > 0.0f && p0.x + v.x > 1.0f)
-    {
-        scale_x = (1.0f - p0.x) / v.x;
-    }
-
-    if (v.x < 0.0f && p0.x + v.x < 0.0f)
-    {
-        scale_x = p0.x / (-v.x);
-    }
-
-    vec3 clamped_v = v * scale_x;
-
-    float scale_y = 1.0f;
-    if (clamped_v.y > 0.0f && p0.y + clamped_v.y > 1.0f)
-    {
-        scale_y = (1.0f - p0.y) / clamped_v.y;
-
-    }
-
-    if (clamped_v.y < 0.0f && p0.y + clamped_v.y < 0.0f)
-    {
-        scale_y = p0.y / (-clamped_v.y);
-    }
-
-    clamped_v = clamped_v * scale_y;
-
-    float dist = length(vec2(v));
-
-    vec4 relief_map_info = texture(conemap_tex, vec2(p0));
-    float height = clamp(relief_map_info.z - p0.z, 0.0f, 1.0f);
-
-    const float half_pi = PI / 2.0f;
-    float tan_cone_angle = tan(relief_map_info.y * half_pi);
-    float start_z = !use_conserve_conemap ? 0.0f : min(height / (dist * tan_cone_angle + 1.0f), clamped_v.z);
-    float cast_z = start_z;
+// history is only reused when it was traced from within this many texels.
+const float s_history_uv_tolerance = 2.0f;
+// upsample weights fall off with height field miss distance and bump normal difference.
+const float s_upsample_depth_sharpness = 256.0f;
+const float s_upsample_normal_power = 8.0f;
+const float s_upsample_min_weight = 1e-3f;
 
-    vec3 p = p0;
-    for (int i = 0; i < s_cone_steps; i++)
-    {
-        p = p0 + v * cast_z;
-        vec4 relief_map_info = texture(conemap_tex, vec2(p));
+#include "conemap_core.glsl.h"
 
-        //The use of the saturate() function when calculating the distance to move guarantees that we stop on the first visited texel for which the viewing ray is under the relief surface.
-        float height = clamp(relief_map_info.z - p.z, 0.0f, 1.0f);
+#ifdef VISIBILITY_RESOLVE
+#define LOAD_VEC3(buf, idx) vec3(buf[(idx) * 3], buf[(idx) * 3 + 1], buf[(idx) * 3 + 2])
+#define LOAD_VEC2(buf, idx) vec2(buf[(idx) * 2], buf[(idx) * 2 + 1])
 
-        float tan_cone_angle = tan(relief_map_info.x * half_pi);
-        cast_z = min(cast_z + height / (dist * tan_cone_angle + 1.0f), clamped_v.z);
+// intersect this pixel's view ray with the stored triangle to get perspective correct barycentrics.
+bool loadVisibilitySurface(out ObjectVsPsData ps_data)
+{
+    ivec2 screen_coords = ivec2(gl_FragCoord.xy);
+    uint visibility = imageLoad(visibility_img, screen_coords).x;
+    if (visibility == 0) {
+        return false;
     }
 
-    float step_z = (cast_z - start_z) * 0.5f;
-    float current_z = start_z + step_z;
+    // only the unit plane gets drawn for now, so object id doesn't pick a different mesh yet.
+    uint primitive_id = (visibility - 1u) & kVisibilityPrimitiveMask;
+    uvec3 idx = uvec3(
+        vertex_indices[primitive_id * 3],
+        vertex_indices[primitive_id * 3 + 1],
+        vertex_indices[primitive_id * 3 + 2]);
+
+    mat4 matrix_ws = params.model_mat;
+    vec3 p0 = (matrix_ws * vec4(LOAD_VEC3(vertex_positions, idx.x), 1.0f)).xyz;
+    vec3 p1 = (matrix_ws * vec4(LOAD_VEC3(vertex_positions, idx.y), 1.0f)).xyz;
+    vec3 p2 = (matrix_ws * vec4(LOAD_VEC3(vertex_positions, idx.z), 1.0f)).xyz;
+
+    vec2 ndc = gl_FragCoord.xy / vec2(imageSize(visibility_img)) * 2.0f - 1.0f;
+    vec4 far_pos = camera_info.inv_view_proj * vec4(ndc, 0.5f, 1.0f);
+    vec3 ray_dir = far_pos.xyz / far_pos.w - camera_info.position;
+
+    vec3 e1 = p1 - p0;
+    vec3 e2 = p2 - p0;
+    vec3 pv = cross(ray_dir, e2);
+    float inv_det = 1.0f / dot(e1, pv);
+    vec3 tv = camera_info.position - p0;
+    vec3 qv = cross(tv, e1);
+    vec3 bary;
+    bary.y = dot(tv, pv) * inv_det;
+    bary.z = dot(ray_dir, qv) * inv_det;
+    bary.x = 1.0f - bary.y - bary.z;
+
+    ps_data.vertex_position = mat3(p0, p1, p2) * bary;
+
+    vec2 uv = mat3x2(
+        LOAD_VEC2(vertex_uvs, idx.x),
+        LOAD_VEC2(vertex_uvs, idx.y),
+        LOAD_VEC2(vertex_uvs, idx.z)) * bary;
+    ps_data.vertex_tex_coord = vec4(uv, 0, 0);
+
+    vec3 normal = mat3(
+        LOAD_VEC3(vertex_normals, idx.x),
+        LOAD_VEC3(vertex_normals, idx.y),
+        LOAD_VEC3(vertex_normals, idx.z)) * bary;
+    vec3 tangent = mat3(
+        LOAD_VEC3(vertex_tangents, idx.x),
+        LOAD_VEC3(vertex_tangents, idx.y),
+        LOAD_VEC3(vertex_tangents, idx.z)) * bary;
+
+    // same as conemap_test.vert.
+    ps_data.vertex_normal = (matrix_ws * vec4(normal, 0.0f)).xyz;
+    ps_data.vertex_tangent = (matrix_ws * vec4(tangent, 0.0f)).xyz;
+    ps_data.vertex_binormal = cross(ps_data.vertex_normal, ps_data.vertex_tangent);
+
+    return true;
+}
+#endif
 
-    for (int i = 0; i < s_binary_steps; i++)
-    {
-        p = p0 + v * current_z;
-        vec4 relief_map_info = texture(conemap_tex, vec2(p));
-        step_z *= 0.5f;
-        if (p.z < relief_map_info.z)
-            current_z += step_z;
-        else
-            current_z -= step_z;
+// rebuild the full resolution hit from the low resolution hits around this pixel,
+// each tap's hit depth is re-applied along this pixel's own ray.
+bool upsampleConeSteppingHit(vec3 iv, vec3 p0, out float hit_z)
+{
+    vec3 v = iv / iv.z;
+    float max_z = getClampedConeRay(v, p0).z;
+
+    vec2 low_res_pos = gl_FragCoord.xy / float(params.parallax_downscale) - 0.5f;
+    ivec2 base_coords = ivec2(floor(low_res_pos));
+    vec2 bilinear = fract(low_res_pos);
+
+    float sum_weight = 0.0f;
+    float sum_z = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        ivec2 offset = ivec2(i & 1, i >> 1);
+        ivec2 coords = clamp(base_coords + offset, ivec2(0), ivec2(params.parallax_size) - 1);
+        vec4 low_res_hit = imageLoad(parallax_img, coords);
+        if (low_res_hit.w == 0.0f) {
+            continue;
+        }
+
+        float z = min(low_res_hit.z, max_z);
+        vec3 p = p0 + v * z;
+
+        // depth term, the ray should land right on the height field.
+        float depth_diff = abs(textureLod(conemap_tex, p.xy, 0.0f).z - p.z);
+        float depth_weight = 1.0f / (1.0f + depth_diff * s_upsample_depth_sharpness);
+
+        // normal term, reject taps that hit a different facet than the low res ray.
+        vec3 n = textureLod(normal_tex, p.xy, 0.0f).xyz * 2.0f - 1.0f;
+        vec3 low_res_n = textureLod(normal_tex, low_res_hit.xy, 0.0f).xyz * 2.0f - 1.0f;
+        float normal_weight = pow(max(dot(normalize(n), normalize(low_res_n)), 0.0f), s_upsample_normal_power);
+
+        vec2 bilinear_weights = mix(1.0f - bilinear, bilinear, vec2(offset));
+        float weight = bilinear_weights.x * bilinear_weights.y * depth_weight * normal_weight;
+
+        sum_weight += weight;
+        sum_z += z * weight;
     }
 
-    return p;
+    hit_z = sum_weight > s_upsample_min_weight ? sum_z / sum_weight : 0.0f;
+    return sum_weight > s_upsample_min_weight;
 }
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
+#ifdef VISIBILITY_RESOLVE
+    ObjectVsPsData ps_in_data;
+    if (!loadVisibilitySurface(ps_in_data)) {
+        discard;
+    }
+#else
     ObjectVsPsData ps_in_data = in_data;
+#endif
     mat3 world2local =
         mat3(
             ps_in_data.vertex_tangent,
@@ -120,8 +211,57 @@ void main() {
     v.z = abs(v.z);
     v.xy *= params.height_scale;
 
-    ps_in_data.vertex_tex_coord.xy =
-        relaxedConeStepping(v, vec3(ps_in_data.vertex_tex_coord.xy, 0.0), false).xy;
+    vec2 surface_uv = ps_in_data.vertex_tex_coord.xy;
+    ivec2 screen_coords = ivec2(gl_FragCoord.xy);
+    ivec2 history_size = imageSize(hit_history_img_0);
+
+    float history_z = -1.0f;
+    if (params.temporal_mode == kConemapTemporalReadWrite) {
+        vec4 prev_clip_pos = prev_camera_info.view_proj * vec4(ps_in_data.vertex_position, 1.0f);
+        vec2 prev_screen_uv = prev_clip_pos.xy / prev_clip_pos.w * 0.5f + 0.5f;
+
+        // anything reprojected into the guard band falls back to a full march.
+        if (prev_clip_pos.w > 0.0f &&
+            all(greaterThanEqual(prev_screen_uv, vec2(params.history_guard_band))) &&
+            all(lessThanEqual(prev_screen_uv, vec2(1.0f - params.history_guard_band)))) {
+            ivec2 prev_coords = min(ivec2(prev_screen_uv * history_size), history_size - 1);
+            vec4 history =
+                params.history_read_index == 0 ?
+                imageLoad(hit_history_img_0, prev_coords) :
+                imageLoad(hit_history_img_1, prev_coords);
+
+            vec2 uv_diff = abs(history.yz - surface_uv) * params.buffer_size;
+            if (max(uv_diff.x, uv_diff.y) < s_history_uv_tolerance) {
+                history_z = history.x;
+            }
+        }
+    }
+
+    float hit_z;
+    if (params.parallax_downscale > 1 &&
+        upsampleConeSteppingHit(v, vec3(surface_uv, 0.0), hit_z)) {
+        ps_in_data.vertex_tex_coord.xy = surface_uv + v.xy / v.z * hit_z;
+    }
+    else {
+        // full resolution, or every low res tap got rejected.
+        ps_in_data.vertex_tex_coord.xy =
+            relaxedConeStepping(v, vec3(surface_uv, 0.0), false, history_z, hit_z).xy;
+    }
+
+    if (params.temporal_mode != kConemapTemporalOff &&
+        all(lessThan(screen_coords, history_size))) {
+        vec4 history = vec4(hit_z, surface_uv, 0.0f);
+        if (params.history_read_index == 0)
+            imageStore(hit_history_img_1, screen_coords, history);
+        else
+            imageStore(hit_history_img_0, screen_coords, history);
+    }
+
+    if (params.collect_step_stats != 0) {
+        atomicAdd(step_stats.cone_steps, uint(g_cone_step_count));
+        atomicAdd(step_stats.binary_steps, uint(s_binary_steps));
+        atomicAdd(step_stats.num_pixels, 1u);
+    }
 
     vec4 baseColor = getBaseColor(ps_in_data, material);
 
@@ -136,6 +276,50 @@ void main() {
             v,
             baseColor.xyz);
 
+    // prt self shadowing, one packed texel per pixel, pack info is shared by the whole block.
+    float light_visi[LIGHT_COUNT];
+    float env_visi = 1.0f;
+    for (int i = 0; i < LIGHT_COUNT; ++i) {
+        light_visi[i] = 1.0f;
+    }
+
+    if (params.use_prt_lighting != 0) {
+        ivec2 pixel_coords =
+            ivec2(clamp(ps_in_data.vertex_tex_coord.xy, 0.0f, 1.0f) * (params.buffer_size - 1));
+
+        ivec2 pack_info_pixel_coords =
+            pixel_coords /
+            ivec2(kConemapGenBlockCacheSizeX, kConemapGenBlockCacheSizeY) *
+            ivec2(4);
+
+        uvec4 prt_packed_info =
+            imageLoad(src_prt_pack_img, pixel_coords);
+
+        vec4 pack_info[14];
+        for (int i = 0; i < 14; i++) {
+            pack_info[i] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(i % 4, i / 4));
+        }
+        uint pack_mode = uint(imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(2, 3)).x);
+
+        float coeffs[kPrtShCoeffCount];
+        unpackPrtCoeffs(prt_packed_info, pack_info, pack_mode, coeffs);
+
+        // band limited visibility rings a bit, keep it in range.
+        for (int i = 0; i < LIGHT_COUNT; ++i) {
+            float sum_visi = 0.0f;
+            for (int s = 0; s < kPrtShCoeffCount; s++) {
+                sum_visi += coeffs[s] * prt_light.light_coeffs[i * kPrtShCoeffCount + s];
+            }
+            light_visi[i] = clamp(sum_visi, 0.0f, 1.0f);
+        }
+
+        float sum_env_visi = 0.0f;
+        for (int s = 0; s < kPrtShCoeffCount; s++) {
+            sum_env_visi += coeffs[s] * prt_light.env_coeffs[s];
+        }
+        env_visi = clamp(sum_env_visi, 0.0f, 1.0f);
+    }
+
     // LIGHTING
     PbrLightsColorInfo color_info = initColorInfo();
 
@@ -147,81 +331,13 @@ void main() {
         material,
         material_info,
         normal_info, v);
-#endif // USE_IBL
 
-    ivec2 pixel_coords =
-        ivec2(clamp(ps_in_data.vertex_tex_coord.xy, 0.0f, 1.0f) * (params.buffer_size - 1));
-
-    ivec2 pack_info_pixel_coords = ivec2(0);
-/*        pixel_coords /
-        ivec2(kConemapGenBlockCacheSizeX, kConemapGenBlockCacheSizeY) *
-        ivec2(4);*/
-
-    uvec4 prt_packed_info =
-        imageLoad(src_prt_pack_img, pixel_coords);
-
-#if 0
-    vec4 pack_info_1[6], pack_info_2[6];
-    pack_info_1[0] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords);
-    pack_info_2[0] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(1, 0));
-    pack_info_1[1] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(2, 0));
-    pack_info_2[1] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(3, 0));
-    pack_info_1[2] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(0, 1));
-    pack_info_2[2] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(1, 1));
-    pack_info_1[3] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(2, 1));
-    pack_info_2[3] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(3, 1));
-    pack_info_1[4] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(0, 2));
-    pack_info_2[4] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(1, 2));
-    pack_info_1[5] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(2, 2));
-    pack_info_2[5] = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(3, 2));
-    float pack_info_1_6 = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(0, 3)).x;
-    float pack_info_2_6 = imageLoad(src_prt_packed_info_img, pack_info_pixel_coords + ivec2(1, 3)).x;
-
-    vec4 coeffs[6];
-    float coeffs_6;
-    coeffs[0].x =
-        ((prt_packed_info.x >> 30) |
-        ((prt_packed_info.y >> 30) << 2) |
-        ((prt_packed_info.z >> 30) << 4) |
-        ((prt_packed_info.w >> 30) << 6)) /
-        255.0f * pack_info_2_6 +
-        pack_info_1_6;
-    coeffs[0].y = (prt_packed_info.x & 0x1f) / 31.0f * pack_info_2[0].x + pack_info_1[0].x;
-    coeffs[0].z = ((prt_packed_info.x >> 5) & 0x1f) / 31.0f * pack_info_2[0].y + pack_info_1[0].y;
-    coeffs[0].w = ((prt_packed_info.x >> 10) & 0x1f) / 31.0f * pack_info_2[0].z + pack_info_1[0].z;
-    coeffs[1].x = ((prt_packed_info.x >> 15) & 0x1f) / 31.0f * pack_info_2[0].w + pack_info_1[0].w;
-    coeffs[1].y = ((prt_packed_info.x >> 20) & 0x1f) / 31.0f * pack_info_2[1].x + pack_info_1[1].x;
-    coeffs[1].z = ((prt_packed_info.x >> 25) & 0x1f) / 31.0f * pack_info_2[1].y + pack_info_1[1].y;
-    coeffs[1].w = (prt_packed_info.y & 0x1f) / 31.0f * pack_info_2[1].z + pack_info_1[1].z;
-    coeffs[2].x = ((prt_packed_info.y >> 5) & 0x1f) / 31.0f * pack_info_2[1].w + pack_info_1[1].w;
-    coeffs[2].y = ((prt_packed_info.y >> 10) & 0x1f) / 31.0f * pack_info_2[2].x + pack_info_1[2].x;
-    coeffs[2].z = ((prt_packed_info.y >> 15) & 0x1f) / 31.0f * pack_info_2[2].y + pack_info_1[2].y;
-    coeffs[2].w = ((prt_packed_info.y >> 20) & 0x1f) / 31.0f * pack_info_2[2].z + pack_info_1[2].z;
-    coeffs[3].x = ((prt_packed_info.y >> 25) & 0x1f) / 31.0f * pack_info_2[2].w + pack_info_1[2].w;
-    coeffs[3].y = (prt_packed_info.z & 0x1f) / 31.0f * pack_info_2[3].x + pack_info_1[3].x;
-    coeffs[3].z = ((prt_packed_info.z >> 5) & 0x1f) / 31.0f * pack_info_2[3].y + pack_info_1[3].y;
-    coeffs[3].w = ((prt_packed_info.z >> 10) & 0x1f) / 31.0f * pack_info_2[3].z + pack_info_1[3].z;
-    coeffs[4].x = ((prt_packed_info.z >> 15) & 0x1f) / 31.0f * pack_info_2[3].w + pack_info_1[3].w;
-    coeffs[4].y = ((prt_packed_info.z >> 20) & 0x1f) / 31.0f * pack_info_2[4].x + pack_info_1[4].x;
-    coeffs[4].z = ((prt_packed_info.z >> 25) & 0x1f) / 31.0f * pack_info_2[4].y + pack_info_1[4].y;
-    coeffs[4].w = (prt_packed_info.w & 0x1f) / 31.0f * pack_info_2[4].z + pack_info_1[4].z;
-    coeffs[5].x = ((prt_packed_info.w >> 5) & 0x1f) / 31.0f * pack_info_2[4].w + pack_info_1[4].w;
-    coeffs[5].y = ((prt_packed_info.w >> 10) & 0x1f) / 31.0f * pack_info_2[5].x + pack_info_1[5].x;
-    coeffs[5].z = ((prt_packed_info.w >> 15) & 0x1f) / 31.0f * pack_info_2[5].y + pack_info_1[5].y;
-    coeffs[5].w = ((prt_packed_info.w >> 20) & 0x1f) / 31.0f * pack_info_2[5].z + pack_info_1[5].z;
-    coeffs_6 = ((prt_packed_info.w >> 25) & 0x1f) / 31.0f * pack_info_2[5].w + pack_info_1[5].w;
-
-    float sum_visi = 0;
-    sum_visi += dot(coeffs[0], vec4(params.coeffs[0], params.coeffs[1], params.coeffs[2], params.coeffs[3]));
-    sum_visi += dot(coeffs[1], vec4(params.coeffs[4], params.coeffs[5], params.coeffs[6], params.coeffs[7]));
-    sum_visi += dot(coeffs[2], vec4(params.coeffs[8], params.coeffs[9], params.coeffs[10], params.coeffs[11]));
-    sum_visi += dot(coeffs[3], vec4(params.coeffs[12], params.coeffs[13], params.coeffs[14], params.coeffs[15]));
-    sum_visi += dot(coeffs[4], vec4(params.coeffs[16], params.coeffs[17], params.coeffs[18], params.coeffs[19]));
-    sum_visi += dot(coeffs[5], vec4(params.coeffs[20], params.coeffs[21], params.coeffs[22], params.coeffs[23]));
-    sum_visi += coeffs_6 * params.coeffs[24];
-#else
-    float sum_visi = 0;
-#endif
+    // color info only holds ibl so far.
+    color_info.f_specular *= env_visi;
+    color_info.f_diffuse *= env_visi;
+    color_info.f_clearcoat *= env_visi;
+    color_info.f_sheen *= env_visi;
+#endif // USE_IBL
 
 	// Calculate lighting contribution from punctual light sources
 #ifdef USE_PUNCTUAL
@@ -234,7 +350,7 @@ void main() {
             material.lights[i],
             normal_info,
             v,
-            sum_visi);
+            light_visi[i]);
     }
 #endif // !USE_PUNCTUAL
 
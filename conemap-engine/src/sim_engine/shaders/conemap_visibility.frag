@@ -0,0 +1,15 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#include "global_definition.glsl.h"
+
+layout(push_constant) uniform ConemapVisibilityUniformBufferObject {
+    ConemapVisibilityParams params;
+};
+
+layout(location = 0) out uint out_visibility;
+
+void main() {
+    out_visibility =
+        ((params.object_id << kVisibilityPrimitiveBits) |
+         (uint(gl_PrimitiveID) & kVisibilityPrimitiveMask)) + 1u;
+}
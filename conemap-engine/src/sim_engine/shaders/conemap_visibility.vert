@@ -0,0 +1,18 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+#include "global_definition.glsl.h"
+
+layout(push_constant) uniform ConemapVisibilityUniformBufferObject {
+    ConemapVisibilityParams params;
+};
+
+layout(std430, set = VIEW_PARAMS_SET, binding = VIEW_CAMERA_BUFFER_INDEX) readonly buffer CameraInfoBuffer {
+	GameCameraInfo camera_info;
+};
+
+layout(location = VINPUT_POSITION) in vec3 in_position;
+
+void main() {
+    vec3 position_ws = (params.model_mat * vec4(in_position, 1.0f)).xyz;
+    gl_Position = camera_info.view_proj * vec4(position_ws, 1.0);
+}
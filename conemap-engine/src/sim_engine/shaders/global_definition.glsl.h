@@ -63,6 +63,18 @@
 #define CONEMAP_TEX_INDEX           (OCCLUSION_TEX_INDEX + 1)
 #define PRT_PACK_TEX_INDEX          (CONEMAP_TEX_INDEX + 1)
 #define PRT_PACK_INFO_TEX_INDEX     (PRT_PACK_TEX_INDEX + 1)
+#define CONEMAP_STEP_STATS_INDEX    (PRT_PACK_INFO_TEX_INDEX + 1)
+#define CONEMAP_PREV_CAMERA_INDEX   (CONEMAP_STEP_STATS_INDEX + 1)
+#define CONEMAP_HISTORY_TEX_INDEX_0 (CONEMAP_PREV_CAMERA_INDEX + 1)
+#define CONEMAP_HISTORY_TEX_INDEX_1 (CONEMAP_HISTORY_TEX_INDEX_0 + 1)
+#define CONEMAP_PARALLAX_TEX_INDEX  (CONEMAP_HISTORY_TEX_INDEX_1 + 1)
+#define VISIBILITY_TEX_INDEX        (CONEMAP_PARALLAX_TEX_INDEX + 1)
+#define VISIBILITY_POSITION_BUFFER_INDEX (VISIBILITY_TEX_INDEX + 1)
+#define VISIBILITY_NORMAL_BUFFER_INDEX (VISIBILITY_POSITION_BUFFER_INDEX + 1)
+#define VISIBILITY_TANGENT_BUFFER_INDEX (VISIBILITY_NORMAL_BUFFER_INDEX + 1)
+#define VISIBILITY_UV_BUFFER_INDEX  (VISIBILITY_TANGENT_BUFFER_INDEX + 1)
+#define VISIBILITY_INDEX_BUFFER_INDEX (VISIBILITY_UV_BUFFER_INDEX + 1)
+#define PRT_LIGHT_COEFFS_INDEX      (VISIBILITY_INDEX_BUFFER_INDEX + 1)
 /*#define PRT_TEX_INDEX_0             (CONEMAP_TEX_INDEX + 1)
 #define PRT_TEX_INDEX_1             (PRT_TEX_INDEX_0 + 1)
 #define PRT_TEX_INDEX_2             (PRT_TEX_INDEX_1 + 1)
@@ -125,6 +137,14 @@
 #define SRC_INFO_TEX_INDEX                  (SRC_TEX_INDEX_2 + 1)
 #define DST_TEX_INDEX                       (SRC_INFO_TEX_INDEX + 1)
 #define DST_TEX_INDEX_1                     (DST_TEX_INDEX + 1)
+#define PRT_ZONAL_LUT_INDEX                 (DST_TEX_INDEX_1 + 1)
+#define PRT_PACK_STATS_INDEX                (PRT_ZONAL_LUT_INDEX + 1)
+#define PRT_ADAPTIVE_STATS_INDEX            (PRT_PACK_STATS_INDEX + 1)
+#define PRT_CACHE_BLOCK_LIST_INDEX          (PRT_ADAPTIVE_STATS_INDEX + 1)
+
+// bindless texture table, one array of sampled textures and one of storage images.
+#define BINDLESS_TEXTURE_INDEX              0
+#define BINDLESS_STORAGE_IMAGE_INDEX        1
 
 #define VERTEX_BUFFER_INDEX                 0
 #define INDEX_BUFFER_INDEX                  1
@@ -220,8 +240,57 @@
 #define kPrtPhiSampleCount                      400
 #define kPrtThetaSampleCount                    200
 #define kPrtShadowInitBlockRadius               2
+// source block list of the fused shadow cache update covers this many blocks around the destination.
+#define kPrtMaxHorizonBlockRadius               128
+// binned block entries per round of the fused shadow cache update, in shared memory.
+#define kPrtCacheUpdateBinCapacity              2048
 
 #define kPrtSampleAngleStep                     (2.0f * PI / float(kPrtPhiSampleCount))
+// adaptive azimuth sampling, level 0 takes every 16th of the kPrtPhiSampleCount azimuths,
+// every further level adds the midpoints in between, the last level is the full set.
+#define kPrtAdaptivePhiBaseCount                25
+#define kPrtAdaptivePhiLevelCount               5
+// fixed point scale of the accumulated adaptive sampling error.
+#define kPrtAdaptiveErrorScale                  16777216.0f
+// reduced resolution prt bake, low res samples baked around each block for the upsampling.
+#define kPrtBakeHaloSize                        1
+// zonal lut row: 15 cumulative weighted legendre coeffs + cumulative weight.
+#define kPrtZonalLutStride                      16
+// slots of the bindless texture table.
+#define kBindlessMaxTextures                    4096
+#define kBindlessMaxStorageImages               1024
+
+// order 5 sh, 25 coefficients per prt visibility or light.
+#define kPrtShCoeffCount                        25
+// getKValue(l, m) = sqrt(sqrt((2l + 1) / 4pi) * (l - m)! / (l + m)!), indexed l * (l + 1) / 2 + m.
+// float literals so glsl and the c++ sh module (sh_basis.h) use bit identical constants.
+#define PRT_SH_K_VALUES \
+    0.531125963f, \
+    0.699001074f, 0.494268417f, \
+    0.79421854f, 0.32423836f, 0.16211918f, \
+    0.863917053f, 0.249391377f, 0.0788644776f, 0.0321962871f, \
+    0.919937134f, 0.205704197f, 0.0484849438f, 0.0129581466f, 0.00458139693f
+
+// prt coefficient packing, the mode is stored in texel 14 of each block's pack info.
+#define kPrtPackGlobalUniform                   0
+#define kPrtPackBlockBanded                     1
+#define kPrtPackModeCount                       2
+// fixed point scale of the accumulated squared packing error.
+#define kPrtPackErrorScale                      16777216.0f
+
+// conemap hit depth temporal reprojection modes.
+#define kConemapTemporalOff                     0
+#define kConemapTemporalWriteOnly               1
+#define kConemapTemporalReadWrite               2
+
+// reduced resolution cone stepping compute pass.
+#define kConemapParallaxDispatchX               8
+#define kConemapParallaxDispatchY               8
+#define kConemapParallaxMaxDownscale            4
+
+// visibility buffer texel, 0 is empty, otherwise (object_id << bits | primitive_id) + 1.
+#define kVisibilityPrimitiveBits                20
+#define kVisibilityPrimitiveMask                ((1u << kVisibilityPrimitiveBits) - 1u)
 
 
 #define GLFW_KEY_W                  87
@@ -277,10 +346,43 @@ struct ModelParams {
 
 struct PrtLightParams {
     mat4 model_mat;
-//    float coeffs[25];
-    float height_scale;
     vec2 buffer_size;
+    uvec2 parallax_size;
     vec3 test_color;
+    float height_scale;
+    uint collect_step_stats;
+    uint temporal_mode;
+    uint history_read_index;
+    float history_guard_band;
+    uint parallax_downscale;    // 1 means cone stepping inline at full resolution.
+    uint use_prt_lighting;      // 0 skips prt decode, lights and ibl stay unshadowed.
+};
+
+// tangent space light sh, updated every frame. a dot with the decoded prt visibility
+// gives the visible fraction of each light directly.
+struct PrtLightCoeffs {
+    float light_coeffs[LIGHT_COUNT * kPrtShCoeffCount];
+    float env_coeffs[kPrtShCoeffCount];
+};
+
+struct ConemapVisibilityParams {
+    mat4 model_mat;
+    uint object_id;
+};
+
+struct ConemapParallaxParams {
+    mat4 model_mat;
+    uvec2 size;
+    vec2 inv_size;
+    float height_scale;
+};
+
+// accumulated by conemap_test.frag when collect_step_stats is set.
+struct ConemapStepStats {
+    uint cone_steps;
+    uint binary_steps;
+    uint num_pixels;
+    uint pad;
 };
 
 struct IblParams {
@@ -463,18 +565,25 @@ struct ConemapGenParams {
     ivec2           dst_block_offset;
     uint            is_height_map;
     uint            depth_channel;
+    // source repeats past its border, cache block indices can run off the grid into the neighbour tiles.
+    uint            is_tileable;
+    // bindless table slots, only read by the passes that bind the table.
+    uint            src_tex_idx;
+    uint            dst_tex_idx;
 };
 
 struct PrtShadowCacheGenParams {
     uvec2           size;
     vec2            inv_size;
-    ivec2           block_index;
-    ivec2           block_offset;
+    ivec2           dst_block_index;
     ivec2           dst_block_offset;
     uint            is_height_map;
     uint            depth_channel;
     float           shadow_noise_thread;
     float           shadow_intensity;
+    // leading entries of the block list to visit.
+    uint            num_blocks;
+    uint            is_tileable;
 };
 
 struct PrtPackParams {
@@ -482,6 +591,27 @@ struct PrtPackParams {
     ivec2           block_index;
     ivec2           block_offset;
     float           range_scale;
+    uint            pack_mode;
+    uint            collect_error;
+    // 0 only collects the error of pack_mode, the packed texture is left alone.
+    uint            store_packed;
+};
+
+struct PrtPackStats {
+    uint sum_sq_error_lo;
+    uint sum_sq_error_hi;
+    uint max_error;
+    uint num_coeffs;
+};
+
+struct PrtAdaptiveStats {
+    uint sum_samples_lo;
+    uint sum_samples_hi;
+    uint num_pixels;
+    uint max_error;
+    uint sum_error_lo;
+    uint sum_error_hi;
+    uint level_pixels[kPrtAdaptivePhiLevelCount];
 };
 
 struct PrtGenParams {
@@ -494,6 +624,30 @@ struct PrtGenParams {
     uint            depth_channel;
     uint            is_height_map;
     float           sample_rate;
+    uint            is_high_precision_conemap;
+    // max sh coefficient change between two azimuth levels, 0 takes all the azimuths.
+    float           adaptive_tolerance;
+    uint            collect_adaptive_stats;
+    // threads past dispatch_size idle, halo_size border samples are added around the block.
+    uvec2           dispatch_size;
+    uint            halo_size;
+    // horizon search range in pixels, bounds the ray length on large sources.
+    uint            horizon_radius;
+    // rays run through the periodic border of a tileable source up to horizon_radius.
+    uint            is_tileable;
+};
+
+struct PrtUpsampleParams {
+    uvec2           size;
+    uvec2           block_offset;
+    uint            scale;
+    uint            halo_size;
+    uint            depth_channel;
+    float           shadow_intensity;
+    float           depth_sigma;
+    float           normal_power;
+    // guide samples off the source wrap around, the same as the halo of the bake.
+    uint            is_tileable;
 };
 
 struct GameObjectsUpdateParams {
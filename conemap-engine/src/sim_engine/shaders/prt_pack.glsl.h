@@ -0,0 +1,65 @@
+// packs 25 sh coefficients into 128 bits, shared by pack_prt.comp and conemap_test.frag.
+// coefficients are stored in order s = l * l + l + m, pack_info holds min/range pairs
+// as written by gen_prt_pack_info.comp: s > 0 in texel (s - 1) / 4, dc in texel 12/13.
+
+uint getPrtCoeffBits(int s, uint pack_mode) {
+    if (pack_mode == kPrtPackGlobalUniform) {
+        return s == 0 ? 8 : 5;
+    }
+    // 10 + 3 * 8 + 5 * 6 + 7 * 4 + 9 * 4 = 128 bits.
+    return s == 0 ? 10 : (s < 4 ? 8 : (s < 9 ? 6 : 4));
+}
+
+float getPrtPackMin(in vec4 pack_info[14], int s) {
+    return s == 0 ? pack_info[12].x : pack_info[((s - 1) / 4) * 2][(s - 1) % 4];
+}
+
+float getPrtPackRange(in vec4 pack_info[14], int s) {
+    return s == 0 ? pack_info[13].x : pack_info[((s - 1) / 4) * 2 + 1][(s - 1) % 4];
+}
+
+void writePrtBits(inout uvec4 packed_coeffs, uint offset, uint bits, uint value) {
+    uint word = offset / 32;
+    uint shift = offset % 32;
+    packed_coeffs[word] |= value << shift;
+    if (shift + bits > 32) {
+        packed_coeffs[word + 1] |= value >> (32 - shift);
+    }
+}
+
+uint readPrtBits(uvec4 packed_coeffs, uint offset, uint bits) {
+    uint word = offset / 32;
+    uint shift = offset % 32;
+    uint value = packed_coeffs[word] >> shift;
+    if (shift + bits > 32) {
+        value |= packed_coeffs[word + 1] << (32 - shift);
+    }
+    return value & ((1u << bits) - 1u);
+}
+
+uvec4 packPrtCoeffs(in float coeffs[25], in vec4 pack_info[14], uint pack_mode) {
+    uvec4 packed_coeffs = uvec4(0);
+    uint offset = 0;
+    for (int s = 0; s < 25; s++) {
+        uint bits = getPrtCoeffBits(s, pack_mode);
+        float max_value = float((1u << bits) - 1u);
+        float range = max(getPrtPackRange(pack_info, s), 1e-20f);
+        float scaled = clamp((coeffs[s] - getPrtPackMin(pack_info, s)) / range, 0.0f, 1.0f);
+        writePrtBits(packed_coeffs, offset, bits, uint(scaled * max_value + 0.5f));
+        offset += bits;
+    }
+    return packed_coeffs;
+}
+
+void unpackPrtCoeffs(uvec4 packed_coeffs, in vec4 pack_info[14], uint pack_mode, out float coeffs[25]) {
+    uint offset = 0;
+    for (int s = 0; s < 25; s++) {
+        uint bits = getPrtCoeffBits(s, pack_mode);
+        float max_value = float((1u << bits) - 1u);
+        coeffs[s] =
+            float(readPrtBits(packed_coeffs, offset, bits)) / max_value *
+            getPrtPackRange(pack_info, s) +
+            getPrtPackMin(pack_info, s);
+        offset += bits;
+    }
+}
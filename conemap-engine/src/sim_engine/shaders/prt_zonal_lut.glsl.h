@@ -0,0 +1,17 @@
+// shared by the prt shadow gen kernels, baked once on cpu by PrtShadow.
+// row i holds the prefix sums up to theta sample i of the weighted legendre coeffs
+// (fillPreCalculateCoeffs * sin weight) and of the weights themselves.
+layout(std430, set = 0, binding = PRT_ZONAL_LUT_INDEX) readonly buffer PrtZonalLutBuffer {
+    float zonal_lut[kPrtThetaSampleCount * kPrtZonalLutStride];
+};
+
+void fillZonalCoeffs(inout float coeffs[15], int theta_idx) {
+    int base = theta_idx * kPrtZonalLutStride;
+    for (int i = 0; i < 15; i++) {
+        coeffs[i] = zonal_lut[base + i];
+    }
+}
+
+float getZonalInvSumWeights() {
+    return 1.0f / (zonal_lut[(kPrtThetaSampleCount - 1) * kPrtZonalLutStride + 15] * kPrtPhiSampleCount);
+}
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include "scene_rendering/sh_basis.h"
+
+// the glsl sh functions of the prt shaders compiled as c++. array parameters decay to
+// pointers here, so the inout and in qualifiers only have to go away.
+namespace glsl_reference {
+using namespace std;
+#define inout
+#define in
+#include "shaders/prt_sh.glsl.h"
+#undef in
+#undef inout
+} // namespace glsl_reference
+
+namespace {
+using engine::scene_rendering::PrtShBasis;
+namespace sh_detail = engine::scene_rendering::sh_detail;
+
+const float kPi = 3.14159265358979323846f;
+const int kThetaCount = 181;
+const int kPhiCount = 361;
+// evalDirections builds sin(theta)^m * cos/sin(m * phi) without trig, so it only gets
+// close to the trig based functions, not bit exact.
+const float kEvalDirectionsTolerance = 1.0e-5f;
+
+struct Result {
+    uint64_t checked = 0;
+    uint64_t mismatches = 0;
+    float max_diff = 0.0f;
+};
+
+bool isSameBits(float a, float b) {
+    uint32_t a_bits, b_bits;
+    std::memcpy(&a_bits, &a, sizeof(a_bits));
+    std::memcpy(&b_bits, &b, sizeof(b_bits));
+    return a_bits == b_bits;
+}
+
+void compareBits(Result& result, const float* a, const float* b, int count) {
+    for (int i = 0; i < count; i++) {
+        result.checked++;
+        if (!isSameBits(a[i], b[i])) {
+            result.mismatches++;
+            result.max_diff = std::max(result.max_diff, std::abs(a[i] - b[i]));
+        }
+    }
+}
+
+float getTheta(int i) {
+    return kPi * float(i) / float(kThetaCount - 1);
+}
+
+float getPhi(int i) {
+    return 2.0f * kPi * float(i) / float(kPhiCount - 1) - kPi;
+}
+
+bool report(const char* name, const Result& result, bool bit_exact) {
+    bool passed = bit_exact ? result.mismatches == 0 : result.max_diff <= kEvalDirectionsTolerance;
+    std::cout << (passed ? "passed " : "FAILED ") << name << ": " <<
+        result.checked << " values, " <<
+        result.mismatches << (bit_exact ? " bit mismatches" : " not bit exact") <<
+        ", max diff " << result.max_diff << std::endl;
+    return passed;
+}
+} // namespace
+
+int main() {
+    bool passed = true;
+
+    {
+        Result result;
+        for (int i = 0; i < kThetaCount; i++) {
+            float x = std::cos(getTheta(i));
+            float p_value[PrtShBasis::kLegendreCount];
+            float ref_p_value[PrtShBasis::kLegendreCount];
+            PrtShBasis::fillPValues<float>(p_value, x);
+            glsl_reference::fillPVauleTablle(ref_p_value, x);
+            compareBits(result, p_value, ref_p_value, PrtShBasis::kLegendreCount);
+        }
+        passed &= report("fillPValues vs fillPVauleTablle", result, true);
+    }
+
+    {
+        Result result;
+        for (int i = 0; i < kThetaCount; i++) {
+            float coeffs[PrtShBasis::kLegendreCount];
+            float ref_coeffs[PrtShBasis::kLegendreCount];
+            PrtShBasis::fillZonalCoeffs<float>(coeffs, getTheta(i));
+            glsl_reference::fillPreCalculateCoeffs(ref_coeffs, getTheta(i));
+            compareBits(result, coeffs, ref_coeffs, PrtShBasis::kLegendreCount);
+        }
+        passed &= report("fillZonalCoeffs vs fillPreCalculateCoeffs", result, true);
+    }
+
+    {
+        Result theta_result, coeffs_result;
+        for (int i = 0; i < kThetaCount; i++) {
+            float zonal_coeffs[PrtShBasis::kLegendreCount];
+            glsl_reference::fillPreCalculateCoeffs(zonal_coeffs, getTheta(i));
+            for (int j = 0; j < kPhiCount; j++) {
+                float y_value[PrtShBasis::kCoeffCount];
+                float ref_y_value[PrtShBasis::kCoeffCount];
+                PrtShBasis::fillYValues(y_value, getTheta(i), getPhi(j));
+                glsl_reference::fillYVauleTablle(ref_y_value, getTheta(i), getPhi(j));
+                compareBits(theta_result, y_value, ref_y_value, PrtShBasis::kCoeffCount);
+
+                PrtShBasis::fillYValues(y_value, zonal_coeffs, getPhi(j));
+                glsl_reference::fillYVauleTablle(ref_y_value, zonal_coeffs, getPhi(j));
+                compareBits(coeffs_result, y_value, ref_y_value, PrtShBasis::kCoeffCount);
+            }
+        }
+        passed &= report("fillYValues vs fillYVauleTablle, theta phi", theta_result, true);
+        passed &= report("fillYValues vs fillYVauleTablle, zonal coeffs", coeffs_result, true);
+    }
+
+    // one direction per theta phi pair, the count leaves a scalar tail behind the simd lanes.
+    size_t count = size_t(kThetaCount) * kPhiCount;
+    std::vector<float> x(count), y(count), z(count);
+    for (int i = 0; i < kThetaCount; i++) {
+        for (int j = 0; j < kPhiCount; j++) {
+            size_t idx = size_t(i) * kPhiCount + j;
+            float sin_theta = std::sin(getTheta(i));
+            x[idx] = sin_theta * std::cos(getPhi(j));
+            y[idx] = sin_theta * std::sin(getPhi(j));
+            z[idx] = std::cos(getTheta(i));
+        }
+    }
+
+    std::vector<float> y_values(count * PrtShBasis::kCoeffCount);
+    PrtShBasis::evalDirections(x.data(), y.data(), z.data(), count, y_values.data(), count);
+
+    {
+        Result result;
+        for (int i = 0; i < kThetaCount; i++) {
+            for (int j = 0; j < kPhiCount; j++) {
+                size_t idx = size_t(i) * kPhiCount + j;
+                float ref_y_value[PrtShBasis::kCoeffCount];
+                glsl_reference::fillYVauleTablle(ref_y_value, getTheta(i), getPhi(j));
+                for (int s = 0; s < PrtShBasis::kCoeffCount; s++) {
+                    float value = y_values[s * count + idx];
+                    result.checked++;
+                    if (!isSameBits(value, ref_y_value[s])) {
+                        result.mismatches++;
+                    }
+                    result.max_diff = std::max(result.max_diff, std::abs(value - ref_y_value[s]));
+                }
+            }
+        }
+        passed &= report("evalDirections vs fillYVauleTablle", result, false);
+    }
+
+    {
+        std::vector<float> scalar_y_values(count * PrtShBasis::kCoeffCount);
+        for (size_t i = 0; i < count; i++) {
+            PrtShBasis::evalDirectionsKernel<sh_detail::ScalarOps>(
+                x.data(), y.data(), z.data(), i, scalar_y_values.data(), count);
+        }
+
+        size_t avx2_count = 0;
+        if (sh_detail::hasAvx2()) {
+            std::vector<float> avx2_y_values(count * PrtShBasis::kCoeffCount);
+            avx2_count = sh_detail::evalDirectionsAvx2<5>(
+                x.data(), y.data(), z.data(), count, avx2_y_values.data(), count);
+            Result result;
+            for (int s = 0; s < PrtShBasis::kCoeffCount; s++) {
+                compareBits(
+                    result,
+                    avx2_y_values.data() + s * count,
+                    scalar_y_values.data() + s * count,
+                    int(avx2_count));
+            }
+            if (avx2_count > 0) {
+                passed &= report("evalDirections avx2 lanes vs scalar", result, true);
+            }
+        }
+        if (avx2_count == 0) {
+            std::cout << "skipped evalDirections avx2 lanes vs scalar: " <<
+                (sh_detail::hasAvx2() ? "built without avx2" : "cpu has no avx2") << std::endl;
+        }
+
+        Result result;
+        compareBits(result, y_values.data(), scalar_y_values.data(), int(y_values.size()));
+        passed &= report("evalDirections vs scalar kernel", result, true);
+    }
+
+    return passed ? 0 : 1;
+}